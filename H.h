@@ -143,8 +143,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 
 #pragma endregion dependencies
 /////
@@ -189,6 +191,37 @@
 	#include <fcntl.h>
 	#include <pthread.h>
 	#include <unistd.h>
+	#include <sys/ioctl.h>
+	#include <sys/resource.h>
+	#include <sys/syscall.h>
+	#ifndef H_PERF_EVENTS
+		#if defined( __has_include )
+			#if __has_include( <linux/perf_event.h> )
+				#define H_PERF_EVENTS 1
+			#else
+				#define H_PERF_EVENTS 0
+			#endif
+		#else
+			#define H_PERF_EVENTS 1
+		#endif
+	#endif
+	#if H_PERF_EVENTS
+		#include <linux/perf_event.h>
+	#endif
+	#include <sys/epoll.h>
+	#include <sys/timerfd.h>
+	#include <sys/eventfd.h>
+	#include <linux/futex.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <netdb.h>
+	#include <signal.h>
+	#include <errno.h>
+	#if defined( __GLIBC__ )
+		#include <execinfo.h>
+	#endif
 
 #elif defined( _WIN32 )
 	#undef OS_WINDOWS
@@ -198,7 +231,10 @@
 	#define WIN32_LEAN_AND_MEAN
 	#define NOMINMAX
 	#include <windows.h>
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
 	#include <io.h>
+	#pragma comment( lib, "ws2_32" )
 
 #elif defined( __APPLE__ )
 	#undef OS_MACOS
@@ -240,6 +276,88 @@
 #pragma endregion compiler
 /////
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region - SIMD
+//
+
+#define SIMD_SSE2 0
+#define SIMD_SSSE3 0
+#define SIMD_SSE4_2 0
+#define SIMD_AVX2 0
+#define SIMD_BMI2 0
+#define SIMD_POPCNT 0
+#define SIMD_NEON 0
+#define SIMD_ARM_CRC 0
+
+#if COMPILER_GCC
+	#if defined( __SSE2__ )
+		#undef SIMD_SSE2
+		#define SIMD_SSE2 1
+	#endif
+	#if defined( __SSSE3__ )
+		#undef SIMD_SSSE3
+		#define SIMD_SSSE3 1
+	#endif
+	#if defined( __SSE4_2__ )
+		#undef SIMD_SSE4_2
+		#define SIMD_SSE4_2 1
+	#endif
+	#if defined( __AVX2__ )
+		#undef SIMD_AVX2
+		#define SIMD_AVX2 1
+	#endif
+	#if defined( __BMI2__ )
+		#undef SIMD_BMI2
+		#define SIMD_BMI2 1
+	#endif
+	#if defined( __POPCNT__ )
+		#undef SIMD_POPCNT
+		#define SIMD_POPCNT 1
+	#endif
+	#if defined( __ARM_NEON )
+		#undef SIMD_NEON
+		#define SIMD_NEON 1
+	#endif
+	#if defined( __ARM_FEATURE_CRC32 )
+		#undef SIMD_ARM_CRC
+		#define SIMD_ARM_CRC 1
+	#endif
+#endif
+
+#if SIMD_AVX2
+	#define SIMD_NAME "AVX2"
+	#include <immintrin.h>
+#elif SIMD_SSE2
+	#define SIMD_NAME "SSE2"
+	#include <immintrin.h>
+#elif SIMD_NEON
+	#define SIMD_NAME "NEON"
+	#include <arm_neon.h>
+#else
+	#define SIMD_NAME "scalar"
+#endif
+
+#if SIMD_ARM_CRC
+	#include <arm_acle.h>
+#endif
+
+#if SIMD_AVX2
+	#define SIMD_WIDTH 32
+#elif SIMD_SSE2 || SIMD_NEON
+	#define SIMD_WIDTH 16
+#else
+	#define SIMD_WIDTH 0
+#endif
+
+#if COMPILER_GCC
+	#define prefetch( REF ) __builtin_prefetch( REF )
+#else
+	#define prefetch( REF )
+#endif
+
+#pragma endregion simd
+/////
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma region - PREFIX
 //
@@ -247,6 +365,10 @@
 #define temp register
 #define perm static
 
+#ifndef thread_local
+	#define thread_local _Thread_local
+#endif
+
 #if OS_LINUX
 	#define cache_align __attribute__( ( aligned( 64 ) ) )
 #else
@@ -567,6 +689,12 @@ type_from( i4 ) out_state;
 
 #define iter_grid( X_NAME, Y_NAME, WIDTH, HEIGHT ) iter( Y_NAME, HEIGHT ) iter( X_NAME, WIDTH )
 
+// TILE_SIZE squares row by row, each walked row-major; `skip` ends the current row of the tile
+#define iter_grid_tiled( X_NAME, Y_NAME, WIDTH, HEIGHT, TILE_SIZE )\
+	iter_step( Y_NAME##_tile, HEIGHT, TILE_SIZE ) iter_step( X_NAME##_tile, WIDTH, TILE_SIZE )\
+	_range( Y_NAME, Y_NAME##_tile, pick( Y_NAME##_tile + ( TILE_SIZE ) < ( HEIGHT ), Y_NAME##_tile + ( TILE_SIZE ), HEIGHT ), 1, <, += )\
+	_range( X_NAME, X_NAME##_tile, pick( X_NAME##_tile + ( TILE_SIZE ) < ( WIDTH ), X_NAME##_tile + ( TILE_SIZE ), WIDTH ), 1, <, += )
+
 #define _repeat( N_TIMES, COUNTER ) iter( JOIN( _REP_, COUNTER ), N_TIMES )
 #define repeat( N_TIMES ) _repeat( N_TIMES, __COUNTER__ )
 
@@ -693,7 +821,7 @@ type_from( i4 ) out_state;
 	START_DEF\
 	{\
 		temp byte const ref const _FROM_REF = FROM_REF;\
-		temp n2 const _PASTE_SIZE = bytes_measure( _FROM_REF );\
+		temp n8 const _PASTE_SIZE = bytes_measure( _FROM_REF );\
 		bytes_copy_move( TO_REF, _FROM_REF, _PASTE_SIZE );\
 	}\
 	END_DEF
@@ -706,6 +834,98 @@ type_from( i4 ) out_state;
 #pragma endregion move
 ////
 
+////////////////////////////////////////////////////////////////
+#pragma region - view
+
+// a bytes_view is a pointer and an n8 size, with no eof needed: measured once, sliced for free,
+// and able to cover mapped files; positions past the end are clamped to it
+
+type( bytes_view )
+{
+	byte const ref bytes;
+	n8 size;
+};
+
+#define bytes_view( BYTES, SIZE... ) make( bytes_view, BYTES, DEFAULT( bytes_measure( BYTES ), SIZE ) )
+#define bytes_view_literal( LITERAL ) make( bytes_view, LITERAL, size_of_bytes( LITERAL ) )
+#define bytes_view_end( VIEW ) ( ( VIEW ).bytes + ( VIEW ).size )
+#define bytes_view_is_empty( VIEW ) ( ( VIEW ).size is 0 )
+
+#define bytes_view_copy_move( TO_REF, VIEW )\
+	START_DEF\
+	{\
+		temp bytes_view const _VIEW = VIEW;\
+		bytes_copy_move( TO_REF, _VIEW.bytes, _VIEW.size );\
+	}\
+	END_DEF
+
+embed bytes_view bytes_view_slice( bytes_view const view, n8 const position, n8 const size )
+{
+	temp n8 const from = pick( position < view.size, position, view.size );
+	temp n8 const room = view.size - from;
+	out make( bytes_view, view.bytes + from, pick( size < room, size, room ) );
+}
+
+embed bytes_view bytes_view_skip( bytes_view const view, n8 const amount )
+{
+	out bytes_view_slice( view, amount, view.size );
+}
+
+embed flag bytes_view_match( bytes_view const a, bytes_view const b )
+{
+	out a.size is b.size and ( a.size is 0 or bytes_compare( a.bytes, b.bytes, a.size ) is 0 );
+}
+
+embed flag bytes_view_starts_with( bytes_view const view, bytes_view const prefix )
+{
+	out prefix.size <= view.size and ( prefix.size is 0 or bytes_compare( view.bytes, prefix.bytes, prefix.size ) is 0 );
+}
+
+embed flag bytes_view_ends_with( bytes_view const view, bytes_view const suffix )
+{
+	out suffix.size <= view.size and ( suffix.size is 0 or bytes_compare( bytes_view_end( view ) - suffix.size, suffix.bytes, suffix.size ) is 0 );
+}
+
+// position of the first / last BYTE, or the view size when there is none
+embed n8 bytes_view_find( bytes_view const view, byte const value )
+{
+	temp byte const ref const found = pick( view.size is 0, nothing, bytes_find( view.bytes, value, view.size ) );
+	out pick( found is nothing, view.size, n8( found - view.bytes ) );
+}
+
+embed n8 bytes_view_find_last( bytes_view const view, byte const value )
+{
+	temp n8 position = view.size;
+	while( position > 0 )
+	{
+		out_if( view.bytes[ --position ] is value ) position;
+	}
+	out view.size;
+}
+
+// the bytes before the next DELIMITER (or all that is left), moving the view past it
+embed bytes_view bytes_view_split( bytes_view ref const view, byte const delimiter )
+{
+	temp n8 const position = bytes_view_find( val_of( view ), delimiter );
+	temp bytes_view const part = make( bytes_view, view->bytes, position );
+	val_of( view ) = bytes_view_skip( val_of( view ), position + 1 );
+	out part;
+}
+
+embed bytes_view bytes_view_trim( bytes_view view )
+{
+	while( view.size > 0 and n1( view.bytes[ 0 ] ) <= ' ' )
+	{
+		++view.bytes;
+		--view.size;
+	}
+	while( view.size > 0 and n1( view.bytes[ view.size - 1 ] ) <= ' ' ) --view.size;
+	out view;
+}
+
+#pragma endregion view
+////
+
 ////////////////////////////////////////////////////////////////
 #pragma region - conversion
 
@@ -958,751 +1178,9334 @@ type_from( i4 ) out_state;
 #pragma endregion conversion
 ////
 
-#pragma endregion bytes
-/////
+////////////////////////////////////////////////////////////////
+#pragma region - format
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#pragma region - OS
-//
+// `bytes_format_move( TO_REF, PARTS... )` writes up to 16 parts, each through the conversion its type
+// selects at compile time: integers, r4 / r8, a byte, byte strings, or a wrapper below;
+// `bytes_format( TO_REF, CAPACITY, PARTS... )` also ends with an eof, and stops before the first
+// part that would not fit; `bytes_format_size( PARTS... )` is an upper bound on the bytes written
+// character literals are ints in C, so write `byte( 'x' )` for a single byte
+// format_hex( VALUE, WIDTH... ) and format_octal( VALUE, WIDTH... ) pad with zeros,
+// format_pad( VALUE, WIDTH, FILL... ) right-aligns and format_left( VALUE, WIDTH, FILL... ) left-aligns
 
-type_from( FILE ref ) os_handle;
-#define os_handle_get_line fgets
+////////////////////////////////
+#pragma region | format / hidden
 
-////////////////////////////////////////////////////////////////
-#pragma region - ref
+enum
+{
+	_FORMAT_UNSIGNED,
+	_FORMAT_SIGNED,
+	_FORMAT_R4,
+	_FORMAT_R8,
+	_FORMAT_HEX,
+	_FORMAT_OCTAL,
+	_FORMAT_BYTE,
+	_FORMAT_BYTES
+};
 
-////////////////////////////////
-#pragma region | ref / hidden
+type_from( variant _format_spec ) _format_spec;
+variant _format_spec
+{
+	n8 bits;
+	r8 real;
+	byte const ref bytes;
+	n8 bound;
+	n1 kind;
+	n1 width;
+	byte fill;
+	flag left;
+};
 
-#define _ALLOC_PAGE_MASK 4095
-#define _ALLOC_HEADER size_of( n8 )
-#define _alloc_page_round( SIZE ) ( ( ( SIZE ) + _ALLOC_PAGE_MASK ) & ~ _ALLOC_PAGE_MASK )
-#define _alloc_base( REF ) ( to( n1 ref, REF ) - _ALLOC_HEADER )
-#define _alloc_total( REF ) val_of( to( n8 ref, _alloc_base( REF ) ) )
+#define _GEN_FORMAT_FROM( NAME, TYPE, KIND, BOUND, FIELD )\
+	embed _format_spec _format_from_##NAME( TYPE const value )\
+	{\
+		out make( _format_spec, .FIELD = value, .kind = KIND, .bound = BOUND, .fill = ' ' );\
+	}
 
-embed anon ref _alloc( n8 const size )
+_GEN_FORMAT_FROM( n1, n1, _FORMAT_UNSIGNED, 3, bits );
+_GEN_FORMAT_FROM( n2, n2, _FORMAT_UNSIGNED, 5, bits );
+_GEN_FORMAT_FROM( n4, n4, _FORMAT_UNSIGNED, 10, bits );
+_GEN_FORMAT_FROM( n8, n8, _FORMAT_UNSIGNED, 20, bits );
+_GEN_FORMAT_FROM( i1, i1, _FORMAT_SIGNED, 4, bits );
+_GEN_FORMAT_FROM( i2, i2, _FORMAT_SIGNED, 6, bits );
+_GEN_FORMAT_FROM( i4, i4, _FORMAT_SIGNED, 11, bits );
+_GEN_FORMAT_FROM( i8, i8, _FORMAT_SIGNED, 20, bits );
+_GEN_FORMAT_FROM( r4, r4, _FORMAT_R4, 16, real );
+_GEN_FORMAT_FROM( r8, r8, _FORMAT_R8, 29, real );
+_GEN_FORMAT_FROM( byte, byte, _FORMAT_BYTE, 1, bits );
+
+embed _format_spec _format_from_bytes( byte const ref const bytes )
 {
-	temp n8 const total = _alloc_page_round( size + _ALLOC_HEADER );
-	#if OS_LINUX
-		temp anon ref const alloc = mmap( nothing, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
-		out_if( alloc is MAP_FAILED ) nothing;
-	#elif OS_WINDOWS
-		temp anon ref const alloc = VirtualAlloc( nothing, total, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE );
-		out_if( alloc is nothing ) nothing;
-	#endif
-	val_of( to( n8 ref, alloc ) ) = total;
-	out to( anon ref, to( n1 ref, alloc ) + _ALLOC_HEADER );
+	temp n8 const size = pick( bytes is nothing, 0, bytes_measure( bytes ) );
+	out make( _format_spec, .bytes = bytes, .kind = _FORMAT_BYTES, .bound = size, .fill = ' ' );
 }
 
-fn _free( anon ref const anon_ref )
+embed _format_spec _format_from_spec( _format_spec const spec )
 {
-	#if OS_LINUX
-		munmap( _alloc_base( anon_ref ), _alloc_total( anon_ref ) );
-	#elif OS_WINDOWS
-		VirtualFree( _alloc_base( anon_ref ), 0, MEM_RELEASE );
-	#endif
+	out spec;
 }
 
-embed anon ref const _ref_resize( anon ref const anon_ref, n8 const new_size, flag const preserve )
+// long and long long are both listed, as one of them is not an intN_t on each platform
+#define _FORMAT_SPEC( PART ) _Generic( ( PART ),\
+	_format_spec: _format_from_spec,\
+	byte: _format_from_byte,\
+	byte ref: _format_from_bytes,\
+	byte const ref: _format_from_bytes,\
+	flag: _format_from_n1,\
+	unsigned char: _format_from_n1,\
+	unsigned short: _format_from_n2,\
+	unsigned int: _format_from_n4,\
+	unsigned long: _format_from_n8,\
+	unsigned long long: _format_from_n8,\
+	signed char: _format_from_i1,\
+	short: _format_from_i2,\
+	int: _format_from_i4,\
+	long: _format_from_i8,\
+	long long: _format_from_i8,\
+	float: _format_from_r4,\
+	double: _format_from_r8 )( PART )
+
+embed _format_spec _format_with( _format_spec spec, n1 const width, byte const fill, flag const left )
 {
-	out_if( new_size > n8_max_val - _ALLOC_HEADER - _ALLOC_PAGE_MASK ) nothing;
-	out_if( anon_ref is nothing ) _alloc( new_size );
+	spec.width = width;
+	spec.fill = fill;
+	spec.left = left;
+	out spec;
+}
 
-	temp n8 const old_total = _alloc_total( anon_ref );
-	temp n8 const new_total = _alloc_page_round( new_size + _ALLOC_HEADER );
-	out_if( new_total is old_total ) anon_ref;
+embed _format_spec _format_digits( n8 const bits, n1 const kind, n8 const size, n1 const width )
+{
+	temp n8 const bound = pick( kind is _FORMAT_HEX, size * 2, ( size * 8 + 2 ) / 3 );
+	out make( _format_spec, .bits = bits, .kind = kind, .bound = bound, .width = width, .fill = '0' );
+}
 
-	#if OS_LINUX
-		if( preserve is yes )
-		{
-			temp anon ref const new_alloc = mremap( _alloc_base( anon_ref ), old_total, new_total, MREMAP_MAYMOVE );
-			out_if( new_alloc is MAP_FAILED ) nothing;
-			val_of( to( n8 ref, new_alloc ) ) = new_total;
-			out to( anon ref, to( n1 ref, new_alloc ) + _ALLOC_HEADER );
-		}
-	#endif
-	temp anon ref const new_alloc = _alloc( new_size );
-	out_if( new_alloc is nothing ) nothing;
+embed n8 _format_spec_size( _format_spec const spec )
+{
+	out pick( spec.width > spec.bound, spec.width, spec.bound );
+}
 
-	#if OS_WINDOWS
-		if( preserve is yes )
+embed byte ref _format_spec_move( byte ref to_ref, _format_spec const spec )
+{
+	byte digits[ 32 ];
+	temp byte ref write = digits;
+	temp byte const ref text = digits;
+	switch( spec.kind )
+	{
+		case _FORMAT_UNSIGNED: n8_to_bytes_move( spec.bits, write ); skip;
+		case _FORMAT_SIGNED: i8_to_bytes_move( to( i8, spec.bits ), write ); skip;
+		case _FORMAT_R4: r4_to_bytes_move( to( r4, spec.real ), write ); skip;
+		case _FORMAT_R8: r8_to_bytes_move( spec.real, write ); skip;
+		case _FORMAT_HEX: hex_n8_to_bytes_move( spec.bits, write ); skip;
+		case _FORMAT_OCTAL: octal_n8_to_bytes_move( spec.bits, write ); skip;
+		case _FORMAT_BYTE: bytes_set_move( write, to( byte, spec.bits ) ); skip;
+		default:
+			text = spec.bytes;
+			write = to( byte ref, spec.bytes ) + spec.bound;
+	}
+	temp n8 size = write - text;
+	temp n8 const padding = pick( spec.width > size, spec.width - size, 0 );
+	if( not spec.left )
+	{
+		// zeros go after the sign
+		if( spec.fill is '0' and size > 0 and text[ 0 ] is '-' )
 		{
-			temp n8 const old_size = old_total - _ALLOC_HEADER;
-			bytes_copy( new_alloc, anon_ref, pick( new_size < old_size, new_size, old_size ) );
+			bytes_set_move( to_ref, '-' );
+			++text;
+			--size;
 		}
-	#endif
-	_free( anon_ref );
-	out new_alloc;
+		bytes_fill( to_ref, spec.fill, padding );
+		to_ref += padding;
+	}
+	bytes_copy_move( to_ref, text, size );
+	if( spec.left )
+	{
+		bytes_fill( to_ref, spec.fill, padding );
+		to_ref += padding;
+	}
+	out to_ref;
+}
+
+#define _FORMAT_MOVE( PART ) _format_to = _format_spec_move( _format_to, _FORMAT_SPEC( PART ) )
+
+// keeps one byte for the eof; a part whose bound does not fit is tried in a local buffer first
+embed byte ref _format_spec_move_checked( byte ref const to_ref, byte const ref const end, _format_spec const spec )
+{
+	temp n8 const room = end - to_ref;
+	out_if( _format_spec_size( spec ) < room ) _format_spec_move( to_ref, spec );
+	out_if( spec.kind is _FORMAT_BYTES ) nothing;
+	byte part[ 256 + 32 ];
+	temp n8 const size = _format_spec_move( part, spec ) - part;
+	out_if( size >= room ) nothing;
+	bytes_copy( to_ref, part, size );
+	out to_ref + size;
 }
 
+#define _FORMAT_CHECKED( PART )\
+	if( not _format_full )\
+	{\
+		temp byte ref const _format_next = _format_spec_move_checked( _format_to, _format_end, _FORMAT_SPEC( PART ) );\
+		if_nothing( _format_next ) _format_full = yes;\
+		else _format_to = _format_next;\
+	}
+
+#define _FORMAT_SIZE( PART ) _format_spec_size( _FORMAT_SPEC( PART ) )
+
 #pragma endregion hidden
 ///
 
 ////////////////////////////////
-#pragma region | ref / visible
+#pragma region | format / visible
 
-#define os_create_ref( TYPE, AMOUNT... ) to( TYPE ref, _alloc( size_of( TYPE ) * DEFAULT( 1, AMOUNT ) ) )
-#define os_delete_ref( REF ) START_DEF { skip_if_nothing( REF ); _free( REF ); REF = nothing; } END_DEF
-#define os_resize_ref( REF, NEW_SIZE, PRESERVE ) to( type_of( REF ), _ref_resize( REF, NEW_SIZE, PRESERVE ) )
+#define format_hex( VALUE, WIDTH... ) _format_digits( n8( VALUE ) & ( n8_max_val >> ( 64 - 8 * size_of( VALUE ) ) ), _FORMAT_HEX, size_of( VALUE ), DEFAULT( 0, WIDTH ) )
+#define format_octal( VALUE, WIDTH... ) _format_digits( n8( VALUE ) & ( n8_max_val >> ( 64 - 8 * size_of( VALUE ) ) ), _FORMAT_OCTAL, size_of( VALUE ), DEFAULT( 0, WIDTH ) )
+#define format_pad( VALUE, WIDTH, FILL... ) _format_with( _FORMAT_SPEC( VALUE ), WIDTH, DEFAULT( ' ', FILL ), no )
+#define format_left( VALUE, WIDTH, FILL... ) _format_with( _FORMAT_SPEC( VALUE ), WIDTH, DEFAULT( ' ', FILL ), yes )
+
+#define bytes_format_move( TO_REF, PARTS... )\
+	START_DEF\
+	{\
+		temp byte ref _format_to = TO_REF;\
+		EVAL( _FORMAT_MOVE CHAIN_PAREN(,, ; _FORMAT_MOVE, PARTS ) );\
+		TO_REF = _format_to;\
+	}\
+	END_DEF
+
+#define bytes_format( TO_REF, CAPACITY, PARTS... )\
+	START_DEF\
+	{\
+		temp byte ref _format_to = TO_REF;\
+		temp byte const ref const _format_end = _format_to + ( CAPACITY );\
+		temp flag _format_full = no;\
+		EVAL( _FORMAT_CHECKED CHAIN_PAREN(,, _FORMAT_CHECKED, PARTS ) )\
+		bytes_end( _format_to );\
+	}\
+	END_DEF
+
+#define bytes_format_size( PARTS... ) ( EVAL( _FORMAT_SIZE CHAIN_PAREN(,, + _FORMAT_SIZE, PARTS ) ) )
 
 #pragma endregion visible
 ///
 
-#pragma endregion ref
+#pragma endregion format
 ////
 
 ////////////////////////////////////////////////////////////////
-#pragma region - command
+#pragma region - codec
 
-#define command( COMMAND ) system( COMMAND )
-#define command_read_open( COMMAND ) popen( COMMAND, "r" )
-#define command_read_close( OS_FILE_HANDLE ) pclose( OS_FILE_HANDLE )
+// whole-buffer hex, base64, JSON and CSV conversions; each returns the bytes written, and the
+// `_size` of the output is known before writing so one allocation covers it; decoders give
+// `codec_invalid` for malformed input, having written some bytes already
 
-embed out_state command_silent( byte const ref const command )
-{
-	#if OS_LINUX
-		out command( command );
-	#elif OS_WINDOWS
-		byte buf[ 1024 ] = "cmd.exe /c ";
-		bytes_paste( buf + 11, command );
+#define codec_invalid n8_max_val
 
-		STARTUPINFOA si = { sizeof( si ), .dwFlags = STARTF_USESHOWWINDOW, .wShowWindow = SW_HIDE };
-		PROCESS_INFORMATION pi;
-		if( not CreateProcessA( nothing, buf, nothing, nothing, FALSE, CREATE_NEW_CONSOLE, nothing, nothing, ref_of( si ), ref_of( pi ) ) )
-		{
-			out -1;
-		}
+////////////////////////////////
+#pragma region | codec / hidden
 
-		WaitForSingleObject( pi.hProcess, INFINITE );
-		DWORD code;
-		GetExitCodeProcess( pi.hProcess, ref_of( code ) );
-		CloseHandle( pi.hProcess );
-		CloseHandle( pi.hThread );
-		out code;
-	#endif
-}
+perm byte const _codec_hex_digits[ 16 ] = "0123456789ABCDEF";
+perm byte const _codec_base64_digits[ 64 ] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-embed os_handle command_read_open_silent( byte const ref const command )
+// 0xFF where the byte is not a base64 digit
+perm n1 const _codec_base64_values[ 256 ] =
 {
-	#if OS_LINUX
-		out command_read_open( command );
-	#elif OS_WINDOWS
-		byte buf[ 1024 ] = "cmd.exe /c ";
-		bytes_paste( buf + 11, command );
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+	0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+	0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
 
-		SECURITY_ATTRIBUTES sa = { sizeof( sa ), nothing, TRUE };
-		HANDLE rd,
-		wr;
-		CreatePipe( ref_of( rd ), ref_of( wr ), ref_of( sa ), 0 );
-		SetHandleInformation( rd, HANDLE_FLAG_INHERIT, 0 );
+embed n1 _codec_hex_value( n1 const digit )
+{
+	temp n1 const number = digit - '0';
+	out_if( number < 10 ) number;
+	temp n1 const letter = ( digit | 0x20 ) - 'a';
+	out pick( letter < 6, letter + 10, 0xFF );
+}
 
-		HANDLE nul_in = CreateFileA( "NUL", GENERIC_READ, FILE_SHARE_READ, ref_of( sa ), OPEN_EXISTING, 0, nothing );
+#if SIMD_SSE2
+	#define _codec_load( REF ) _mm_loadu_si128( to( __m128i const ref, REF ) )
+	#define _codec_store( REF, V ) _mm_storeu_si128( to( __m128i ref, REF ), V )
+	#define _codec_below( V, LIMIT ) _mm_cmpeq_epi8( _mm_min_epu8( V, _mm_set1_epi8( ( LIMIT ) - 1 ) ), V )
+#endif
 
-		STARTUPINFOA si = { sizeof( si ), .dwFlags = STARTF_USESHOWWINDOW | STARTF_USESTDHANDLES, .wShowWindow = SW_HIDE, .hStdInput = nul_in, .hStdOutput = wr, .hStdError = wr };
-		PROCESS_INFORMATION pi;
-		CreateProcessA( nothing, buf, nothing, nothing, TRUE, CREATE_NEW_CONSOLE, nothing, nothing, ref_of( si ), ref_of( pi ) );
+// bytes that JSON strings must escape: '"', '\' and controls below 0x20
+#define _codec_json_plain( BYTE ) ( n1( BYTE ) >= 0x20 and ( BYTE ) isnt '"' and ( BYTE ) isnt '\\' )
+#define _codec_csv_special( BYTE ) ( ( BYTE ) is ',' or ( BYTE ) is '"' or ( BYTE ) is '\r' or ( BYTE ) is '\n' )
 
-		CloseHandle( wr );
-		CloseHandle( nul_in );
-		CloseHandle( pi.hThread );
-		CloseHandle( pi.hProcess );
+#pragma endregion hidden
+///
 
-		out _fdopen( _open_osfhandle( to( intptr_t, rd ), 0 ), "r" );
+////////////////////////////////
+#pragma region | codec / visible
+
+#define bytes_to_hex_size( SIZE ) ( ( SIZE ) * 2 )
+#define hex_to_bytes_size( SIZE ) ( ( SIZE ) / 2 )
+#define bytes_to_base64_size( SIZE ) ( ( ( SIZE ) + 2 ) / 3 * 4 )
+
+// two uppercase digits per byte
+embed n8 bytes_to_hex( anon ref const to_ref, anon const ref const from_ref, n8 const size )
+{
+	temp n1 ref const to = to_ref;
+	temp n1 const ref const from = from_ref;
+	temp n8 i = 0;
+	#if SIMD_SSE2
+		temp __m128i const nibble = _mm_set1_epi8( 0xF );
+		temp __m128i const nine = _mm_set1_epi8( 9 );
+		for( ; i + 16 <= size; i += 16 )
+		{
+			temp __m128i const value = _codec_load( from + i );
+			temp __m128i high = _mm_and_si128( _mm_srli_epi16( value, 4 ), nibble );
+			temp __m128i low = _mm_and_si128( value, nibble );
+			high = _mm_add_epi8( _mm_add_epi8( high, _mm_set1_epi8( '0' ) ), _mm_and_si128( _mm_cmpgt_epi8( high, nine ), _mm_set1_epi8( 'A' - '0' - 10 ) ) );
+			low = _mm_add_epi8( _mm_add_epi8( low, _mm_set1_epi8( '0' ) ), _mm_and_si128( _mm_cmpgt_epi8( low, nine ), _mm_set1_epi8( 'A' - '0' - 10 ) ) );
+			_codec_store( to + i * 2, _mm_unpacklo_epi8( high, low ) );
+			_codec_store( to + i * 2 + 16, _mm_unpackhi_epi8( high, low ) );
+		}
 	#endif
+	for( ; i < size; ++i )
+	{
+		to[ i * 2 ] = _codec_hex_digits[ from[ i ] >> 4 ];
+		to[ i * 2 + 1 ] = _codec_hex_digits[ from[ i ] & 0xF ];
+	}
+	out size * 2;
 }
 
-#define command_read_close_silent( OS_FILE_HANDLE ) OS_PICK( command_read_close( OS_FILE_HANDLE ), fclose( OS_FILE_HANDLE ) )
-
-fn command_get_input( byte ref const bytes, n2 const bytes_size )
+// either case; an odd last digit is invalid
+embed n8 hex_to_bytes( anon ref const to_ref, anon const ref const from_ref, n8 const size )
 {
-	os_handle_get_line( bytes, bytes_size, stdin );
-	temp n2 const input_size = bytes_measure( bytes );
-	out_if( input_size is 0 );
-	bytes[ input_size - 1 ] = eof_byte;
+	temp n1 ref const to = to_ref;
+	temp n1 const ref const from = from_ref;
+	temp n8 i = 0;
+	out_if( size & 1 ) codec_invalid;
+	#if SIMD_SSE2
+		for( ; i + 32 <= size; i += 32 )
+		{
+			__m128i values[ 2 ];
+			iter( half, 2 )
+			{
+				temp __m128i const digit = _codec_load( from + i + half * 16 );
+				temp __m128i const number = _mm_sub_epi8( digit, _mm_set1_epi8( '0' ) );
+				temp __m128i const letter = _mm_sub_epi8( _mm_or_si128( digit, _mm_set1_epi8( 0x20 ) ), _mm_set1_epi8( 'a' ) );
+				temp __m128i const is_number = _codec_below( number, 10 );
+				temp __m128i const is_letter = _codec_below( letter, 6 );
+				out_if( _mm_movemask_epi8( _mm_or_si128( is_number, is_letter ) ) isnt 0xFFFF ) codec_invalid;
+				values[ half ] = _mm_or_si128( _mm_and_si128( is_number, number ), _mm_and_si128( is_letter, _mm_add_epi8( letter, _mm_set1_epi8( 10 ) ) ) );
+				values[ half ] = _mm_or_si128( _mm_slli_epi16( _mm_and_si128( values[ half ], _mm_set1_epi16( 0xFF ) ), 4 ), _mm_srli_epi16( values[ half ], 8 ) );
+			}
+			_codec_store( to + i / 2, _mm_packus_epi16( values[ 0 ], values[ 1 ] ) );
+		}
+	#endif
+	for( ; i < size; i += 2 )
+	{
+		temp n1 const high = _codec_hex_value( from[ i ] );
+		temp n1 const low = _codec_hex_value( from[ i + 1 ] );
+		out_if( ( high | low ) is 0xFF ) codec_invalid;
+		to[ i / 2 ] = n1( high << 4 | low );
+	}
+	out size / 2;
 }
 
-#pragma endregion command
-////
-
-////////////////////////////////////////////////////////////////
-#pragma region - print
-
-#define print( BYTES ) fputs( BYTES, stdout )
-#define print_count( BYTES, SIZE ) fwrite( BYTES, 1, SIZE, stdout )
-#define print_show() fflush( stdout )
-#define print_clear() system( OS_PICK( "clear", "cls" ) )
-
-#define print_newline() print_count( newline, 1 )
-#define print_separator() print_count( separator, 1 )
-#define print_tab() print_count( tab, 1 )
-
-#pragma endregion print
-////
-
-////////////////////////////////////////////////////////////////
-#pragma region - path
-
-#define path_max_size 260
-
-#define path( FOLDERS... ) CHAIN(,, separator, FOLDERS )
-
-fn program_get_path( byte ref const out_bytes )
+// standard alphabet with '=' padding
+embed n8 bytes_to_base64( anon ref const to_ref, anon const ref const from_ref, n8 const size )
 {
-	#if OS_LINUX
-		temp i8 _s = readlink( "/proc/self/exe", out_bytes, path_max_size );
-	#elif OS_WINDOWS
-		GetModuleFileNameA( nothing, out_bytes, path_max_size );
+	temp n1 ref to = to_ref;
+	temp n1 const ref from = from_ref;
+	temp n1 const ref const end = from + size;
+	#if SIMD_SSSE3
+		temp __m128i const shuffle = _mm_setr_epi8( 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10 );
+		temp __m128i const shifts = _mm_setr_epi8(
+			'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0
+		);
+		while( end - from >= 16 )
+		{
+			temp __m128i const input = _mm_shuffle_epi8( _codec_load( from ), shuffle );
+			temp __m128i const high = _mm_mulhi_epu16( _mm_and_si128( input, _mm_set1_epi32( 0x0FC0FC00 ) ), _mm_set1_epi32( 0x04000040 ) );
+			temp __m128i const low = _mm_mullo_epi16( _mm_and_si128( input, _mm_set1_epi32( 0x003F03F0 ) ), _mm_set1_epi32( 0x01000010 ) );
+			temp __m128i const indices = _mm_or_si128( high, low );
+			temp __m128i range = _mm_subs_epu8( indices, _mm_set1_epi8( 51 ) );
+			range = _mm_or_si128( range, _mm_and_si128( _mm_cmpgt_epi8( _mm_set1_epi8( 26 ), indices ), _mm_set1_epi8( 13 ) ) );
+			_codec_store( to, _mm_add_epi8( indices, _mm_shuffle_epi8( shifts, range ) ) );
+			from += 12;
+			to += 16;
+		}
 	#endif
+	for( ; end - from >= 3; from += 3, to += 4 )
+	{
+		temp n4 const group = n4( from[ 0 ] ) << 16 | n4( from[ 1 ] ) << 8 | from[ 2 ];
+		to[ 0 ] = _codec_base64_digits[ group >> 18 ];
+		to[ 1 ] = _codec_base64_digits[ ( group >> 12 ) & 63 ];
+		to[ 2 ] = _codec_base64_digits[ ( group >> 6 ) & 63 ];
+		to[ 3 ] = _codec_base64_digits[ group & 63 ];
+	}
+	if( end > from )
+	{
+		temp n4 const group = n4( from[ 0 ] ) << 16 | pick( end - from > 1, n4( from[ 1 ] ) << 8, 0 );
+		to[ 0 ] = _codec_base64_digits[ group >> 18 ];
+		to[ 1 ] = _codec_base64_digits[ ( group >> 12 ) & 63 ];
+		to[ 2 ] = pick( end - from > 1, _codec_base64_digits[ ( group >> 6 ) & 63 ], '=' );
+		to[ 3 ] = '=';
+	}
+	out bytes_to_base64_size( size );
 }
 
-fn path_up_folder( byte ref const path )
+// exact, from the padding; codec_invalid when SIZE is not whole groups
+embed n8 base64_to_bytes_size( anon const ref const from_ref, n8 const size )
 {
-	temp byte ref p = path + bytes_measure( path );
-	while( p > path and val_of( --p ) isnt '\\' and val_of( p ) isnt '/' );
-	if( p > path ) val_of( p ) = eof_byte;
+	temp byte const ref const from = from_ref;
+	out_if( size & 3 ) codec_invalid;
+	out_if( size is 0 ) 0;
+	out size / 4 * 3 - ( from[ size - 1 ] is '=' ) - ( from[ size - 2 ] is '=' );
 }
 
-embed byte ref const path_get_name( byte ref const path )
+embed n8 base64_to_bytes( anon ref const to_ref, anon const ref const from_ref, n8 const size )
 {
-	temp byte ref p = path + bytes_measure( path );
-	while( p > path and val_of( --p ) isnt '\\' and val_of( p ) isnt '/' );
-	if( p > path ) ++p;
-	out p;
+	temp n8 const written = base64_to_bytes_size( from_ref, size );
+	out_if( written is codec_invalid or written is 0 ) written;
+	temp n1 ref to = to_ref;
+	temp n1 const ref from = from_ref;
+	temp n1 const ref const last = from + size - 4;
+	#if SIMD_SSSE3
+		temp __m128i const low_table = _mm_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A );
+		temp __m128i const high_table = _mm_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+		temp __m128i const rolls = _mm_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 );
+		temp __m128i const nibble = _mm_set1_epi8( 0xF );
+		while( last - from >= 20 )
+		{
+			temp __m128i const input = _codec_load( from );
+			temp __m128i const high = _mm_and_si128( _mm_srli_epi32( input, 4 ), nibble );
+			temp __m128i const bad = _mm_and_si128( _mm_shuffle_epi8( low_table, _mm_and_si128( input, nibble ) ), _mm_shuffle_epi8( high_table, high ) );
+			out_if( _mm_movemask_epi8( _mm_cmpgt_epi8( bad, _mm_setzero_si128() ) ) ) codec_invalid;
+			temp __m128i const roll = _mm_shuffle_epi8( rolls, _mm_add_epi8( _mm_cmpeq_epi8( input, _mm_set1_epi8( '/' ) ), high ) );
+			temp __m128i const values = _mm_add_epi8( input, roll );
+			temp __m128i const pairs = _mm_maddubs_epi16( values, _mm_set1_epi32( 0x01400140 ) );
+			temp __m128i const groups = _mm_madd_epi16( pairs, _mm_set1_epi32( 0x00011000 ) );
+			_codec_store( to, _mm_shuffle_epi8( groups, _mm_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) ) );
+			from += 16;
+			to += 12;
+		}
+	#endif
+	for( ; from <= last; from += 4 )
+	{
+		temp flag const final = from is last;
+		temp n1 const a = _codec_base64_values[ from[ 0 ] ];
+		temp n1 const b = _codec_base64_values[ from[ 1 ] ];
+		temp n1 const c = pick( final and from[ 2 ] is '=' and from[ 3 ] is '=', 0, _codec_base64_values[ from[ 2 ] ] );
+		temp n1 const d = pick( final and from[ 3 ] is '=', 0, _codec_base64_values[ from[ 3 ] ] );
+		out_if( ( a | b | c | d ) is 0xFF ) codec_invalid;
+		temp n4 const group = n4( a ) << 18 | n4( b ) << 12 | n4( c ) << 6 | d;
+		val_of( to++ ) = n1( group >> 16 );
+		skip_if( final and from[ 2 ] is '=' );
+		val_of( to++ ) = n1( group >> 8 );
+		skip_if( final and from[ 3 ] is '=' );
+		val_of( to++ ) = n1( group );
+	}
+	out written;
 }
 
-embed byte ref const path_get_extension( byte ref const path )
+// the bytes of a JSON string body: '"' and '\' get a '\', controls get their short or \u00XX form
+embed n8 bytes_escape_json_size( anon const ref const from_ref, n8 const size )
 {
-	temp byte ref p = path + bytes_measure( path );
-	while( p > path and val_of( --p ) isnt '.' );
-	if( p > path ) ++p;
-	out p;
+	temp byte const ref const from = from_ref;
+	temp n8 total = size;
+	temp n8 i = 0;
+	#if SIMD_SSE2
+		for( ; i + 16 <= size; i += 16 )
+		{
+			temp __m128i const chunk = _codec_load( from + i );
+			temp __m128i const special = _mm_or_si128( _codec_below( chunk, 0x20 ), _mm_or_si128( _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '"' ) ), _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '\\' ) ) ) );
+			next_if( _mm_movemask_epi8( special ) is 0 );
+			iter( k, 16 )
+			{
+				temp byte const value = from[ i + k ];
+				next_if( _codec_json_plain( value ) );
+				total += pick( n1( value ) >= 0x20 or ( value >= '\b' and value <= '\r' and value isnt '\v' ), 1, 5 );
+			}
+		}
+	#endif
+	for( ; i < size; ++i )
+	{
+		temp byte const value = from[ i ];
+		next_if( _codec_json_plain( value ) );
+		total += pick( n1( value ) >= 0x20 or ( value >= '\b' and value <= '\r' and value isnt '\v' ), 1, 5 );
+	}
+	out total;
 }
 
-#pragma endregion path
-////
-
-////////////////////////////////////////////////////////////////
-#pragma region - entries
-
-group( entry_type )
-{
-	entry_unknown,
-	entry_folders,
-	entry_files,
-	entry_any
-};
-
-embed n2 os_get_entries( byte const ref const folder_path, byte entries[][ path_max_size ], n2 const max_entries, entry_type const type, flag const folder_separator )
+embed n8 bytes_escape_json( anon ref const to_ref, anon const ref const from_ref, n8 const size )
 {
-	n2 count = 0,
-	len = bytes_measure( folder_path );
-	perm byte path[ path_max_size ];
-	bytes_paste( path, folder_path );
-	#if OS_LINUX
-		struct dirent ref entry;
-		struct stat stat_buf;
-		anon ref handle = opendir( path );
-		out_if_nothing( handle ) 0;
-
-		path[ len++ ] = '/';
-		while( ( entry = readdir( handle ) ) and count < max_entries )
+	temp byte ref to = to_ref;
+	temp byte const ref const from = from_ref;
+	temp n8 i = 0;
+	while( i < size )
+	{
+		#if SIMD_SSE2
+			while( i + 16 <= size )
+			{
+				temp __m128i const chunk = _codec_load( from + i );
+				temp __m128i const special = _mm_or_si128( _codec_below( chunk, 0x20 ), _mm_or_si128( _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '"' ) ), _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '\\' ) ) ) );
+				skip_if( _mm_movemask_epi8( special ) );
+				_codec_store( to, chunk );
+				to += 16;
+				i += 16;
+			}
+			skip_if( i is size );
+		#endif
+		temp byte const value = from[ i++ ];
+		if( _codec_json_plain( value ) ) val_of( to++ ) = value;
+		else
 		{
-			next_if( entry->d_name[ 0 ] is '.' );
-
-			n2 esz = bytes_measure( entry->d_name ) + 1;
-			bytes_copy( path + len, entry->d_name, esz );
-			next_if( stat( path, ref_of( stat_buf ) ) isnt 0 );
-
-			flag is_dir = flag( S_ISDIR( stat_buf.st_mode ) );
-			next_if( type isnt entry_any and is_dir isnt ( type is entry_folders ) );
-
-			bytes_copy( entries[ count ], entry->d_name, esz );
-			if( is_dir and folder_separator )
+			val_of( to++ ) = '\\';
+			switch( value )
 			{
-				entries[ count ][ esz - 1 ] = separator_byte;
-				entries[ count ][ esz ] = eof_byte;
+				case '"': val_of( to++ ) = '"'; skip;
+				case '\\': val_of( to++ ) = '\\'; skip;
+				case '\b': val_of( to++ ) = 'b'; skip;
+				case '\t': val_of( to++ ) = 't'; skip;
+				case '\n': val_of( to++ ) = 'n'; skip;
+				case '\f': val_of( to++ ) = 'f'; skip;
+				case '\r': val_of( to++ ) = 'r'; skip;
+				default:
+					bytes_copy_move( to, "u00", 3 );
+					val_of( to++ ) = _codec_hex_digits[ n1( value ) >> 4 ];
+					val_of( to++ ) = _codec_hex_digits[ n1( value ) & 0xF ];
 			}
-			++count;
 		}
-		closedir( handle );
-	#elif OS_WINDOWS
-		WIN32_FIND_DATA entry;
-		bytes_copy( path + len, "\\*", 3 );
-		anon ref handle = FindFirstFile( path, ref_of( entry ) );
-		out_if( handle is INVALID_HANDLE_VALUE ) 0;
-
-		do
-		{
-			next_if( entry.cFileName[ 0 ] is '.' );
+	}
+	out n8( to - to( byte ref, to_ref ) );
+}
 
-			flag is_dir = flag( entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY );
-			next_if( type isnt entry_any and is_dir isnt ( type is entry_folders ) );
+// a CSV field: quoted, with '"' doubled, only when it holds ',', '"', CR or LF
+embed n8 bytes_escape_csv_size( anon const ref const from_ref, n8 const size )
+{
+	temp byte const ref const from = from_ref;
+	temp n8 quotes = 0;
+	temp flag special = no;
+	iter( i, size )
+	{
+		quotes += from[ i ] is '"';
+		special |= _codec_csv_special( from[ i ] );
+	}
+	out size + quotes + pick( special, 2, 0 );
+}
 
-			n2 esz = bytes_measure( entry.cFileName ) + 1;
-			bytes_copy( entries[ count ], entry.cFileName, esz );
-			if( is_dir and folder_separator )
-			{
-				entries[ count ][ esz - 1 ] = separator_byte;
-				entries[ count ][ esz ] = eof_byte;
-			}
-			++count;
+embed n8 bytes_escape_csv( anon ref const to_ref, anon const ref const from_ref, n8 const size )
+{
+	temp byte ref to = to_ref;
+	temp byte const ref const from = from_ref;
+	temp n8 i = 0;
+	temp flag special = no;
+	#if SIMD_SSE2
+		for( ; i + 16 <= size and not special; i += 16 )
+		{
+			temp __m128i const chunk = _codec_load( from + i );
+			special = _mm_movemask_epi8( _mm_or_si128(
+				_mm_or_si128( _mm_cmpeq_epi8( chunk, _mm_set1_epi8( ',' ) ), _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '"' ) ) ),
+				_mm_or_si128( _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '\r' ) ), _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '\n' ) ) )
+			) ) isnt 0;
 		}
-		while( count < max_entries and FindNextFile( handle, ref_of( entry ) ) );
-		FindClose( handle );
 	#endif
-	out count;
+	for( ; i < size and not special; ++i ) special = _codec_csv_special( from[ i ] );
+	if( not special )
+	{
+		bytes_copy( to, from, size );
+		out size;
+	}
+	val_of( to++ ) = '"';
+	i = 0;
+	while( i < size )
+	{
+		temp byte const ref const quote = bytes_find( from + i, '"', size - i );
+		temp n8 const run = pick( quote is nothing, size - i, n8( quote - ( from + i ) ) + 1 );
+		bytes_copy_move( to, from + i, run );
+		i += run;
+		if( quote isnt nothing ) val_of( to++ ) = '"';
+	}
+	val_of( to++ ) = '"';
+	out n8( to - to( byte ref, to_ref ) );
 }
 
-#define os_get_files( PATH, OUT_ENTRIES, MAX_ENTRIES ) os_get_entries( PATH, OUT_ENTRIES, MAX_ENTRIES, entry_files, no )
-#define os_get_folders( PATH, OUT_ENTRIES, MAX_ENTRIES, FOLDER_SEPARATOR... ) os_get_entries( PATH, OUT_ENTRIES, MAX_ENTRIES, entry_folders, DEFAULT( yes, FOLDER_SEPARATOR ) )
+#pragma endregion visible
+///
 
-#pragma endregion entries
+#pragma endregion codec
 ////
 
 ////////////////////////////////////////////////////////////////
-#pragma region - file
+#pragma region - utf8
 
-type( os_file )
-{
-	byte path[ path_max_size ];
-	n2 path_size;
-	os_handle handle;
-	byte const ref mapped_bytes;
-	n8 size;
-};
+// UTF-8 validation with the Keiser-Lemire lookup tables (SSSE3, one 16-byte step per load),
+// counting, decoding and UTF-16 / UTF-32 transcoding; decoders turn each invalid byte into
+// utf8_replacement, and `_size` macros bound the output before converting, exact for UTF-32
+// from valid UTF-8 through `utf8_count`
+
+#define utf8_replacement 0xFFFDu
 
 ////////////////////////////////
-#pragma region | file / hidden
+#pragma region | utf8 / hidden
 
-embed n8 _os_file_size( byte const ref const file_path )
-{
-	#if OS_LINUX
-		struct stat st;
-		out pick( stat( file_path, ref_of( st ) ) is 0, to( n8 const, st.st_size ), 0 );
-	#elif OS_WINDOWS
-		WIN32_FILE_ATTRIBUTE_DATA fad;
-		out pick( GetFileAttributesExA( file_path, GetFileExInfoStandard, ref_of( fad ) ), to( n8 const, ( n8( fad.nFileSizeHigh ) << 32 ) | n8( fad.nFileSizeLow ) ), 0 );
-	#endif
-}
+#define _UTF8_INVALID n4_max_val
 
-embed os_file _os_file_saving( byte const ref const path, n4 const path_size )
+embed n4 _utf8_decode( n1 const ref const bytes, n8 const remaining, n1 ref const length )
 {
-	os_file f = { 0 };
-	f.handle = fopen( path, "wb" );
-	out_if_nothing( f.handle ) f;
-	f.path_size = path_size;
-	bytes_copy( f.path, path, f.path_size );
-	out f;
+	temp n1 const lead = bytes[ 0 ];
+	val_of( length ) = 1;
+	out_if( lead < 0x80 ) lead;
+	temp n1 size;
+	temp n4 code;
+	if( lead >= 0xC2 and lead <= 0xDF )
+	{
+		size = 2;
+		code = lead & 0x1F;
+	}
+	else if( lead >= 0xE0 and lead <= 0xEF )
+	{
+		size = 3;
+		code = lead & 0x0F;
+	}
+	else if( lead >= 0xF0 and lead <= 0xF4 )
+	{
+		size = 4;
+		code = lead & 0x07;
+	}
+	else out _UTF8_INVALID;
+	out_if( remaining < size ) _UTF8_INVALID;
+	for( temp n1 k = 1; k < size; ++k )
+	{
+		out_if( ( bytes[ k ] & 0xC0 ) isnt 0x80 ) _UTF8_INVALID;
+		code = code << 6 | ( bytes[ k ] & 0x3F );
+	}
+	out_if( size is 3 and ( code < 0x800 or ( code >= 0xD800 and code <= 0xDFFF ) ) ) _UTF8_INVALID;
+	out_if( size is 4 and ( code < 0x10000 or code > 0x10FFFF ) ) _UTF8_INVALID;
+	val_of( length ) = size;
+	out code;
 }
 
-embed os_file _os_file_loading( byte const ref const path, n4 const path_size )
-{
-	os_file f = { 0 };
-	f.size = _os_file_size( path );
-	if( f.size is 0 ) out f;
-	f.handle = fopen( path, "rb" );
-	out_if_nothing( f.handle ) f;
-	f.path_size = path_size;
-	bytes_copy( f.path, path, f.path_size );
-	out f;
-}
+#if SIMD_SSE2
+	#define _utf8_load( REF ) _mm_loadu_si128( to( __m128i const ref, REF ) )
+	#define _utf8_store( REF, V ) _mm_storeu_si128( to( __m128i ref, REF ), V )
+#endif
+
+#if SIMD_SSSE3
+	#define _UTF8_TOO_SHORT 0x01
+	#define _UTF8_TOO_LONG 0x02
+	#define _UTF8_OVERLONG_3 0x04
+	#define _UTF8_TOO_LARGE 0x08
+	#define _UTF8_SURROGATE 0x10
+	#define _UTF8_OVERLONG_2 0x20
+	#define _UTF8_TOO_LARGE_1000 0x40
+	#define _UTF8_OVERLONG_4 0x40
+	#define _UTF8_TWO_CONTS 0x80
+	#define _UTF8_CARRY ( _UTF8_TOO_SHORT | _UTF8_TOO_LONG | _UTF8_TWO_CONTS )
+
+	// error bits for one 16-byte step, given the step before it
+	embed __m128i _utf8_check( __m128i const input, __m128i const before )
+	{
+		temp __m128i const nibble = _mm_set1_epi8( 0x0F );
+		temp __m128i const first_high_table = _mm_setr_epi8(
+			_UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG,
+			_UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG,
+			_UTF8_TWO_CONTS, _UTF8_TWO_CONTS, _UTF8_TWO_CONTS, _UTF8_TWO_CONTS,
+			_UTF8_TOO_SHORT | _UTF8_OVERLONG_2,
+			_UTF8_TOO_SHORT,
+			_UTF8_TOO_SHORT | _UTF8_OVERLONG_3 | _UTF8_SURROGATE,
+			_UTF8_TOO_SHORT | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000 | _UTF8_OVERLONG_4
+		);
+		temp __m128i const first_low_table = _mm_setr_epi8(
+			_UTF8_CARRY | _UTF8_OVERLONG_3 | _UTF8_OVERLONG_2 | _UTF8_OVERLONG_4,
+			_UTF8_CARRY | _UTF8_OVERLONG_2,
+			_UTF8_CARRY,
+			_UTF8_CARRY,
+			_UTF8_CARRY | _UTF8_TOO_LARGE,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000 | _UTF8_SURROGATE,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+			_UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000
+		);
+		temp __m128i const second_high_table = _mm_setr_epi8(
+			_UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT,
+			_UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT,
+			_UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_OVERLONG_3 | _UTF8_TOO_LARGE_1000 | _UTF8_OVERLONG_4,
+			_UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_OVERLONG_3 | _UTF8_TOO_LARGE,
+			_UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_SURROGATE | _UTF8_TOO_LARGE,
+			_UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_SURROGATE | _UTF8_TOO_LARGE,
+			_UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT
+		);
+		temp __m128i const previous_1 = _mm_alignr_epi8( input, before, 15 );
+		temp __m128i const special = _mm_and_si128(
+			_mm_and_si128(
+				_mm_shuffle_epi8( first_high_table, _mm_and_si128( _mm_srli_epi16( previous_1, 4 ), nibble ) ),
+				_mm_shuffle_epi8( first_low_table, _mm_and_si128( previous_1, nibble ) )
+			),
+			_mm_shuffle_epi8( second_high_table, _mm_and_si128( _mm_srli_epi16( input, 4 ), nibble ) )
+		);
+		temp __m128i const third = _mm_subs_epu8( _mm_alignr_epi8( input, before, 14 ), _mm_set1_epi8( 0xE0 - 0x80 ) );
+		temp __m128i const fourth = _mm_subs_epu8( _mm_alignr_epi8( input, before, 13 ), _mm_set1_epi8( 0xF0 - 0x80 ) );
+		temp __m128i const continuations = _mm_and_si128( _mm_or_si128( third, fourth ), _mm_set1_epi8( 0x80 ) );
+		out _mm_xor_si128( continuations, special );
+	}
+
+	// nonzero where the step ends inside a sequence
+	embed __m128i _utf8_incomplete( __m128i const input )
+	{
+		temp __m128i const limits = _mm_setr_epi8( -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1 );
+		out _mm_subs_epu8( input, limits );
+	}
+#endif
 
 #pragma endregion hidden
 ///
 
 ////////////////////////////////
-#pragma region | file / visible
+#pragma region | utf8 / visible
 
-embed flag os_file_exists( byte const ref const path )
+// the code point at POSITION_REF, moving it past; an invalid byte is utf8_replacement and moves one
+embed n4 utf8_decode( anon const ref const bytes, n8 const size, n8 ref const position_ref )
 {
-	#if OS_LINUX
-		struct stat st;
-		out stat( path, ref_of( st ) ) is 0 and S_ISREG( st.st_mode );
-	#elif OS_WINDOWS
-		DWORD attrib = GetFileAttributesA( path );
-		out attrib isnt INVALID_FILE_ATTRIBUTES and not( attrib & FILE_ATTRIBUTE_DIRECTORY );
-	#endif
+	n1 length;
+	temp n4 const code = _utf8_decode( to( n1 const ref, bytes ) + val_of( position_ref ), size - val_of( position_ref ), ref_of( length ) );
+	val_of( position_ref ) += length;
+	out pick( code is _UTF8_INVALID, utf8_replacement, code );
 }
 
-#define os_create_file( PATH, PATH_SIZE... ) _os_file_saving( PATH, DEFAULT( bytes_measure( PATH ), PATH_SIZE ) )
-#define os_open_file( PATH, PATH_SIZE... ) _os_file_loading( PATH, DEFAULT( bytes_measure( PATH ), PATH_SIZE ) )
-
-embed os_file _os_map_file( byte const ref const path, n4 const path_size )
+// writes 1 to 4 bytes, giving how many; code points past U+10FFFF and surrogates write utf8_replacement
+embed n1 utf8_encode( anon ref const to_ref, n4 code )
 {
-	os_file f = { 0 };
-	f.size = _os_file_size( path );
-	if( f.size is 0 ) out f;
-	#if OS_LINUX
-		i4 fd = open( path, O_RDONLY );
-		out_if( fd is -1 ) f;
-		anon ref mapped = mmap( nothing, f.size, PROT_READ, MAP_PRIVATE, fd, 0 );
-		close( fd );
-		out_if( mapped is MAP_FAILED ) f;
-		f.mapped_bytes = to( byte ref, mapped );
-	#elif OS_WINDOWS
-		HANDLE hf = CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, nothing, OPEN_EXISTING, 0, nothing );
-		out_if( hf is INVALID_HANDLE_VALUE ) f;
-		HANDLE hm = CreateFileMapping( hf, nothing, PAGE_READONLY, 0, 0, nothing );
-		CloseHandle( hf );
-		if_nothing( hm ) out f;
-		f.mapped_bytes = to( byte ref, MapViewOfFile( hm, FILE_MAP_READ, 0, 0, 0 ) );
-		CloseHandle( hm );
-	#endif
-	f.path_size = path_size;
-	bytes_copy( f.path, path, f.path_size );
-	out f;
+	temp n1 ref const to = to_ref;
+	if( code > 0x10FFFF or ( code >= 0xD800 and code <= 0xDFFF ) ) code = utf8_replacement;
+	if( code < 0x80 )
+	{
+		to[ 0 ] = n1( code );
+		out 1;
+	}
+	if( code < 0x800 )
+	{
+		to[ 0 ] = n1( 0xC0 | code >> 6 );
+		to[ 1 ] = n1( 0x80 | ( code & 0x3F ) );
+		out 2;
+	}
+	if( code < 0x10000 )
+	{
+		to[ 0 ] = n1( 0xE0 | code >> 12 );
+		to[ 1 ] = n1( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+		to[ 2 ] = n1( 0x80 | ( code & 0x3F ) );
+		out 3;
+	}
+	to[ 0 ] = n1( 0xF0 | code >> 18 );
+	to[ 1 ] = n1( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+	to[ 2 ] = n1( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+	to[ 3 ] = n1( 0x80 | ( code & 0x3F ) );
+	out 4;
 }
-#define os_map_file( PATH, PATH_SIZE... ) _os_map_file( PATH, DEFAULT( bytes_measure( PATH ), PATH_SIZE ) )
 
-fn os_delete_file( const byte ref const path )
+// `iter_utf8( CODE_NAME, BYTES, SIZE )` loops over the n4 code points, with next and skip as in `iter`;
+// BYTES is read each step
+#define iter_utf8( CODE_NAME, BYTES, SIZE )\
+	for( n8 _utf8_at = 0, _utf8_end = ( SIZE ), _utf8_go = 1; _utf8_go and _utf8_at < _utf8_end; )\
+		for( n4 CODE_NAME = utf8_decode( BYTES, _utf8_end, ref_of( _utf8_at ) ), _utf8_once = ( _utf8_go = 0, 1 ); _utf8_once; _utf8_once = 0, _utf8_go = 1 )
+
+embed flag utf8_validate( anon const ref const bytes_ref, n8 const size )
 {
-	remove( path );
+	temp n1 const ref const bytes = bytes_ref;
+	temp n8 i = 0;
+	#if SIMD_SSSE3
+		temp __m128i before = _mm_setzero_si128();
+		temp __m128i error = _mm_setzero_si128();
+		temp __m128i incomplete = _mm_setzero_si128();
+		n1 last[ 16 ] = { 0 };
+		loop
+		{
+			temp flag const tail = i + 16 > size;
+			if( tail ) bytes_copy( last, bytes + i, size - i );
+			temp __m128i const input = _utf8_load( pick( tail, last, bytes + i ) );
+			if( _mm_movemask_epi8( input ) is 0 ) error = _mm_or_si128( error, incomplete );
+			else
+			{
+				error = _mm_or_si128( error, _utf8_check( input, before ) );
+				incomplete = _utf8_incomplete( input );
+			}
+			skip_if( tail );
+			before = input;
+			i += 16;
+			if( ( i & 1023 ) is 0 )
+			{
+				out_if( _mm_movemask_epi8( _mm_cmpeq_epi8( error, _mm_setzero_si128() ) ) isnt 0xFFFF ) no;
+			}
+		}
+		out _mm_movemask_epi8( _mm_cmpeq_epi8( error, _mm_setzero_si128() ) ) is 0xFFFF;
+	#else
+		while( i < size )
+		{
+			#if SIMD_SSE2
+				if( i + 16 <= size and _mm_movemask_epi8( _utf8_load( bytes + i ) ) is 0 )
+				{
+					i += 16;
+					next;
+				}
+			#endif
+			n1 length;
+			out_if( _utf8_decode( bytes + i, size - i, ref_of( length ) ) is _UTF8_INVALID ) no;
+			i += length;
+		}
+		out yes;
+	#endif
 }
 
-fn os_file_ref_save( os_file ref const file_ref, byte const ref const bytes, n8 const size )
+// code points in valid UTF-8: the bytes that are not continuations
+embed n8 utf8_count( anon const ref const bytes_ref, n8 const size )
 {
-	if_nothing( file_ref->handle ) out;
-	fseek( file_ref->handle, 0, SEEK_SET );
-	file_ref->size = size;
-	fwrite( bytes, 1, file_ref->size, file_ref->handle );
-	fflush( file_ref->handle );
+	temp i1 const ref const bytes = bytes_ref;
+	temp n8 count = 0;
+	temp n8 i = 0;
+	#if SIMD_SSE2
+		temp __m128i const last_continuation = _mm_set1_epi8( -0x41 );
+		temp __m128i sums = _mm_setzero_si128();
+		for( ; i + 16 <= size; i += 16 )
+		{
+			temp __m128i const starts = _mm_and_si128( _mm_cmpgt_epi8( _utf8_load( bytes + i ), last_continuation ), _mm_set1_epi8( 1 ) );
+			sums = _mm_add_epi64( sums, _mm_sad_epu8( starts, _mm_setzero_si128() ) );
+		}
+		count = n8( _mm_cvtsi128_si64( sums ) ) + n8( _mm_cvtsi128_si64( _mm_unpackhi_epi64( sums, sums ) ) );
+	#endif
+	for( ; i < size; ++i ) count += bytes[ i ] > -0x41;
+	out count;
 }
 
-fn os_file_ref_load( os_file ref const file_ref, byte ref const out_bytes )
+#define utf8_to_utf16_size( SIZE ) ( SIZE )
+#define utf8_to_utf32_size( SIZE ) ( SIZE )
+#define utf16_to_utf8_size( UNITS ) ( ( UNITS ) * 3 )
+#define utf32_to_utf8_size( COUNT ) ( ( COUNT ) * 4 )
+
+// each returns the units written
+embed n8 utf8_to_utf16( n2 ref const to, anon const ref const from_ref, n8 const size )
 {
-	if_nothing( file_ref->handle ) out;
-	fseek( file_ref->handle, 0, SEEK_SET );
-	fread( out_bytes, 1, file_ref->size, file_ref->handle );
-}
-
-fn os_file_ref_clear( os_file ref const file_ref )
-{
-	file_ref->handle = nothing;
-	bytes_clear( file_ref->path, file_ref->path_size );
-	file_ref->path_size = 0;
-	file_ref->size = 0;
+	temp n1 const ref const from = from_ref;
+	temp n8 i = 0;
+	temp n8 written = 0;
+	while( i < size )
+	{
+		#if SIMD_SSE2
+			while( i + 16 <= size )
+			{
+				temp __m128i const input = _utf8_load( from + i );
+				skip_if( _mm_movemask_epi8( input ) );
+				_utf8_store( to + written, _mm_unpacklo_epi8( input, _mm_setzero_si128() ) );
+				_utf8_store( to + written + 8, _mm_unpackhi_epi8( input, _mm_setzero_si128() ) );
+				i += 16;
+				written += 16;
+			}
+			skip_if( i is size );
+		#endif
+		n1 length;
+		temp n4 code = _utf8_decode( from + i, size - i, ref_of( length ) );
+		i += length;
+		if( code is _UTF8_INVALID ) code = utf8_replacement;
+		if( code < 0x10000 ) to[ written++ ] = n2( code );
+		else
+		{
+			code -= 0x10000;
+			to[ written++ ] = n2( 0xD800 | code >> 10 );
+			to[ written++ ] = n2( 0xDC00 | ( code & 0x3FF ) );
+		}
+	}
+	out written;
 }
 
-fn os_file_ref_close( os_file ref const file_ref )
+embed n8 utf8_to_utf32( n4 ref const to, anon const ref const from_ref, n8 const size )
 {
-	if_something( file_ref->handle ) fclose( file_ref->handle );
-	os_file_ref_clear( file_ref );
+	temp n1 const ref const from = from_ref;
+	temp n8 i = 0;
+	temp n8 written = 0;
+	while( i < size )
+	{
+		#if SIMD_SSE2
+			while( i + 16 <= size )
+			{
+				temp __m128i const input = _utf8_load( from + i );
+				skip_if( _mm_movemask_epi8( input ) );
+				temp __m128i const low = _mm_unpacklo_epi8( input, _mm_setzero_si128() );
+				temp __m128i const high = _mm_unpackhi_epi8( input, _mm_setzero_si128() );
+				_utf8_store( to + written, _mm_unpacklo_epi16( low, _mm_setzero_si128() ) );
+				_utf8_store( to + written + 4, _mm_unpackhi_epi16( low, _mm_setzero_si128() ) );
+				_utf8_store( to + written + 8, _mm_unpacklo_epi16( high, _mm_setzero_si128() ) );
+				_utf8_store( to + written + 12, _mm_unpackhi_epi16( high, _mm_setzero_si128() ) );
+				i += 16;
+				written += 16;
+			}
+			skip_if( i is size );
+		#endif
+		n1 length;
+		temp n4 const code = _utf8_decode( from + i, size - i, ref_of( length ) );
+		i += length;
+		to[ written++ ] = pick( code is _UTF8_INVALID, utf8_replacement, code );
+	}
+	out written;
 }
 
-fn os_file_ref_unmap( os_file ref const file_ref )
+// unpaired surrogates become utf8_replacement
+embed n8 utf16_to_utf8( anon ref const to_ref, n2 const ref const from, n8 const units )
 {
-	if_something( file_ref->mapped_bytes )
+	temp n1 ref const to = to_ref;
+	temp n8 i = 0;
+	temp n8 written = 0;
+	while( i < units )
 	{
-		#if OS_LINUX
-			munmap( file_ref->mapped_bytes, file_ref->size );
-		#elif OS_WINDOWS
-			UnmapViewOfFile( file_ref->mapped_bytes );
+		#if SIMD_SSE2
+			while( i + 16 <= units )
+			{
+				temp __m128i const low = _utf8_load( from + i );
+				temp __m128i const high = _utf8_load( from + i + 8 );
+				temp __m128i const wide = _mm_or_si128( low, high );
+				skip_if( _mm_movemask_epi8( _mm_cmpeq_epi16( _mm_and_si128( wide, _mm_set1_epi16( -0x80 ) ), _mm_setzero_si128() ) ) isnt 0xFFFF );
+				_utf8_store( to + written, _mm_packus_epi16( low, high ) );
+				i += 16;
+				written += 16;
+			}
+			skip_if( i is units );
 		#endif
+		temp n4 code = from[ i++ ];
+		if( code >= 0xD800 and code <= 0xDFFF )
+		{
+			if( code <= 0xDBFF and i < units and from[ i ] >= 0xDC00 and from[ i ] <= 0xDFFF )
+			{
+				code = 0x10000 + ( ( code - 0xD800 ) << 10 ) + ( from[ i++ ] - 0xDC00 );
+			}
+			else code = utf8_replacement;
+		}
+		written += utf8_encode( to + written, code );
 	}
-	os_file_ref_clear( file_ref );
+	out written;
+}
+
+embed n8 utf32_to_utf8( anon ref const to_ref, n4 const ref const from, n8 const count )
+{
+	temp n1 ref const to = to_ref;
+	temp n8 written = 0;
+	iter( i, count ) written += utf8_encode( to + written, from[ i ] );
+	out written;
 }
 
 #pragma endregion visible
 ///
 
-#pragma endregion file
+#pragma endregion utf8
 ////
 
+#pragma endregion bytes
+/////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region - ATOMIC
+//
+
+#define atomic_load( REF ) __atomic_load_n( REF, __ATOMIC_ACQUIRE )
+#define atomic_load_relaxed( REF ) __atomic_load_n( REF, __ATOMIC_RELAXED )
+#define atomic_store( REF, VAL ) __atomic_store_n( REF, VAL, __ATOMIC_RELEASE )
+#define atomic_store_relaxed( REF, VAL ) __atomic_store_n( REF, VAL, __ATOMIC_RELAXED )
+#define atomic_add( REF, VAL ) __atomic_fetch_add( REF, VAL, __ATOMIC_ACQ_REL )
+#define atomic_sub( REF, VAL ) __atomic_fetch_sub( REF, VAL, __ATOMIC_ACQ_REL )
+#define atomic_swap( REF, VAL ) __atomic_exchange_n( REF, VAL, __ATOMIC_ACQ_REL )
+#define atomic_compare_swap( REF, EXPECTED_REF, DESIRED ) __atomic_compare_exchange_n( REF, EXPECTED_REF, DESIRED, no, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE )
+#define atomic_fence() __atomic_thread_fence( __ATOMIC_SEQ_CST )
+
+#if COMPILER_GCC and ( defined( __x86_64__ ) or defined( __i386__ ) )
+	#define atomic_pause() __builtin_ia32_pause()
+#elif COMPILER_GCC and defined( __aarch64__ )
+	#define atomic_pause() __asm__ __volatile__( "yield" )
+#else
+	#define atomic_pause() REQUIRE_SEMICOLON
+#endif
+
+#pragma endregion atomic
+/////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region - OS
+//
+
+type_from( FILE ref ) os_handle;
+#define os_handle_get_line fgets
+
 ////////////////////////////////////////////////////////////////
-#pragma region - folder
+#pragma region - ref
 
-fn os_create_folder( byte const ref const path )
+////////////////////////////////
+#pragma region | ref / hidden
+
+#define _ALLOC_PAGE_MASK 4095
+#define _ALLOC_HEADER size_of( n8 )
+#define _alloc_page_round( SIZE ) ( ( ( SIZE ) + _ALLOC_PAGE_MASK ) & ~ _ALLOC_PAGE_MASK )
+#define _alloc_base( REF ) ( to( n1 ref, REF ) - _ALLOC_HEADER )
+#define _alloc_total( REF ) val_of( to( n8 ref, _alloc_base( REF ) ) )
+
+embed anon ref _alloc( n8 const size )
 {
+	temp n8 const total = _alloc_page_round( size + _ALLOC_HEADER );
 	#if OS_LINUX
-		mkdir( path, 0755 );
-	#else
-		CreateDirectoryA( path, nothing );
+		temp anon ref const alloc = mmap( nothing, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+		out_if( alloc is MAP_FAILED ) nothing;
+	#elif OS_WINDOWS
+		temp anon ref const alloc = VirtualAlloc( nothing, total, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE );
+		out_if( alloc is nothing ) nothing;
 	#endif
+	val_of( to( n8 ref, alloc ) ) = total;
+	out to( anon ref, to( n1 ref, alloc ) + _ALLOC_HEADER );
 }
 
-embed flag os_folder_exists( byte const ref const path )
+fn _free( anon ref const anon_ref )
 {
 	#if OS_LINUX
-		struct stat st;
-		out( stat( path, ref_of( st ) ) is 0 and S_ISDIR( st.st_mode ) );
+		munmap( _alloc_base( anon_ref ), _alloc_total( anon_ref ) );
 	#elif OS_WINDOWS
-		DWORD attrib = GetFileAttributesA( path );
-		out( attrib isnt INVALID_FILE_ATTRIBUTES and ( attrib & FILE_ATTRIBUTE_DIRECTORY ) );
+		VirtualFree( _alloc_base( anon_ref ), 0, MEM_RELEASE );
 	#endif
 }
 
-fn os_delete_folder( byte const ref const path )
+embed anon ref const _ref_resize( anon ref const anon_ref, n8 const new_size, flag const preserve )
 {
-	out_if( not os_folder_exists( path ) );
+	out_if( new_size > n8_max_val - _ALLOC_HEADER - _ALLOC_PAGE_MASK ) nothing;
+	out_if( anon_ref is nothing ) _alloc( new_size );
+
+	temp n8 const old_total = _alloc_total( anon_ref );
+	temp n8 const new_total = _alloc_page_round( new_size + _ALLOC_HEADER );
+	out_if( new_total is old_total ) anon_ref;
 
-	byte cmd[ path_max_size + 32 ];
-	temp byte ref cmd_ref = cmd;
 	#if OS_LINUX
-		bytes_paste_move( cmd_ref, "rm -rf \"" );
-		bytes_paste_move( cmd_ref, path );
-		bytes_paste_move( cmd_ref, "\"" );
-	#else
-		bytes_paste_move( cmd_ref, "rmdir /s /q \"" );
-		bytes_paste_move( cmd_ref, path );
-		bytes_paste_move( cmd_ref, "\" 2>nul" );
+		if( preserve is yes )
+		{
+			temp anon ref const new_alloc = mremap( _alloc_base( anon_ref ), old_total, new_total, MREMAP_MAYMOVE );
+			out_if( new_alloc is MAP_FAILED ) nothing;
+			val_of( to( n8 ref, new_alloc ) ) = new_total;
+			out to( anon ref, to( n1 ref, new_alloc ) + _ALLOC_HEADER );
+		}
+	#endif
+	temp anon ref const new_alloc = _alloc( new_size );
+	out_if( new_alloc is nothing ) nothing;
+
+	#if OS_WINDOWS
+		if( preserve is yes )
+		{
+			temp n8 const old_size = old_total - _ALLOC_HEADER;
+			bytes_copy( new_alloc, anon_ref, pick( new_size < old_size, new_size, old_size ) );
+		}
 	#endif
-	bytes_end( cmd_ref );
-	command_silent( cmd );
+	_free( anon_ref );
+	out new_alloc;
 }
 
-#pragma endregion folder
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | ref / visible
+
+#define os_create_ref( TYPE, AMOUNT... ) to( TYPE ref, _alloc( size_of( TYPE ) * DEFAULT( 1, AMOUNT ) ) )
+#define os_delete_ref( REF ) START_DEF { skip_if_nothing( REF ); _free( REF ); REF = nothing; } END_DEF
+#define os_resize_ref( REF, NEW_SIZE, PRESERVE ) to( type_of( REF ), _ref_resize( REF, NEW_SIZE, PRESERVE ) )
+
+#pragma endregion visible
+///
+
+#pragma endregion ref
 ////
 
 ////////////////////////////////////////////////////////////////
-#pragma region - sleep
+#pragma region - command
 
-#if OS_LINUX
-	#define sleep( MILLISECONDS ) usleep( ( MILLISECONDS ) * 1000 )
-#elif OS_WINDOWS
-	#define sleep( MILLISECONDS ) Sleep( MILLISECONDS )
-#endif
+#define command( COMMAND ) system( COMMAND )
+#define command_read_open( COMMAND ) popen( COMMAND, "r" )
+#define command_read_close( OS_FILE_HANDLE ) pclose( OS_FILE_HANDLE )
 
-#pragma endregion sleep
-////
+embed out_state command_silent( byte const ref const command )
+{
+	#if OS_LINUX
+		out command( command );
+	#elif OS_WINDOWS
+		byte buf[ 1024 ] = "cmd.exe /c ";
+		bytes_paste( buf + 11, command );
 
-#pragma endregion os
-/////
+		STARTUPINFOA si = { sizeof( si ), .dwFlags = STARTF_USESHOWWINDOW, .wShowWindow = SW_HIDE };
+		PROCESS_INFORMATION pi;
+		if( not CreateProcessA( nothing, buf, nothing, nothing, FALSE, CREATE_NEW_CONSOLE, nothing, nothing, ref_of( si ), ref_of( pi ) ) )
+		{
+			out -1;
+		}
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#pragma region - MATHEMATICS
-//
+		WaitForSingleObject( pi.hProcess, INFINITE );
+		DWORD code;
+		GetExitCodeProcess( pi.hProcess, ref_of( code ) );
+		CloseHandle( pi.hProcess );
+		CloseHandle( pi.hThread );
+		out code;
+	#endif
+}
 
-#define MIN( A, B ) pick( ( A ) < ( B ), ( A ), ( B ) )
-#define MIN3( A, B, C ) MIN( A, MIN( B, C ) )
-#define MIN4( A, B, C, D ) MIN3( A, B, MIN( C, D ) )
-#define MIN5( A, B, C, D, E ) MIN4( A, B, C, MIN( D, E ) )
+embed os_handle command_read_open_silent( byte const ref const command )
+{
+	#if OS_LINUX
+		out command_read_open( command );
+	#elif OS_WINDOWS
+		byte buf[ 1024 ] = "cmd.exe /c ";
+		bytes_paste( buf + 11, command );
 
-#define MAX( A, B ) pick( ( A ) > ( B ), ( A ), ( B ) )
-#define MAX3( A, B, C ) MAX( A, MAX( B, C ) )
-#define MAX4( A, B, C, D ) MAX3( A, B, MAX( C, D ) )
-#define MAX5( A, B, C, D, E ) MAX4( A, B, C, MAX( D, E ) )
+		SECURITY_ATTRIBUTES sa = { sizeof( sa ), nothing, TRUE };
+		HANDLE rd,
+		wr;
+		CreatePipe( ref_of( rd ), ref_of( wr ), ref_of( sa ), 0 );
+		SetHandleInformation( rd, HANDLE_FLAG_INHERIT, 0 );
 
-#define MEDIAN( A, B, C ) pick( ( A ) > ( B ), pick( ( B ) > ( C ), ( B ), MIN( A, C ) ), pick( ( A ) > ( C ), ( A ), MIN( B, C ) ) )
-#define MEDIAN4( A, B, C, D ) ( ( ( MIN( MAX( A, B ), MAX( C, D ) ) + MAX( MIN( A, B ), MIN( C, D ) ) ) ) / 2 )
-#define MEDIAN4_BITWISE( A, B, C, D ) ( ( ( MIN( MAX( A, B ), MAX( C, D ) ) + MAX( MIN( A, B ), MIN( C, D ) ) ) ) >> 1 )
-#define MEDIAN5( A, B, C, D, E ) ( ( A + B + C + D + E - MIN5( A, B, C, D, E ) - MAX5( A, B, C, D, E ) ) / 3 )
+		HANDLE nul_in = CreateFileA( "NUL", GENERIC_READ, FILE_SHARE_READ, ref_of( sa ), OPEN_EXISTING, 0, nothing );
 
-#define AVG( A, B ) ( ( ( A ) + ( B ) ) / 2 )
-#define AVG_BITWISE( A, B ) ( ( ( A ) + ( B ) ) >> 1 )
-#define AVG3( A, B, C ) ( ( ( A ) + ( B ) + ( C ) ) / 3 )
-#define AVG4( A, B, C, D ) ( ( ( A ) + ( B ) + ( C ) + ( D ) ) / 4 )
-#define AVG4_BITWISE( A, B, C, D ) ( ( ( A ) + ( B ) + ( C ) + ( D ) ) >> 2 )
+		STARTUPINFOA si = { sizeof( si ), .dwFlags = STARTF_USESHOWWINDOW | STARTF_USESTDHANDLES, .wShowWindow = SW_HIDE, .hStdInput = nul_in, .hStdOutput = wr, .hStdError = wr };
+		PROCESS_INFORMATION pi;
+		CreateProcessA( nothing, buf, nothing, nothing, TRUE, CREATE_NEW_CONSOLE, nothing, nothing, ref_of( si ), ref_of( pi ) );
 
-#define CLAMP( V, MINIMUM, MAXIMUM ) MIN( MAX( ( V ), ( MINIMUM ) ), ( MAXIMUM ) )
-#define SATURATE( V ) CLAMP( V, 0, 1 )
-#define SQR( V ) ( ( V ) * ( V ) )
-#define CUBE( V ) ( ( V ) * ( V ) * ( V ) )
-#define ABS( V ) pick( ( V ) < 0, -( V ), V )
-#define SIGN( V ) pick( ( V ) >= 0, 1, -1 )
-#define SIGN_ZERO( V ) pick( ( V ) > 0, 1, pick( ( V ) < 0, -1, 0 ) )
+		CloseHandle( wr );
+		CloseHandle( nul_in );
+		CloseHandle( pi.hThread );
+		CloseHandle( pi.hProcess );
 
-#define MIX( A, B, AMOUNT ) ( ( A ) + ( AMOUNT ) * ( ( B ) - ( A ) ) )
-#define MAP( V, A, B, C, D ) ( ( V ) - ( A ) ) * ( ( D ) - ( C ) ) / ( ( B ) - ( A ) ) + ( C )
-#define RANGE( V, LOWER, UPPER ) ( ( V - ( LOWER ) ) / ( ( UPPER ) - ( LOWER ) ) )
+		out _fdopen( _open_osfhandle( to( intptr_t, rd ), 0 ), "r" );
+	#endif
+}
+
+#define command_read_close_silent( OS_FILE_HANDLE ) OS_PICK( command_read_close( OS_FILE_HANDLE ), fclose( OS_FILE_HANDLE ) )
+
+fn command_get_input( byte ref const bytes, n2 const bytes_size )
+{
+	os_handle_get_line( bytes, bytes_size, stdin );
+	temp n2 const input_size = bytes_measure( bytes );
+	out_if( input_size is 0 );
+	bytes[ input_size - 1 ] = eof_byte;
+}
+
+#pragma endregion command
+////
 
 ////////////////////////////////////////////////////////////////
-#pragma region - functions
+#pragma region - print
 
-#define FUNCTION_GROUP_BASE( T, N )\
-	embed T##N T##N##_min( T##N const a, T##N const b )\
-	{\
-		out MIN( a, b );\
-	}\
-	embed T##N T##N##_min3( T##N const a, T##N const b, T##N const c )\
-	{\
-		out MIN3( a, b, c );\
-	}\
-	embed T##N T##N##_min4( T##N const a, T##N const b, T##N const c, T##N const d )\
-	{\
-		out MIN4( a, b, c, d );\
-	}\
-	embed T##N T##N##_min5( T##N const a, T##N const b, T##N const c, T##N const d, T##N const e )\
-	{\
+#define print( BYTES ) fputs( BYTES, stdout )
+#define print_count( BYTES, SIZE ) fwrite( BYTES, 1, SIZE, stdout )
+#define print_show() fflush( stdout )
+#define print_clear() system( OS_PICK( "clear", "cls" ) )
+
+#define print_newline() print_count( newline, 1 )
+#define print_separator() print_count( separator, 1 )
+#define print_tab() print_count( tab, 1 )
+
+#pragma endregion print
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - path
+
+#define path_max_size 260
+
+#if OS_WINDOWS
+	// paths are UTF-8, and reach the wide-character calls through a path_max_size buffer
+	embed wchar_t const ref _os_wide_path( byte const ref const path, wchar_t ref const wide )
+	{
+		temp n8 const size = bytes_measure( path );
+		temp n8 const units = pick( size < path_max_size, utf8_to_utf16( to( n2 ref, wide ), path, size ), 0 );
+		wide[ units ] = 0;
+		out wide;
+	}
+	#define _os_wide( PATH ) _os_wide_path( PATH, ( wchar_t[ path_max_size ] ){ 0 } )
+	#define _os_fopen( PATH, MODE ) _wfopen( _os_wide( PATH ), L##MODE )
+#else
+	#define _os_fopen( PATH, MODE ) fopen( PATH, MODE )
+#endif
+
+#define path( FOLDERS... ) CHAIN(,, separator, FOLDERS )
+
+fn program_get_path( byte ref const out_bytes )
+{
+	#if OS_LINUX
+		temp i8 _s = readlink( "/proc/self/exe", out_bytes, path_max_size );
+	#elif OS_WINDOWS
+		GetModuleFileNameA( nothing, out_bytes, path_max_size );
+	#endif
+}
+
+fn path_up_folder( byte ref const path )
+{
+	temp byte ref p = path + bytes_measure( path );
+	while( p > path and val_of( --p ) isnt '\\' and val_of( p ) isnt '/' );
+	if( p > path ) val_of( p ) = eof_byte;
+}
+
+embed byte ref const path_get_name( byte ref const path )
+{
+	temp byte ref p = path + bytes_measure( path );
+	while( p > path and val_of( --p ) isnt '\\' and val_of( p ) isnt '/' );
+	if( p > path ) ++p;
+	out p;
+}
+
+embed byte ref const path_get_extension( byte ref const path )
+{
+	temp byte ref p = path + bytes_measure( path );
+	while( p > path and val_of( --p ) isnt '.' );
+	if( p > path ) ++p;
+	out p;
+}
+
+// views stop at the last separator, and have no extension when the name has no '.'
+embed bytes_view path_view_up_folder( bytes_view const path )
+{
+	temp n8 position = path.size;
+	while( position > 0 and path.bytes[ position - 1 ] isnt '\\' and path.bytes[ position - 1 ] isnt '/' ) --position;
+	out pick( position > 1, bytes_view_slice( path, 0, position - 1 ), path );
+}
+
+embed bytes_view path_view_get_name( bytes_view const path )
+{
+	temp n8 position = path.size;
+	while( position > 0 and path.bytes[ position - 1 ] isnt '\\' and path.bytes[ position - 1 ] isnt '/' ) --position;
+	// like path_get_name, a leading separator stays on the name ("/a" names "/a")
+	out bytes_view_skip( path, pick( position is 1, 0, position ) );
+}
+
+embed bytes_view path_view_get_extension( bytes_view const path )
+{
+	temp bytes_view const name = path_view_get_name( path );
+	temp n8 const dot = bytes_view_find_last( name, '.' );
+	out bytes_view_skip( name, pick( dot is name.size, name.size, dot + 1 ) );
+}
+
+#pragma endregion path
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - entries
+
+group( entry_type )
+{
+	entry_unknown,
+	entry_folders,
+	entry_files,
+	entry_any
+};
+
+embed n2 os_get_entries( byte const ref const folder_path, byte entries[][ path_max_size ], n2 const max_entries, entry_type const type, flag const folder_separator )
+{
+	n2 count = 0,
+	len = bytes_measure( folder_path );
+	perm byte path[ path_max_size ];
+	bytes_paste( path, folder_path );
+	#if OS_LINUX
+		struct dirent ref entry;
+		struct stat stat_buf;
+		anon ref handle = opendir( path );
+		out_if_nothing( handle ) 0;
+
+		path[ len++ ] = '/';
+		while( ( entry = readdir( handle ) ) and count < max_entries )
+		{
+			next_if( entry->d_name[ 0 ] is '.' );
+
+			n2 esz = bytes_measure( entry->d_name ) + 1;
+			bytes_copy( path + len, entry->d_name, esz );
+			next_if( stat( path, ref_of( stat_buf ) ) isnt 0 );
+
+			flag is_dir = flag( S_ISDIR( stat_buf.st_mode ) );
+			next_if( type isnt entry_any and is_dir isnt ( type is entry_folders ) );
+
+			bytes_copy( entries[ count ], entry->d_name, esz );
+			if( is_dir and folder_separator )
+			{
+				entries[ count ][ esz - 1 ] = separator_byte;
+				entries[ count ][ esz ] = eof_byte;
+			}
+			++count;
+		}
+		closedir( handle );
+	#elif OS_WINDOWS
+		WIN32_FIND_DATAW entry;
+		bytes_copy( path + len, "\\*", 3 );
+		anon ref handle = FindFirstFileW( _os_wide( path ), ref_of( entry ) );
+		out_if( handle is INVALID_HANDLE_VALUE ) 0;
+
+		do
+		{
+			next_if( entry.cFileName[ 0 ] is L'.' );
+
+			flag is_dir = flag( entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY );
+			next_if( type isnt entry_any and is_dir isnt ( type is entry_folders ) );
+
+			// names come back as UTF-16; one that does not fit an entry as UTF-8 is left out
+			byte name[ utf16_to_utf8_size( MAX_PATH ) ];
+			temp n8 const name_size = utf16_to_utf8( name, to( n2 const ref, entry.cFileName ), wcslen( entry.cFileName ) );
+			next_if( name_size + 2 > path_max_size );
+			n2 esz = n2( name_size ) + 1;
+			bytes_copy( entries[ count ], name, name_size );
+			entries[ count ][ esz - 1 ] = eof_byte;
+			if( is_dir and folder_separator )
+			{
+				entries[ count ][ esz - 1 ] = separator_byte;
+				entries[ count ][ esz ] = eof_byte;
+			}
+			++count;
+		}
+		while( count < max_entries and FindNextFileW( handle, ref_of( entry ) ) );
+		FindClose( handle );
+	#endif
+	out count;
+}
+
+#define os_get_files( PATH, OUT_ENTRIES, MAX_ENTRIES ) os_get_entries( PATH, OUT_ENTRIES, MAX_ENTRIES, entry_files, no )
+#define os_get_folders( PATH, OUT_ENTRIES, MAX_ENTRIES, FOLDER_SEPARATOR... ) os_get_entries( PATH, OUT_ENTRIES, MAX_ENTRIES, entry_folders, DEFAULT( yes, FOLDER_SEPARATOR ) )
+
+#pragma endregion entries
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - file
+
+type( os_file )
+{
+	byte path[ path_max_size ];
+	n2 path_size;
+	os_handle handle;
+	byte const ref mapped_bytes;
+	n8 size;
+};
+
+////////////////////////////////
+#pragma region | file / hidden
+
+embed n8 _os_file_size( byte const ref const file_path )
+{
+	#if OS_LINUX
+		struct stat st;
+		out pick( stat( file_path, ref_of( st ) ) is 0, to( n8 const, st.st_size ), 0 );
+	#elif OS_WINDOWS
+		WIN32_FILE_ATTRIBUTE_DATA fad;
+		out pick( GetFileAttributesExW( _os_wide( file_path ), GetFileExInfoStandard, ref_of( fad ) ), to( n8 const, ( n8( fad.nFileSizeHigh ) << 32 ) | n8( fad.nFileSizeLow ) ), 0 );
+	#endif
+}
+
+embed os_file _os_file_saving( byte const ref const path, n4 const path_size )
+{
+	os_file f = { 0 };
+	f.handle = _os_fopen( path, "wb" );
+	out_if_nothing( f.handle ) f;
+	f.path_size = path_size;
+	bytes_copy( f.path, path, f.path_size );
+	out f;
+}
+
+embed os_file _os_file_loading( byte const ref const path, n4 const path_size )
+{
+	os_file f = { 0 };
+	f.size = _os_file_size( path );
+	if( f.size is 0 ) out f;
+	f.handle = _os_fopen( path, "rb" );
+	out_if_nothing( f.handle ) f;
+	f.path_size = path_size;
+	bytes_copy( f.path, path, f.path_size );
+	out f;
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | file / visible
+
+embed flag os_file_exists( byte const ref const path )
+{
+	#if OS_LINUX
+		struct stat st;
+		out stat( path, ref_of( st ) ) is 0 and S_ISREG( st.st_mode );
+	#elif OS_WINDOWS
+		DWORD attrib = GetFileAttributesW( _os_wide( path ) );
+		out attrib isnt INVALID_FILE_ATTRIBUTES and not( attrib & FILE_ATTRIBUTE_DIRECTORY );
+	#endif
+}
+
+#define os_create_file( PATH, PATH_SIZE... ) _os_file_saving( PATH, DEFAULT( bytes_measure( PATH ), PATH_SIZE ) )
+#define os_open_file( PATH, PATH_SIZE... ) _os_file_loading( PATH, DEFAULT( bytes_measure( PATH ), PATH_SIZE ) )
+
+embed os_file _os_map_file( byte const ref const path, n4 const path_size )
+{
+	os_file f = { 0 };
+	f.size = _os_file_size( path );
+	if( f.size is 0 ) out f;
+	#if OS_LINUX
+		i4 fd = open( path, O_RDONLY );
+		out_if( fd is -1 ) f;
+		anon ref mapped = mmap( nothing, f.size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		close( fd );
+		out_if( mapped is MAP_FAILED ) f;
+		f.mapped_bytes = to( byte ref, mapped );
+	#elif OS_WINDOWS
+		HANDLE hf = CreateFileW( _os_wide( path ), GENERIC_READ, FILE_SHARE_READ, nothing, OPEN_EXISTING, 0, nothing );
+		out_if( hf is INVALID_HANDLE_VALUE ) f;
+		HANDLE hm = CreateFileMapping( hf, nothing, PAGE_READONLY, 0, 0, nothing );
+		CloseHandle( hf );
+		if_nothing( hm ) out f;
+		f.mapped_bytes = to( byte ref, MapViewOfFile( hm, FILE_MAP_READ, 0, 0, 0 ) );
+		CloseHandle( hm );
+	#endif
+	f.path_size = path_size;
+	bytes_copy( f.path, path, f.path_size );
+	out f;
+}
+#define os_map_file( PATH, PATH_SIZE... ) _os_map_file( PATH, DEFAULT( bytes_measure( PATH ), PATH_SIZE ) )
+
+// the OS calls need an eof, so a view path is copied once; longer than path_max_size fails
+#define _os_file_view( OPEN, PATH_VIEW )\
+	START_DEF\
+	{\
+		temp bytes_view const _PATH = PATH_VIEW;\
+		byte _path[ path_max_size ];\
+		if( _PATH.size < path_max_size )\
+		{\
+			bytes_copy( _path, _PATH.bytes, _PATH.size );\
+			_path[ _PATH.size ] = eof_byte;\
+			_file = OPEN( _path, _PATH.size );\
+		}\
+	}\
+	END_DEF
+
+embed os_file os_create_file_view( bytes_view const path )
+{
+	os_file _file = { 0 };
+	_os_file_view( _os_file_saving, path );
+	out _file;
+}
+
+embed os_file os_open_file_view( bytes_view const path )
+{
+	os_file _file = { 0 };
+	_os_file_view( _os_file_loading, path );
+	out _file;
+}
+
+embed os_file os_map_file_view( bytes_view const path )
+{
+	os_file _file = { 0 };
+	_os_file_view( _os_map_file, path );
+	out _file;
+}
+
+#define os_file_view( FILE ) make( bytes_view, ( FILE ).mapped_bytes, ( FILE ).size )
+#define os_file_path_view( FILE ) make( bytes_view, ( FILE ).path, ( FILE ).path_size )
+
+fn os_delete_file( const byte ref const path )
+{
+	#if OS_WINDOWS
+		_wremove( _os_wide( path ) );
+	#else
+		remove( path );
+	#endif
+}
+
+fn os_file_ref_save( os_file ref const file_ref, byte const ref const bytes, n8 const size )
+{
+	if_nothing( file_ref->handle ) out;
+	fseek( file_ref->handle, 0, SEEK_SET );
+	file_ref->size = size;
+	fwrite( bytes, 1, file_ref->size, file_ref->handle );
+	fflush( file_ref->handle );
+}
+
+fn os_file_ref_load( os_file ref const file_ref, byte ref const out_bytes )
+{
+	if_nothing( file_ref->handle ) out;
+	fseek( file_ref->handle, 0, SEEK_SET );
+	fread( out_bytes, 1, file_ref->size, file_ref->handle );
+}
+
+fn os_file_ref_clear( os_file ref const file_ref )
+{
+	file_ref->handle = nothing;
+	bytes_clear( file_ref->path, file_ref->path_size );
+	file_ref->path_size = 0;
+	file_ref->size = 0;
+}
+
+fn os_file_ref_close( os_file ref const file_ref )
+{
+	if_something( file_ref->handle ) fclose( file_ref->handle );
+	os_file_ref_clear( file_ref );
+}
+
+fn os_file_ref_unmap( os_file ref const file_ref )
+{
+	if_something( file_ref->mapped_bytes )
+	{
+		#if OS_LINUX
+			munmap( file_ref->mapped_bytes, file_ref->size );
+		#elif OS_WINDOWS
+			UnmapViewOfFile( file_ref->mapped_bytes );
+		#endif
+	}
+	os_file_ref_clear( file_ref );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion file
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - folder
+
+fn os_create_folder( byte const ref const path )
+{
+	#if OS_LINUX
+		mkdir( path, 0755 );
+	#else
+		CreateDirectoryW( _os_wide( path ), nothing );
+	#endif
+}
+
+embed flag os_folder_exists( byte const ref const path )
+{
+	#if OS_LINUX
+		struct stat st;
+		out( stat( path, ref_of( st ) ) is 0 and S_ISDIR( st.st_mode ) );
+	#elif OS_WINDOWS
+		DWORD attrib = GetFileAttributesW( _os_wide( path ) );
+		out( attrib isnt INVALID_FILE_ATTRIBUTES and ( attrib & FILE_ATTRIBUTE_DIRECTORY ) );
+	#endif
+}
+
+#if OS_WINDOWS
+	// empties and removes the folder of SIZE units in PATH, a path_max_size buffer it appends to;
+	// linked folders are removed as links, not followed
+	embed flag _os_delete_folder_wide( wchar_t ref const path, n8 const size )
+	{
+		out_if( size + 3 > path_max_size ) no;
+		bytes_copy( path + size, L"\\*", 3 * size_of( wchar_t ) );
+		temp flag deleted = yes;
+		WIN32_FIND_DATAW entry;
+		temp HANDLE const handle = FindFirstFileW( path, ref_of( entry ) );
+		if( handle isnt INVALID_HANDLE_VALUE )
+		{
+			do
+			{
+				next_if( wcscmp( entry.cFileName, L"." ) is 0 or wcscmp( entry.cFileName, L".." ) is 0 );
+				temp n8 const name_size = wcslen( entry.cFileName );
+				if( size + 2 + name_size > path_max_size )
+				{
+					deleted = no;
+					next;
+				}
+				path[ size ] = L'\\';
+				bytes_copy( path + size + 1, entry.cFileName, ( name_size + 1 ) * size_of( wchar_t ) );
+				temp DWORD const attributes = entry.dwFileAttributes;
+				if( attributes & FILE_ATTRIBUTE_READONLY ) SetFileAttributesW( path, attributes & ~FILE_ATTRIBUTE_READONLY );
+				if( not( attributes & FILE_ATTRIBUTE_DIRECTORY ) ) deleted = DeleteFileW( path ) and deleted;
+				else if( attributes & FILE_ATTRIBUTE_REPARSE_POINT ) deleted = RemoveDirectoryW( path ) and deleted;
+				else deleted = _os_delete_folder_wide( path, size + 1 + name_size ) and deleted;
+			}
+			while( FindNextFileW( handle, ref_of( entry ) ) );
+			FindClose( handle );
+		}
+		path[ size ] = 0;
+		out RemoveDirectoryW( path ) and deleted;
+	}
+#endif
+
+fn os_delete_folder( byte const ref const path )
+{
+	out_if( not os_folder_exists( path ) );
+
+	#if OS_LINUX
+		byte cmd[ path_max_size + 32 ];
+		temp byte ref cmd_ref = cmd;
+		bytes_paste_move( cmd_ref, "rm -rf \"" );
+		bytes_paste_move( cmd_ref, path );
+		bytes_paste_move( cmd_ref, "\"" );
+		bytes_end( cmd_ref );
+		command_silent( cmd );
+	#else
+		wchar_t wide[ path_max_size ];
+		_os_wide_path( path, wide );
+		_os_delete_folder_wide( wide, wcslen( wide ) );
+	#endif
+}
+
+#pragma endregion folder
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - time
+
+// monotonic nanoseconds, and a raw cycle counter for short spans (falls back to nanoseconds)
+
+embed n8 os_time_ns()
+{
+	#if OS_LINUX
+		struct timespec ts;
+		clock_gettime( CLOCK_MONOTONIC, ref_of( ts ) );
+		out n8( ts.tv_sec ) * 1000000000ull + n8( ts.tv_nsec );
+	#elif OS_WINDOWS
+		perm LARGE_INTEGER frequency = { 0 };
+		if( frequency.QuadPart is 0 ) QueryPerformanceFrequency( ref_of( frequency ) );
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter( ref_of( counter ) );
+		temp n8 const ticks = counter.QuadPart, rate = frequency.QuadPart;
+		out ( ticks / rate ) * 1000000000ull + ( ticks mod rate ) * 1000000000ull / rate;
+	#endif
+}
+
+embed n8 os_cycles()
+{
+	#if COMPILER_GCC and ( defined( __x86_64__ ) or defined( __i386__ ) )
+		out __builtin_ia32_rdtsc();
+	#elif COMPILER_GCC and defined( __aarch64__ )
+		n8 ticks;
+		__asm__ __volatile__( "mrs %0, cntvct_el0" : "=r"( ticks ) );
+		out ticks;
+	#else
+		out os_time_ns();
+	#endif
+}
+
+#pragma endregion time
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - perf
+
+// hardware counters around a span of code on the calling thread: `os_perf_begin` / `os_perf_end`
+// accumulate into `values`, and `available` has a bit per counter that could be read
+// without perf_event_open (not permitted, or no kernel headers and H_PERF_EVENTS 0) cycles come
+// from `os_cycles`, and page faults from getrusage; the rest stay unavailable
+// a run whose counters cannot be read at its start or end only adds the fallback counters
+
+enum
+{
+	OS_PERF_CYCLES,
+	OS_PERF_INSTRUCTIONS,
+	OS_PERF_CACHE_REFERENCES,
+	OS_PERF_CACHE_MISSES,
+	OS_PERF_BRANCH_MISSES,
+	OS_PERF_PAGE_FAULTS,
+	OS_PERF_COUNT
+};
+
+perm byte const ref const os_perf_names[ OS_PERF_COUNT ] =
+{
+	"cycles", "instructions", "cache references", "cache misses", "branch misses", "page faults"
+};
+
+type_from( variant os_perf ) os_perf;
+variant os_perf
+{
+	i4 fds[ OS_PERF_COUNT ];
+	i4 group;
+	n4 available;
+	n4 hardware;
+	n8 runs;
+	n8 time_ns;
+	n8 values[ OS_PERF_COUNT ];
+	n8 before[ OS_PERF_COUNT ];
+	n8 start_ns;
+	flag counting;
+};
+
+////////////////////////////////
+#pragma region | perf / hidden
+
+#if OS_LINUX
+
+embed n8 _os_perf_page_faults()
+{
+	struct rusage usage;
+	out_if( getrusage( RUSAGE_THREAD, ref_of( usage ) ) isnt 0 ) 0;
+	out n8( usage.ru_minflt ) + n8( usage.ru_majflt );
+}
+
+// reads the group, scaled up when the kernel had to multiplex the counters
+embed flag _os_perf_read( os_perf ref const perf, n8 ref const values )
+{
+	n8 buffer[ 3 + OS_PERF_COUNT ];
+	temp n8 expected = 3;
+	iter( i, OS_PERF_COUNT ) expected += perf->fds[ i ] >= 0;
+	out_if( read( perf->group, buffer, size_of( buffer ) ) < to( ssize_t, expected * size_of( n8 ) ) ) no;
+	temp n8 const enabled = buffer[ 1 ], running = buffer[ 2 ];
+	temp n8 slot = 3;
+	iter( i, OS_PERF_COUNT )
+	{
+		values[ i ] = 0;
+		if( perf->fds[ i ] < 0 ) next;
+		temp n8 value = buffer[ slot++ ];
+		if( running > 0 and running < enabled ) value = n8( r8( value ) * r8( enabled ) / r8( running ) );
+		values[ i ] = value;
+	}
+	out yes;
+}
+
+#endif
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | perf / visible
+
+embed flag os_perf_open( os_perf ref const perf )
+{
+	bytes_clear( perf, size_of( os_perf ) );
+	perf->group = -1;
+	iter( i, OS_PERF_COUNT ) perf->fds[ i ] = -1;
+	#if OS_LINUX and H_PERF_EVENTS
+		perm n4 const types[ OS_PERF_COUNT ] =
+		{
+			PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE
+		};
+		perm n8 const configs[ OS_PERF_COUNT ] =
+		{
+			PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_REFERENCES,
+			PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_PAGE_FAULTS
+		};
+		iter( i, OS_PERF_COUNT )
+		{
+			struct perf_event_attr attr;
+			bytes_clear( ref_of( attr ), size_of( attr ) );
+			attr.size = size_of( attr );
+			attr.type = types[ i ];
+			attr.config = configs[ i ];
+			attr.disabled = perf->group < 0;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			temp i4 const fd = syscall( SYS_perf_event_open, ref_of( attr ), 0, -1, perf->group, 0 );
+			if( fd < 0 ) next;
+			perf->fds[ i ] = fd;
+			if( perf->group < 0 ) perf->group = fd;
+			perf->hardware |= 1u << i;
+		}
+		if( perf->group >= 0 )
+		{
+			ioctl( perf->group, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+			ioctl( perf->group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+		}
+	#endif
+	#if OS_LINUX
+		perf->available = perf->hardware | ( 1u << OS_PERF_CYCLES ) | ( 1u << OS_PERF_PAGE_FAULTS );
+	#else
+		perf->available = 1u << OS_PERF_CYCLES;
+	#endif
+	out perf->hardware isnt 0;
+}
+
+fn os_perf_close( os_perf ref const perf )
+{
+	#if OS_LINUX
+		iter( i, OS_PERF_COUNT )
+		{
+			if( perf->fds[ i ] >= 0 ) close( perf->fds[ i ] );
+			perf->fds[ i ] = -1;
+		}
+		perf->group = -1;
+	#endif
+	perf->hardware = 0;
+}
+
+fn os_perf_reset( os_perf ref const perf )
+{
+	perf->runs = 0;
+	perf->time_ns = 0;
+	bytes_clear( perf->values, size_of( perf->values ) );
+}
+
+fn os_perf_begin( os_perf ref const perf )
+{
+	perf->counting = no;
+	#if OS_LINUX
+		perf->counting = perf->group >= 0 and _os_perf_read( perf, perf->before );
+		if( not( perf->hardware & ( 1u << OS_PERF_PAGE_FAULTS ) ) ) perf->before[ OS_PERF_PAGE_FAULTS ] = _os_perf_page_faults();
+	#endif
+	if( not( perf->hardware & ( 1u << OS_PERF_CYCLES ) ) ) perf->before[ OS_PERF_CYCLES ] = os_cycles();
+	perf->start_ns = os_time_ns();
+}
+
+fn os_perf_end( os_perf ref const perf )
+{
+	temp n8 const end_ns = os_time_ns();
+	n8 end[ OS_PERF_COUNT ] = { 0 };
+	temp flag counted = no;
+	#if OS_LINUX
+		counted = perf->counting and _os_perf_read( perf, end );
+		if( not( perf->hardware & ( 1u << OS_PERF_PAGE_FAULTS ) ) ) end[ OS_PERF_PAGE_FAULTS ] = _os_perf_page_faults();
+	#endif
+	if( not( perf->hardware & ( 1u << OS_PERF_CYCLES ) ) ) end[ OS_PERF_CYCLES ] = os_cycles();
+	iter( i, OS_PERF_COUNT )
+	{
+		next_if( not( perf->available & ( 1u << i ) ) );
+		next_if( ( perf->hardware & ( 1u << i ) ) and not counted );
+		perf->values[ i ] += end[ i ] - perf->before[ i ];
+	}
+	perf->time_ns += end_ns - perf->start_ns;
+	++perf->runs;
+}
+
+// one counter per line, with instructions per cycle and the cache miss rate when known
+fn os_perf_print( os_perf const ref const perf, byte const ref const name )
+{
+	byte line[ 256 ];
+	temp byte ref write = line;
+	bytes_paste_move( write, name );
+	bytes_paste_move( write, ": " );
+	n8_to_bytes_move( perf->runs, write );
+	bytes_paste_move( write, " runs, " );
+	n8_to_bytes_move( perf->time_ns / 1000, write );
+	bytes_paste_move( write, " us" newline );
+	print_count( line, write - line );
+	iter( i, OS_PERF_COUNT )
+	{
+		if( not( perf->available & ( 1u << i ) ) ) next;
+		write = line;
+		bytes_paste_move( write, "  " );
+		bytes_paste_move( write, os_perf_names[ i ] );
+		bytes_paste_move( write, ": " );
+		n8_to_bytes_move( perf->values[ i ], write );
+		if( i is OS_PERF_CYCLES and not( perf->hardware & ( 1u << i ) ) ) bytes_paste_move( write, " (reference)" );
+		bytes_newline_move( write );
+		print_count( line, write - line );
+	}
+	temp n4 const ipc = ( 1u << OS_PERF_CYCLES ) | ( 1u << OS_PERF_INSTRUCTIONS );
+	if( ( perf->hardware & ipc ) is ipc and perf->values[ OS_PERF_CYCLES ] > 0 )
+	{
+		write = line;
+		bytes_paste_move( write, "  instructions per cycle: " );
+		n8_to_bytes_move( perf->values[ OS_PERF_INSTRUCTIONS ] * 100 / perf->values[ OS_PERF_CYCLES ], write );
+		bytes_paste_move( write, " / 100" newline );
+		print_count( line, write - line );
+	}
+	temp n4 const cache = ( 1u << OS_PERF_CACHE_REFERENCES ) | ( 1u << OS_PERF_CACHE_MISSES );
+	if( ( perf->hardware & cache ) is cache and perf->values[ OS_PERF_CACHE_REFERENCES ] > 0 )
+	{
+		write = line;
+		bytes_paste_move( write, "  cache miss rate: " );
+		n8_to_bytes_move( perf->values[ OS_PERF_CACHE_MISSES ] * 100 / perf->values[ OS_PERF_CACHE_REFERENCES ], write );
+		bytes_paste_move( write, "%" newline );
+		print_count( line, write - line );
+	}
+}
+
+// the calling thread's counters, opened on first use and shared by `perf_measure`
+embed os_perf ref os_perf_thread()
+{
+	perm thread_local os_perf perf;
+	perm thread_local flag opened = no;
+	if( not opened )
+	{
+		os_perf_open( ref_of( perf ) );
+		opened = yes;
+	}
+	out ref_of( perf );
+}
+
+embed os_perf ref _perf_measure_begin()
+{
+	temp os_perf ref const perf = os_perf_thread();
+	os_perf_begin( perf );
+	out perf;
+}
+
+fn _perf_measure_end( os_perf ref const ref const perf )
+{
+	os_perf_end( val_of( perf ) );
+}
+
+#define _perf_measure( MEASURE ) __attribute__( ( cleanup( _perf_measure_end ) ) ) os_perf ref const MEASURE = _perf_measure_begin()
+
+// `perf_measure;` adds the rest of its enclosing block to `os_perf_thread()`, however the block is left,
+// so `skip` / `next` / `out` keep their meaning: `{ perf_measure; ... }`; measures should not nest
+#define perf_measure _perf_measure( JOIN( _PERF_MEASURE_, __COUNTER__ ) )
+
+#pragma endregion visible
+///
+
+#pragma endregion perf
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - sleep
+
+#if OS_LINUX
+	#define sleep( MILLISECONDS ) usleep( ( MILLISECONDS ) * 1000 )
+#elif OS_WINDOWS
+	#define sleep( MILLISECONDS ) Sleep( MILLISECONDS )
+#endif
+
+// `sleep_until( DEADLINE_NS )` waits for an `os_time_ns` deadline: the OS timer sleeps until
+// H_SLEEP_SPIN_NS before it ( an absolute clock_nanosleep, or a high-resolution waitable timer ),
+// then the rest is spun, which absorbs timer slack and scheduler ticks
+
+#ifndef H_SLEEP_SPIN_NS
+	#define H_SLEEP_SPIN_NS 100000
+#endif
+
+#if OS_WINDOWS and not defined( CREATE_WAITABLE_TIMER_HIGH_RESOLUTION )
+	#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+fn sleep_until( n8 const deadline_ns )
+{
+	temp n8 const now = os_time_ns();
+	if( deadline_ns > now + H_SLEEP_SPIN_NS )
+	{
+		temp n8 const wake = deadline_ns - H_SLEEP_SPIN_NS;
+		#if OS_LINUX
+			struct timespec const ts = { .tv_sec = to( time_t, wake / 1000000000ull ), .tv_nsec = to( long, wake mod 1000000000ull ) };
+			while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, ref_of( ts ), nothing ) is EINTR );
+		#elif OS_WINDOWS
+			perm thread_local HANDLE timer = nothing;
+			if( timer is nothing ) timer = CreateWaitableTimerExW( nothing, nothing, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS );
+			if( timer is nothing ) timer = CreateWaitableTimerW( nothing, yes, nothing );
+			LARGE_INTEGER due;
+			due.QuadPart = -to( LONGLONG, ( wake - now ) / 100 );
+			if( timer isnt nothing and SetWaitableTimer( timer, ref_of( due ), 0, nothing, nothing, no ) ) WaitForSingleObject( timer, INFINITE );
+		#endif
+	}
+	while( os_time_ns() < deadline_ns ) atomic_pause();
+}
+
+#define sleep_ns( NANOSECONDS ) sleep_until( os_time_ns() + ( NANOSECONDS ) )
+
+#pragma endregion sleep
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - timestep
+
+// a fixed-timestep clock: `timestep_begin` once a frame adds the elapsed time to the lag ( capped at
+// `max_lag_ns` so a stall can't snowball ), `iter_timestep` then runs one update per whole step
+// of lag, `timestep_alpha` is how far into the next step the frame is, for interpolation,
+// and `timestep_wait` sleeps until that step is due
+
+type( timestep )
+{
+	n8 step_ns;
+	n8 previous_ns;
+	n8 lag_ns;
+	n8 max_lag_ns;
+	n8 steps;
+};
+
+embed timestep timestep_create( n8 const step_ns )
+{
+	out make( timestep, .step_ns = step_ns, .previous_ns = os_time_ns(), .max_lag_ns = step_ns * 8 );
+}
+
+#define timestep_hz( HZ ) timestep_create( 1000000000ull / ( HZ ) )
+
+fn timestep_begin( timestep ref const clock )
+{
+	temp n8 const now = os_time_ns();
+	clock->lag_ns += now - clock->previous_ns;
+	clock->previous_ns = now;
+	if( clock->lag_ns > clock->max_lag_ns ) clock->lag_ns = clock->max_lag_ns;
+}
+
+embed flag timestep_next( timestep ref const clock )
+{
+	out_if( clock->lag_ns < clock->step_ns ) no;
+	clock->lag_ns -= clock->step_ns;
+	++clock->steps;
+	out yes;
+}
+
+#define iter_timestep( TIMESTEP_REF ) for( timestep_begin( TIMESTEP_REF ); timestep_next( TIMESTEP_REF ); )
+
+embed r8 timestep_alpha( timestep const ref const clock )
+{
+	out r8( clock->lag_ns ) / r8( clock->step_ns );
+}
+
+fn timestep_wait( timestep const ref const clock )
+{
+	sleep_until( clock->previous_ns + clock->step_ns - pick( clock->lag_ns < clock->step_ns, clock->lag_ns, clock->step_ns ) );
+}
+
+#pragma endregion timestep
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - timers
+
+// a hierarchical timer wheel: 4 levels of 256 slots, `tick_ns` per slot at the first level,
+// covering 2^32 ticks with later deadlines parked in the last level; adding, cancelling and
+// firing each cost O(1), and `timer_wheel_advance` fires everything due by a time in tick order,
+// jumping over idle ticks
+// timers live in one pool, addressed by an n8 id that goes stale once the timer fires or is cancelled
+
+type_fn(, anon ref const ) timer_callback;
+
+////////////////////////////////
+#pragma region | timers / hidden
+
+#define _TIMER_LEVELS 4
+#define _TIMER_SLOTS 256
+#define _TIMER_NONE n4_max_val
+#define _TIMER_FREE n2_max_val
+
+type_from( variant _timer ) _timer;
+variant _timer
+{
+	n8 due;
+	timer_callback callback;
+	anon ref context;
+	n4 before;
+	n4 after;
+	n4 generation;
+	n2 slot;
+};
+
+#pragma endregion hidden
+///
+
+type_from( variant timer_wheel ) timer_wheel;
+variant timer_wheel
+{
+	_timer ref timers;
+	n4 capacity;
+	n4 free;
+	n4 count;
+	n8 tick;
+	n8 tick_ns;
+	n8 origin_ns;
+	n4 heads[ _TIMER_LEVELS * _TIMER_SLOTS ];
+};
+
+////////////////////////////////
+#pragma region | timers / hidden
+
+fn _timer_link( timer_wheel ref const wheel, n4 const index )
+{
+	temp _timer ref const timer = wheel->timers + index;
+	temp n8 const until = timer->due - wheel->tick;
+	temp n1 level = 0;
+	while( level < _TIMER_LEVELS - 1 and until >= ( 1ull << ( 8 * ( level + 1 ) ) ) ) ++level;
+	temp n8 const due = pick( until >> 32, wheel->tick + n4_max_val, timer->due );
+	temp n2 const slot = n2( level * _TIMER_SLOTS + ( ( due >> ( 8 * level ) ) & ( _TIMER_SLOTS - 1 ) ) );
+	timer->slot = slot;
+	timer->before = _TIMER_NONE;
+	timer->after = wheel->heads[ slot ];
+	if( timer->after isnt _TIMER_NONE ) wheel->timers[ timer->after ].before = index;
+	wheel->heads[ slot ] = index;
+}
+
+fn _timer_unlink( timer_wheel ref const wheel, n4 const index )
+{
+	temp _timer ref const timer = wheel->timers + index;
+	if( timer->before isnt _TIMER_NONE ) wheel->timers[ timer->before ].after = timer->after;
+	else wheel->heads[ timer->slot ] = timer->after;
+	if( timer->after isnt _TIMER_NONE ) wheel->timers[ timer->after ].before = timer->before;
+}
+
+fn _timer_release( timer_wheel ref const wheel, n4 const index )
+{
+	temp _timer ref const timer = wheel->timers + index;
+	timer->slot = _TIMER_FREE;
+	++timer->generation;
+	timer->after = wheel->free;
+	wheel->free = index;
+	--wheel->count;
+}
+
+// moves every timer of a higher level slot down to where it now belongs
+fn _timer_cascade( timer_wheel ref const wheel, n2 const slot )
+{
+	temp n4 index = wheel->heads[ slot ];
+	wheel->heads[ slot ] = _TIMER_NONE;
+	while( index isnt _TIMER_NONE )
+	{
+		temp n4 const after = wheel->timers[ index ].after;
+		_timer_link( wheel, index );
+		index = after;
+	}
+}
+
+// the first tick with work: a first-level slot to fire, or a higher slot to cascade; n8_max_val when none
+embed n8 _timer_next_tick( timer_wheel const ref const wheel )
+{
+	temp n8 best = n8_max_val;
+	for( temp n8 tick = wheel->tick + 1; tick < wheel->tick + _TIMER_SLOTS; ++tick )
+	{
+		if( wheel->heads[ tick & ( _TIMER_SLOTS - 1 ) ] isnt _TIMER_NONE )
+		{
+			best = tick;
+			skip;
+		}
+	}
+	for( temp n1 level = 1; level < _TIMER_LEVELS; ++level )
+	{
+		temp n1 const shift = 8 * level;
+		for( temp n8 block = ( wheel->tick >> shift ) + 1; block <= ( wheel->tick >> shift ) + _TIMER_SLOTS and ( block << shift ) < best; ++block )
+		{
+			if( wheel->heads[ level * _TIMER_SLOTS + ( block & ( _TIMER_SLOTS - 1 ) ) ] isnt _TIMER_NONE )
+			{
+				best = block << shift;
+				skip;
+			}
+		}
+	}
+	out best;
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | timers / visible
+
+embed timer_wheel timer_wheel_create( n8 const tick_ns )
+{
+	timer_wheel wheel = { .free = _TIMER_NONE, .tick_ns = pick( tick_ns, tick_ns, 1 ), .origin_ns = os_time_ns() };
+	iter( i, _TIMER_LEVELS * _TIMER_SLOTS ) wheel.heads[ i ] = _TIMER_NONE;
+	out wheel;
+}
+
+fn timer_wheel_delete( timer_wheel ref const wheel )
+{
+	os_delete_ref( wheel->timers );
+	wheel->capacity = wheel->count = 0;
+	wheel->free = _TIMER_NONE;
+	iter( i, _TIMER_LEVELS * _TIMER_SLOTS ) wheel->heads[ i ] = _TIMER_NONE;
+}
+
+// calls CALLBACK( CONTEXT ) once DELAY_NS has passed since NOW_NS, an `os_time_ns`, rounded up to
+// whole ticks; the wheel may lag behind NOW_NS, so the deadline does not count from its last advance;
+// 0 when memory runs out
+embed n8 timer_wheel_add( timer_wheel ref const wheel, n8 const now_ns, n8 const delay_ns, timer_callback const callback, anon ref const context )
+{
+	if( wheel->free is _TIMER_NONE )
+	{
+		temp n4 const capacity = pick( wheel->capacity, wheel->capacity * 2, 64 );
+		temp _timer ref const timers = os_resize_ref( wheel->timers, size_of( _timer ) * capacity, yes );
+		out_if_nothing( timers ) 0;
+		wheel->timers = timers;
+		for( temp n4 i = capacity; i > wheel->capacity; --i )
+		{
+			timers[ i - 1 ].slot = _TIMER_FREE;
+			timers[ i - 1 ].after = wheel->free;
+			wheel->free = i - 1;
+		}
+		wheel->capacity = capacity;
+	}
+	temp n4 const index = wheel->free;
+	temp _timer ref const timer = wheel->timers + index;
+	wheel->free = timer->after;
+	++wheel->count;
+	temp n8 const due_ns = pick( delay_ns > n8_max_val - now_ns, n8_max_val, now_ns + delay_ns );
+	temp n8 const since_ns = pick( due_ns > wheel->origin_ns, due_ns - wheel->origin_ns, 0 );
+	temp n8 const due = since_ns / wheel->tick_ns + pick( since_ns mod wheel->tick_ns, 1, 0 );
+	timer->due = pick( due > wheel->tick, due, wheel->tick + 1 );
+	timer->callback = callback;
+	timer->context = context;
+	_timer_link( wheel, index );
+	out ( n8( timer->generation ) << 32 ) | ( index + 1ull );
+}
+
+// no when the timer already fired or was cancelled
+embed flag timer_wheel_cancel( timer_wheel ref const wheel, n8 const id )
+{
+	temp n4 const index = n4( id ) - 1;
+	out_if( index >= wheel->capacity ) no;
+	temp _timer const ref const timer = wheel->timers + index;
+	out_if( timer->slot is _TIMER_FREE or timer->generation isnt n4( id >> 32 ) ) no;
+	_timer_unlink( wheel, index );
+	_timer_release( wheel, index );
+	out yes;
+}
+
+// fires the timers due by NOW_NS, which callbacks may add to or cancel; gives how many fired
+embed n4 timer_wheel_advance( timer_wheel ref const wheel, n8 const now_ns )
+{
+	temp n8 const target = pick( now_ns > wheel->origin_ns, ( now_ns - wheel->origin_ns ) / wheel->tick_ns, 0 );
+	temp n4 fired = 0;
+	while( wheel->tick < target )
+	{
+		temp n8 const tick = _timer_next_tick( wheel );
+		if( tick > target )
+		{
+			wheel->tick = target;
+			skip;
+		}
+		wheel->tick = tick;
+		for( temp n1 level = _TIMER_LEVELS - 1; level > 0; --level )
+		{
+			if( ( tick & ( ( 1ull << ( 8 * level ) ) - 1 ) ) is 0 ) _timer_cascade( wheel, n2( level * _TIMER_SLOTS + ( ( tick >> ( 8 * level ) ) & ( _TIMER_SLOTS - 1 ) ) ) );
+		}
+		temp n2 const slot = n2( tick & ( _TIMER_SLOTS - 1 ) );
+		while( wheel->heads[ slot ] isnt _TIMER_NONE )
+		{
+			temp n4 const index = wheel->heads[ slot ];
+			temp _timer const timer = wheel->timers[ index ];
+			_timer_unlink( wheel, index );
+			_timer_release( wheel, index );
+			timer.callback( timer.context );
+			++fired;
+		}
+	}
+	out fired;
+}
+
+// the `os_time_ns` by which `timer_wheel_advance` next has work, early when a far timer only
+// moves closer; n8_max_val when there are no timers
+embed n8 timer_wheel_next_ns( timer_wheel const ref const wheel )
+{
+	temp n8 const tick = _timer_next_tick( wheel );
+	out pick( tick is n8_max_val, n8_max_val, wheel->origin_ns + tick * wheel->tick_ns );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion timers
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - events
+
+// `os_create_loop` multiplexes non-blocking sockets, pipes, timers and cross-thread wakeups: epoll,
+// edge-triggered, with timerfd and eventfd on Linux, and WSAPoll over sockets on Windows
+// each `os_watch` calls back on the loop's thread with the `os_event_*` bits that became ready;
+// being edge-triggered, read and write until `os_io_again` before returning
+// `os_watch_on_data` makes the loop drain a watch itself, into buffers from the loop's pool
+// on Windows readiness is level-triggered, pipes are socket pairs and timers are polled deadlines,
+// and Unix domain sockets are Linux only
+
+#define os_event_read 1
+#define os_event_write 2
+#define os_event_close 4
+#define os_event_timer 8
+#define os_event_wake 16
+
+#define os_io_again -1
+#define os_io_error -2
+
+#ifndef H_LOOP_BUFFER
+	#define H_LOOP_BUFFER ( 64 << 10 )
+#endif
+
+#if OS_LINUX
+	type_from( int ) os_socket;
+	#define os_socket_none -1
+#elif OS_WINDOWS
+	type_from( SOCKET ) os_socket;
+	#define os_socket_none INVALID_SOCKET
+#endif
+
+type_from( variant os_loop ) os_loop;
+type_from( variant os_watch ) os_watch;
+type_fn(, os_watch ref const, n4 const ) os_watch_callback;
+type_fn(, os_watch ref const, byte const ref const, n8 const ) os_data_callback;
+
+group( os_watch_kind )
+{
+	os_watch_stream,
+	os_watch_listener,
+	os_watch_timer,
+	os_watch_wakeup
+};
+
+variant os_watch
+{
+	os_loop ref event_loop;
+	os_socket handle;
+	os_watch_callback callback;
+	os_data_callback on_data;
+	anon ref context;
+	os_watch ref retired_after;
+	n8 due_ns;
+	n8 period_ns;
+	n4 events;
+	os_watch_kind kind;
+	flag used;
+	flag closed;
+};
+
+////////////////////////////////
+#pragma region | events / hidden
+
+#define _OS_LOOP_CHUNK 64
+#define _OS_LOOP_BATCH 64
+
+variant os_loop
+{
+	#if OS_LINUX
+		int epoll;
+	#elif OS_WINDOWS
+		os_watch ref ref watches;
+		WSAPOLLFD ref polls;
+		os_watch ref ref polled;
+		n4 watch_capacity;
+		n4 watch_total;
+	#endif
+	os_watch ref ref chunks;
+	n4 chunk_count;
+	os_watch ref spare;
+	os_watch ref retired;
+	os_watch ref waker;
+	byte ref ref buffers;
+	n4 buffer_count;
+	n4 buffer_capacity;
+	n4 watch_count;
+	flag stopping;
+};
+
+#if OS_LINUX
+	#define _os_socket_close( SOCKET ) close( SOCKET )
+	#define _os_io_would_block() ( errno is EAGAIN or errno is EWOULDBLOCK or errno is EINPROGRESS )
+#elif OS_WINDOWS
+	#define _os_socket_close( SOCKET ) closesocket( SOCKET )
+	#define _os_io_would_block() ( WSAGetLastError() is WSAEWOULDBLOCK or WSAGetLastError() is WSAEINPROGRESS )
+#endif
+
+embed flag _os_socket_nonblocking( os_socket const handle )
+{
+	#if OS_LINUX
+		temp int const flags = fcntl( handle, F_GETFL, 0 );
+		out flags isnt -1 and fcntl( handle, F_SETFL, flags | O_NONBLOCK ) isnt -1;
+	#elif OS_WINDOWS
+		u_long on = 1;
+		out ioctlsocket( handle, FIONBIO, ref_of( on ) ) is 0;
+	#endif
+}
+
+embed flag _os_sockets_start()
+{
+	#if OS_WINDOWS
+		perm flag started = no;
+		if( not started )
+		{
+			WSADATA data;
+			started = WSAStartup( MAKEWORD( 2, 2 ), ref_of( data ) ) is 0;
+		}
+		out started;
+	#else
+		out yes;
+	#endif
+}
+
+embed os_watch ref _os_loop_new_watch( os_loop ref const event_loop, os_socket const handle, os_watch_kind const kind, os_watch_callback const callback, anon ref const context )
+{
+	if( event_loop->spare is nothing )
+	{
+		temp os_watch ref ref const chunks = os_resize_ref( event_loop->chunks, size_of( os_watch ref ) * ( event_loop->chunk_count + 1 ), yes );
+		out_if_nothing( chunks ) nothing;
+		event_loop->chunks = chunks;
+		temp os_watch ref const chunk = os_create_ref( os_watch, _OS_LOOP_CHUNK );
+		out_if_nothing( chunk ) nothing;
+		chunks[ event_loop->chunk_count++ ] = chunk;
+		iter( i, _OS_LOOP_CHUNK )
+		{
+			chunk[ i ].retired_after = event_loop->spare;
+			event_loop->spare = chunk + i;
+		}
+	}
+	temp os_watch ref const watch = event_loop->spare;
+	event_loop->spare = watch->retired_after;
+	bytes_clear( watch, size_of( os_watch ) );
+	watch->event_loop = event_loop;
+	watch->handle = handle;
+	watch->kind = kind;
+	watch->callback = callback;
+	watch->context = context;
+	watch->events = os_event_read;
+	watch->due_ns = n8_max_val;
+	watch->used = yes;
+	out watch;
+}
+
+// registers the watch with the OS, or frees it and closes HANDLE
+embed os_watch ref _os_loop_register( os_watch ref const watch )
+{
+	temp os_loop ref const event_loop = watch->event_loop;
+	temp flag registered = yes;
+	#if OS_LINUX
+		struct epoll_event event = { .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data.ptr = watch };
+		registered = epoll_ctl( event_loop->epoll, EPOLL_CTL_ADD, watch->handle, ref_of( event ) ) is 0;
+	#elif OS_WINDOWS
+		if( event_loop->watch_total is event_loop->watch_capacity )
+		{
+			temp n4 const capacity = pick( event_loop->watch_capacity, event_loop->watch_capacity * 2, 64 );
+			temp os_watch ref ref const watches = os_resize_ref( event_loop->watches, size_of( os_watch ref ) * capacity, yes );
+			if_something( watches ) event_loop->watches = watches;
+			// a poll entry for every watch, so no round leaves one out
+			temp WSAPOLLFD ref const polls = os_resize_ref( event_loop->polls, size_of( WSAPOLLFD ) * capacity, yes );
+			if_something( polls ) event_loop->polls = polls;
+			temp os_watch ref ref const polled = os_resize_ref( event_loop->polled, size_of( os_watch ref ) * capacity, yes );
+			if_something( polled ) event_loop->polled = polled;
+			registered = watches isnt nothing and polls isnt nothing and polled isnt nothing;
+			if( registered ) event_loop->watch_capacity = capacity;
+		}
+		if( registered ) event_loop->watches[ event_loop->watch_total++ ] = watch;
+	#endif
+	if( not registered )
+	{
+		if( watch->handle isnt os_socket_none ) _os_socket_close( watch->handle );
+		watch->used = no;
+		watch->retired_after = event_loop->spare;
+		event_loop->spare = watch;
+		out nothing;
+	}
+	if( watch isnt event_loop->waker ) ++event_loop->watch_count;
+	out watch;
+}
+
+// HOST is numeric ( "127.0.0.1", "::1" ) or a name; PORT 0 picks a free one, see `os_watch_port`
+embed os_socket _os_socket_open( byte const ref const host, n2 const port, flag const listening )
+{
+	out_if( not _os_sockets_start() ) os_socket_none;
+	byte service[ 8 ];
+	snprintf( service, size_of( service ), "%u", to( unsigned, port ) );
+	struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_flags = pick( listening, AI_PASSIVE, 0 ) };
+	struct addrinfo ref found = nothing;
+	out_if( getaddrinfo( host, service, ref_of( hints ), ref_of( found ) ) isnt 0 ) os_socket_none;
+	temp os_socket handle = socket( found->ai_family, found->ai_socktype, found->ai_protocol );
+	if( handle isnt os_socket_none )
+	{
+		int on = 1;
+		temp flag opened = _os_socket_nonblocking( handle );
+		if( opened and listening )
+		{
+			setsockopt( handle, SOL_SOCKET, SO_REUSEADDR, to( byte const ref, ref_of( on ) ), size_of( on ) );
+			opened = bind( handle, found->ai_addr, to( int, found->ai_addrlen ) ) is 0 and listen( handle, SOMAXCONN ) is 0;
+		}
+		else if( opened )
+		{
+			setsockopt( handle, IPPROTO_TCP, TCP_NODELAY, to( byte const ref, ref_of( on ) ), size_of( on ) );
+			opened = connect( handle, found->ai_addr, to( int, found->ai_addrlen ) ) is 0 or _os_io_would_block();
+		}
+		if( not opened )
+		{
+			_os_socket_close( handle );
+			handle = os_socket_none;
+		}
+	}
+	freeaddrinfo( found );
+	out handle;
+}
+
+#if OS_LINUX
+	embed os_socket _os_socket_open_unix( byte const ref const path, flag const listening )
+	{
+		struct sockaddr_un address = { .sun_family = AF_UNIX };
+		temp n8 const path_size = bytes_measure( path );
+		out_if( path_size >= size_of( address.sun_path ) ) os_socket_none;
+		bytes_copy( address.sun_path, path, path_size );
+		temp os_socket handle = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+		out_if( handle is -1 ) os_socket_none;
+		temp flag opened = no;
+		if( listening )
+		{
+			unlink( path );
+			opened = bind( handle, to( struct sockaddr ref, ref_of( address ) ), size_of( address ) ) is 0 and listen( handle, SOMAXCONN ) is 0;
+		}
+		else opened = connect( handle, to( struct sockaddr ref, ref_of( address ) ), size_of( address ) ) is 0 or _os_io_would_block();
+		if( not opened )
+		{
+			close( handle );
+			handle = os_socket_none;
+		}
+		out handle;
+	}
+#endif
+
+fn _os_loop_free_retired( os_loop ref const event_loop )
+{
+	while( event_loop->retired isnt nothing )
+	{
+		temp os_watch ref const watch = event_loop->retired;
+		event_loop->retired = watch->retired_after;
+		watch->used = no;
+		watch->retired_after = event_loop->spare;
+		event_loop->spare = watch;
+	}
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | events / visible
+
+// a buffer of H_LOOP_BUFFER bytes, reused once given back; nothing when memory runs out
+embed byte ref os_loop_buffer_take( os_loop ref const event_loop )
+{
+	out_if( event_loop->buffer_count ) event_loop->buffers[ --event_loop->buffer_count ];
+	out os_create_ref( byte, H_LOOP_BUFFER );
+}
+
+fn os_loop_buffer_give( os_loop ref const event_loop, byte ref const buffer )
+{
+	if( event_loop->buffer_count is event_loop->buffer_capacity )
+	{
+		temp n4 const capacity = pick( event_loop->buffer_capacity, event_loop->buffer_capacity * 2, 16 );
+		temp byte ref ref const buffers = os_resize_ref( event_loop->buffers, size_of( byte ref ) * capacity, yes );
+		if( buffers is nothing )
+		{
+			_free( buffer );
+			out;
+		}
+		event_loop->buffers = buffers;
+		event_loop->buffer_capacity = capacity;
+	}
+	event_loop->buffers[ event_loop->buffer_count++ ] = buffer;
+}
+
+// bytes read, 0 at the end of the stream, `os_io_again` once drained, or `os_io_error`
+embed i8 os_watch_read( os_watch ref const watch, anon ref const to_ref, n8 const capacity )
+{
+	loop
+	{
+		#if OS_LINUX
+			temp ssize_t const size = read( watch->handle, to_ref, capacity );
+		#elif OS_WINDOWS
+			temp int const size = recv( watch->handle, to_ref, to( int, pick( capacity < i4_max_val, capacity, i4_max_val ) ), 0 );
+		#endif
+		out_if( size >= 0 ) i8( size );
+		#if OS_LINUX
+			next_if( errno is EINTR );
+		#endif
+		out pick( _os_io_would_block(), os_io_again, os_io_error );
+	}
+}
+
+// bytes written, possibly fewer than SIZE, `os_io_again` when full, or `os_io_error`
+embed i8 os_watch_write( os_watch ref const watch, anon const ref const from_ref, n8 const size )
+{
+	loop
+	{
+		#if OS_LINUX
+			temp ssize_t written = send( watch->handle, from_ref, size, MSG_NOSIGNAL );
+			if( written < 0 and errno is ENOTSOCK ) written = write( watch->handle, from_ref, size );
+		#elif OS_WINDOWS
+			temp int const written = send( watch->handle, from_ref, to( int, pick( size < i4_max_val, size, i4_max_val ) ), 0 );
+		#endif
+		out_if( written >= 0 ) i8( written );
+		#if OS_LINUX
+			next_if( errno is EINTR );
+		#endif
+		out pick( _os_io_would_block(), os_io_again, os_io_error );
+	}
+}
+
+// closes the handle and stops the callbacks; the watch itself is reused after the current dispatch
+fn os_watch_close( os_watch ref const watch )
+{
+	out_if( watch->closed );
+	temp os_loop ref const event_loop = watch->event_loop;
+	watch->closed = yes;
+	#if OS_LINUX
+		epoll_ctl( event_loop->epoll, EPOLL_CTL_DEL, watch->handle, nothing );
+	#elif OS_WINDOWS
+		iter( i, event_loop->watch_total )
+		{
+			if( event_loop->watches[ i ] is watch )
+			{
+				event_loop->watches[ i ] = event_loop->watches[ --event_loop->watch_total ];
+				skip;
+			}
+		}
+	#endif
+	if( watch->handle isnt os_socket_none ) _os_socket_close( watch->handle );
+	watch->handle = os_socket_none;
+	if( watch isnt event_loop->waker ) --event_loop->watch_count;
+	watch->retired_after = event_loop->retired;
+	event_loop->retired = watch;
+}
+
+// which of `os_event_read` / `os_event_write` to be called for; the default is reads only
+fn os_watch_want( os_watch ref const watch, n4 const events )
+{
+	watch->events = events;
+}
+
+// the loop reads for the watch from now on, calling ON_DATA per buffer and with size 0 at the end
+fn os_watch_on_data( os_watch ref const watch, os_data_callback const on_data )
+{
+	watch->on_data = on_data;
+}
+
+fn os_watch_wake( os_watch ref const watch )
+{
+	#if OS_LINUX
+		n8 const one = 1;
+		temp ssize_t const written = write( watch->handle, ref_of( one ), size_of( n8 ) );
+		( anon )written;
+	#elif OS_WINDOWS
+		send( watch->handle, "", 1, 0 );
+	#endif
+}
+
+embed os_loop ref os_create_loop()
+{
+	out_if( not _os_sockets_start() ) nothing;
+	temp os_loop ref const event_loop = os_create_ref( os_loop );
+	out_if_nothing( event_loop ) nothing;
+	#if OS_LINUX
+		event_loop->epoll = epoll_create1( EPOLL_CLOEXEC );
+		temp os_socket const wake = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+	#elif OS_WINDOWS
+		temp os_socket wake = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+		struct sockaddr_in address = { .sin_family = AF_INET, .sin_addr.s_addr = htonl( INADDR_LOOPBACK ) };
+		int address_size = size_of( address );
+		if( wake isnt INVALID_SOCKET and ( bind( wake, to( struct sockaddr ref, ref_of( address ) ), address_size ) isnt 0 or getsockname( wake, to( struct sockaddr ref, ref_of( address ) ), ref_of( address_size ) ) isnt 0 or connect( wake, to( struct sockaddr ref, ref_of( address ) ), address_size ) isnt 0 or not _os_socket_nonblocking( wake ) ) )
+		{
+			closesocket( wake );
+			wake = INVALID_SOCKET;
+		}
+	#endif
+	if( OS_PICK( event_loop->epoll is -1, no ) or wake is os_socket_none )
+	{
+		if( wake isnt os_socket_none ) _os_socket_close( wake );
+		#if OS_LINUX
+			if( event_loop->epoll isnt -1 ) close( event_loop->epoll );
+		#endif
+		_free( event_loop );
+		out nothing;
+	}
+	event_loop->waker = _os_loop_new_watch( event_loop, wake, os_watch_wakeup, nothing, nothing );
+	if( event_loop->waker is nothing or _os_loop_register( event_loop->waker ) is nothing )
+	{
+		#if OS_LINUX
+			close( event_loop->epoll );
+		#endif
+		_free( event_loop );
+		out nothing;
+	}
+	out event_loop;
+}
+
+fn os_delete_loop( os_loop ref const event_loop )
+{
+	iter( c, event_loop->chunk_count )
+	{
+		iter( i, _OS_LOOP_CHUNK )
+		{
+			temp os_watch ref const watch = event_loop->chunks[ c ] + i;
+			if( watch->used and not watch->closed and watch->handle isnt os_socket_none ) _os_socket_close( watch->handle );
+		}
+		_free( event_loop->chunks[ c ] );
+	}
+	iter( b, event_loop->buffer_count ) _free( event_loop->buffers[ b ] );
+	os_delete_ref( event_loop->buffers );
+	os_delete_ref( event_loop->chunks );
+	#if OS_LINUX
+		close( event_loop->epoll );
+	#elif OS_WINDOWS
+		os_delete_ref( event_loop->watches );
+		os_delete_ref( event_loop->polls );
+		os_delete_ref( event_loop->polled );
+	#endif
+	_free( event_loop );
+}
+
+// a HANDLE of any kind the OS can poll: socket, pipe end, terminal, made non-blocking; the loop
+// owns it from here, so it is closed when adding fails too
+embed os_watch ref os_loop_add( os_loop ref const event_loop, os_socket const handle, os_watch_callback const callback, anon ref const context )
+{
+	out_if( handle is os_socket_none ) nothing;
+	temp os_watch ref const watch = pick( _os_socket_nonblocking( handle ), _os_loop_new_watch( event_loop, handle, os_watch_stream, callback, context ), nothing );
+	if( watch is nothing )
+	{
+		_os_socket_close( handle );
+		out nothing;
+	}
+	out _os_loop_register( watch );
+}
+
+// fires `os_event_timer` after DELAY_NS, then every PERIOD_NS unless that is 0
+embed os_watch ref os_loop_timer( os_loop ref const event_loop, n8 const delay_ns, n8 const period_ns, os_watch_callback const callback, anon ref const context )
+{
+	#if OS_LINUX
+		temp os_socket const handle = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+		out_if( handle is -1 ) nothing;
+		temp n8 const first = pick( delay_ns, delay_ns, 1 );
+		struct itimerspec const spec =
+		{
+			.it_interval = { .tv_sec = to( time_t, period_ns / 1000000000ull ), .tv_nsec = to( long, period_ns mod 1000000000ull ) },
+			.it_value = { .tv_sec = to( time_t, first / 1000000000ull ), .tv_nsec = to( long, first mod 1000000000ull ) }
+		};
+		if( timerfd_settime( handle, 0, ref_of( spec ), nothing ) isnt 0 )
+		{
+			close( handle );
+			out nothing;
+		}
+	#elif OS_WINDOWS
+		temp os_socket const handle = os_socket_none;
+	#endif
+	temp os_watch ref const watch = _os_loop_new_watch( event_loop, handle, os_watch_timer, callback, context );
+	if( watch is nothing )
+	{
+		if( handle isnt os_socket_none ) _os_socket_close( handle );
+		out nothing;
+	}
+	watch->due_ns = os_time_ns() + delay_ns;
+	watch->period_ns = period_ns;
+	out _os_loop_register( watch );
+}
+
+// a watch any thread can `os_watch_wake`; wakes coalesce into one `os_event_wake` call
+embed os_watch ref os_loop_wakeup( os_loop ref const event_loop, os_watch_callback const callback, anon ref const context )
+{
+	#if OS_LINUX
+		temp os_socket const handle = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+	#elif OS_WINDOWS
+		temp os_socket handle = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+		struct sockaddr_in address = { .sin_family = AF_INET, .sin_addr.s_addr = htonl( INADDR_LOOPBACK ) };
+		int address_size = size_of( address );
+		if( handle isnt INVALID_SOCKET and ( bind( handle, to( struct sockaddr ref, ref_of( address ) ), address_size ) isnt 0 or getsockname( handle, to( struct sockaddr ref, ref_of( address ) ), ref_of( address_size ) ) isnt 0 or connect( handle, to( struct sockaddr ref, ref_of( address ) ), address_size ) isnt 0 ) )
+		{
+			closesocket( handle );
+			handle = INVALID_SOCKET;
+		}
+	#endif
+	out_if( handle is os_socket_none ) nothing;
+	temp os_watch ref const watch = pick( _os_socket_nonblocking( handle ), _os_loop_new_watch( event_loop, handle, os_watch_wakeup, callback, context ), nothing );
+	if( watch is nothing )
+	{
+		_os_socket_close( handle );
+		out nothing;
+	}
+	out _os_loop_register( watch );
+}
+
+// stops `os_loop_run` from any thread
+fn os_loop_stop( os_loop ref const event_loop )
+{
+	atomic_store( ref_of( event_loop->stopping ), yes );
+	os_watch_wake( event_loop->waker );
+}
+
+// a TCP listener; calls back with `os_event_read` while connections wait for `os_watch_accept`
+embed os_watch ref os_loop_listen( os_loop ref const event_loop, byte const ref const host, n2 const port, os_watch_callback const callback, anon ref const context )
+{
+	temp os_socket const handle = _os_socket_open( host, port, yes );
+	out_if( handle is os_socket_none ) nothing;
+	temp os_watch ref const watch = _os_loop_new_watch( event_loop, handle, os_watch_listener, callback, context );
+	if( watch is nothing )
+	{
+		_os_socket_close( handle );
+		out nothing;
+	}
+	out _os_loop_register( watch );
+}
+
+// a TCP connection in progress: `os_event_write` once connected, `os_event_close` if refused
+embed os_watch ref os_loop_connect( os_loop ref const event_loop, byte const ref const host, n2 const port, os_watch_callback const callback, anon ref const context )
+{
+	temp os_socket const handle = _os_socket_open( host, port, no );
+	out_if( handle is os_socket_none ) nothing;
+	temp os_watch ref const watch = _os_loop_new_watch( event_loop, handle, os_watch_stream, callback, context );
+	if( watch is nothing )
+	{
+		_os_socket_close( handle );
+		out nothing;
+	}
+	watch->events = os_event_read | os_event_write;
+	out _os_loop_register( watch );
+}
+
+// the next waiting connection as a new watch, or nothing when there is none
+embed os_watch ref os_watch_accept( os_watch ref const listener, os_watch_callback const callback, anon ref const context )
+{
+	temp os_socket const handle = accept( listener->handle, nothing, nothing );
+	out_if( handle is os_socket_none ) nothing;
+	int on = 1;
+	setsockopt( handle, IPPROTO_TCP, TCP_NODELAY, to( byte const ref, ref_of( on ) ), size_of( on ) );
+	out os_loop_add( listener->event_loop, handle, callback, context );
+}
+
+// the local port of a socket watch
+embed n2 os_watch_port( os_watch const ref const watch )
+{
+	struct sockaddr_storage address;
+	socklen_t address_size = size_of( address );
+	out_if( getsockname( watch->handle, to( struct sockaddr ref, ref_of( address ) ), ref_of( address_size ) ) isnt 0 ) 0;
+	out_if( address.ss_family is AF_INET ) ntohs( ( to( struct sockaddr_in ref, ref_of( address ) ) )->sin_port );
+	out ntohs( ( to( struct sockaddr_in6 ref, ref_of( address ) ) )->sin6_port );
+}
+
+#if OS_LINUX
+	// a Unix domain listener at PATH, replacing any stale socket file there
+	embed os_watch ref os_loop_listen_unix( os_loop ref const event_loop, byte const ref const path, os_watch_callback const callback, anon ref const context )
+	{
+		temp os_socket const handle = _os_socket_open_unix( path, yes );
+		out_if( handle is os_socket_none ) nothing;
+		temp os_watch ref const watch = _os_loop_new_watch( event_loop, handle, os_watch_listener, callback, context );
+		if( watch is nothing )
+		{
+			close( handle );
+			out nothing;
+		}
+		out _os_loop_register( watch );
+	}
+
+	embed os_watch ref os_loop_connect_unix( os_loop ref const event_loop, byte const ref const path, os_watch_callback const callback, anon ref const context )
+	{
+		temp os_socket const handle = _os_socket_open_unix( path, no );
+		out_if( handle is os_socket_none ) nothing;
+		temp os_watch ref const watch = _os_loop_new_watch( event_loop, handle, os_watch_stream, callback, context );
+		if( watch is nothing )
+		{
+			close( handle );
+			out nothing;
+		}
+		watch->events = os_event_read | os_event_write;
+		out _os_loop_register( watch );
+	}
+#endif
+
+// two connected stream sockets, for `os_loop_add`
+embed flag os_create_socket_pair( os_socket pair[ 2 ] )
+{
+	#if OS_LINUX
+		out socketpair( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair ) is 0;
+	#elif OS_WINDOWS
+		pair[ 0 ] = pair[ 1 ] = INVALID_SOCKET;
+		temp os_socket const listener = _os_socket_open( "127.0.0.1", 0, yes );
+		out_if( listener is INVALID_SOCKET ) no;
+		struct sockaddr_in address;
+		int address_size = size_of( address );
+		getsockname( listener, to( struct sockaddr ref, ref_of( address ) ), ref_of( address_size ) );
+		pair[ 0 ] = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+		connect( pair[ 0 ], to( struct sockaddr ref, ref_of( address ) ), address_size );
+		WSAPOLLFD poll = { .fd = listener, .events = POLLRDNORM };
+		if( WSAPoll( ref_of( poll ), 1, 5000 ) is 1 ) pair[ 1 ] = accept( listener, nothing, nothing );
+		closesocket( listener );
+		if( pair[ 1 ] is INVALID_SOCKET )
+		{
+			closesocket( pair[ 0 ] );
+			pair[ 0 ] = INVALID_SOCKET;
+			out no;
+		}
+		u_long off = 0;
+		ioctlsocket( pair[ 1 ], FIONBIO, ref_of( off ) );
+		out yes;
+	#endif
+}
+
+// PAIR[ 0 ] reads what PAIR[ 1 ] writes; a socket pair on Windows, where pipes can't be polled
+embed flag os_create_pipe( os_socket pair[ 2 ] )
+{
+	#if OS_LINUX
+		out pipe2( pair, O_CLOEXEC ) is 0;
+	#elif OS_WINDOWS
+		out os_create_socket_pair( pair );
+	#endif
+}
+
+fn _os_watch_dispatch( os_watch ref const watch, n4 events )
+{
+	if( watch->kind is os_watch_timer )
+	{
+		#if OS_LINUX
+			n8 expirations;
+			temp ssize_t const size = read( watch->handle, ref_of( expirations ), size_of( n8 ) );
+			out_if( size isnt size_of( n8 ) );
+		#endif
+		call( watch->callback, watch, os_event_timer );
+		out;
+	}
+	if( watch->kind is os_watch_wakeup )
+	{
+		// only a drained wake calls back, not the other edges the handle reports
+		n8 drained[ 8 ];
+		#if OS_LINUX
+			temp ssize_t const size = read( watch->handle, drained, size_of( n8 ) );
+			out_if( size isnt size_of( n8 ) );
+		#elif OS_WINDOWS
+			temp flag woken = no;
+			while( recv( watch->handle, to( byte ref, drained ), size_of( drained ), 0 ) > 0 ) woken = yes;
+			out_if( not woken );
+		#endif
+		call( watch->callback, watch, os_event_wake );
+		out;
+	}
+	if( watch->on_data isnt nothing and events & ( os_event_read | os_event_close ) )
+	{
+		temp byte ref const buffer = os_loop_buffer_take( watch->event_loop );
+		if( buffer isnt nothing )
+		{
+			loop
+			{
+				temp i8 const size = os_watch_read( watch, buffer, H_LOOP_BUFFER );
+				skip_if( size is os_io_again );
+				watch->on_data( watch, buffer, pick( size > 0, n8( size ), 0 ) );
+				skip_if( size <= 0 or watch->closed );
+			}
+			os_loop_buffer_give( watch->event_loop, buffer );
+			events &= ~n4( os_event_read );
+		}
+		else
+		{
+			// out of memory: the data stays pending and the read bit goes to the callback; epoll only
+			// reports an edge once, so re-arming has it report the unread data again next round
+			#if OS_LINUX
+				struct epoll_event event = { .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data.ptr = watch };
+				epoll_ctl( watch->event_loop->epoll, EPOLL_CTL_MOD, watch->handle, ref_of( event ) );
+			#endif
+		}
+		out_if( watch->closed );
+	}
+	events &= watch->events | os_event_close;
+	if( events ) call( watch->callback, watch, events );
+}
+
+// waits up to TIMEOUT_MS ( -1: no limit ) and dispatches what is ready; gives how many watches ran
+embed n4 os_loop_run_once( os_loop ref const event_loop, i4 const timeout_ms )
+{
+	temp n4 ran = 0;
+	#if OS_LINUX
+		struct epoll_event events[ _OS_LOOP_BATCH ];
+		temp int const count = epoll_wait( event_loop->epoll, events, _OS_LOOP_BATCH, timeout_ms );
+		iter( i, pick( count > 0, count, 0 ) )
+		{
+			temp os_watch ref const watch = events[ i ].data.ptr;
+			next_if( watch->closed );
+			temp n4 const bits = events[ i ].events;
+			temp n4 const ready = pick( bits & EPOLLIN, os_event_read, 0 ) | pick( bits & EPOLLOUT, os_event_write, 0 ) | pick( bits & ( EPOLLHUP | EPOLLERR | EPOLLRDHUP ), os_event_close, 0 );
+			_os_watch_dispatch( watch, ready );
+			++ran;
+		}
+	#elif OS_WINDOWS
+		temp n4 const total = event_loop->watch_total;
+		temp n8 const now = os_time_ns();
+		temp n8 due = n8_max_val;
+		temp n4 poll_count = 0;
+		iter( i, total )
+		{
+			temp os_watch ref const watch = event_loop->watches[ i ];
+			if( watch->kind is os_watch_timer ) due = pick( watch->due_ns < due, watch->due_ns, due );
+			else
+			{
+				event_loop->polls[ poll_count ] = make( WSAPOLLFD, .fd = watch->handle, .events = to( SHORT, POLLRDNORM | pick( watch->events & os_event_write, POLLWRNORM, 0 ) ) );
+				event_loop->polled[ poll_count++ ] = watch;
+			}
+		}
+		temp i8 wait = timeout_ms;
+		if( due isnt n8_max_val )
+		{
+			temp i8 const until_due = pick( due > now, i8( ( due - now + 999999 ) / 1000000 ), 0 );
+			if( wait < 0 or until_due < wait ) wait = until_due;
+		}
+		temp int const count = pick( poll_count, WSAPoll( event_loop->polls, poll_count, to( INT, wait ) ), ( Sleep( to( DWORD, pick( wait < 0, INFINITE, wait ) ) ), 0 ) );
+		// callbacks may add watches, which can move `polls` and `polled`, so index them afresh each time
+		iter( i, pick( count > 0, poll_count, 0 ) )
+		{
+			temp os_watch ref const watch = event_loop->polled[ i ];
+			temp SHORT const bits = event_loop->polls[ i ].revents;
+			next_if( bits is 0 or watch->closed );
+			temp n4 const ready = pick( bits & ( POLLRDNORM | POLLHUP ), os_event_read, 0 ) | pick( bits & POLLWRNORM, os_event_write, 0 ) | pick( bits & ( POLLHUP | POLLERR ), os_event_close, 0 );
+			_os_watch_dispatch( watch, ready );
+			++ran;
+		}
+		// the due timers are gathered first, since closing a watch moves another into its place in `watches`
+		temp n8 const later = os_time_ns();
+		temp n4 due_count = 0;
+		iter( i, event_loop->watch_total )
+		{
+			temp os_watch ref const watch = event_loop->watches[ i ];
+			if( watch->kind is os_watch_timer and watch->due_ns <= later ) event_loop->polled[ due_count++ ] = watch;
+		}
+		iter( i, due_count )
+		{
+			temp os_watch ref const watch = event_loop->polled[ i ];
+			next_if( watch->closed );
+			watch->due_ns = pick( watch->period_ns, watch->due_ns + watch->period_ns, n8_max_val );
+			_os_watch_dispatch( watch, os_event_timer );
+			++ran;
+		}
+	#endif
+	_os_loop_free_retired( event_loop );
+	out ran;
+}
+
+// dispatches until `os_loop_stop` or until no watches are left
+fn os_loop_run( os_loop ref const event_loop )
+{
+	while( event_loop->watch_count and not atomic_load( ref_of( event_loop->stopping ) ) ) os_loop_run_once( event_loop, -1 );
+	atomic_store( ref_of( event_loop->stopping ), no );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion events
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - channel
+
+// `os_create_channel` maps a ring into shared memory (a memfd on Linux, a named file mapping on Windows)
+// for one producer and one consumer, which can live in different processes
+// hand `os_channel_name` to the other process, e.g. on the command line of a `command_read_open`,
+// and it calls `os_open_channel` with it; on Linux the name is a /proc path to the creator's memfd,
+// so it stays valid while the creator keeps the channel
+// messages are written in place with `os_channel_reserve` / `os_channel_commit` and read in place
+// with `os_channel_receive` / `os_channel_release`; a side only sleeps (futex or named event) when
+// the ring is full or empty, and the peer only pays for a wakeup when that side is asleep
+// each end is either the producer or the consumer; for both directions, make two channels
+
+#ifndef H_CHANNEL_SPIN
+	#define H_CHANNEL_SPIN 256
+#endif
+
+type_from( variant os_channel ) os_channel;
+
+////////////////////////////////
+#pragma region | channel / hidden
+
+#define _OS_CHANNEL_MAGIC 0x314e4843
+#define _OS_CHANNEL_HEADER 4096
+#define _OS_CHANNEL_PAD n4_max_val
+#define _OS_CHANNEL_NAP_MS 100
+#define _os_channel_span( SIZE ) ( 8 + ( ( n8( SIZE ) + 7 ) & ~n8( 7 ) ) )
+
+type_from( variant _os_channel_shared ) _os_channel_shared;
+
+// positions only grow; the producer owns `head`, the consumer owns `tail`
+variant _os_channel_shared
+{
+	n4 magic;
+	n4 capacity;
+	n4 closed;
+	cache_align n8 head;
+	n4 reader_waiting;
+	cache_align n8 tail;
+	n4 writer_waiting;
+};
+
+variant os_channel
+{
+	_os_channel_shared ref shared;
+	byte ref ring;
+	n8 mask;
+	n8 map_size;
+	n8 seen;
+	n8 pending;
+	n8 pending_pad;
+	n8 held;
+	#if OS_LINUX
+		int fd;
+	#elif OS_WINDOWS
+		HANDLE mapping;
+		HANDLE data_event;
+		HANDLE room_event;
+	#endif
+	n4 name_size;
+	byte name[ 64 ];
+};
+
+embed os_channel ref _os_channel_attach( os_channel ref const channel, anon ref const mapped, n8 const map_size )
+{
+	channel->shared = to( _os_channel_shared ref, mapped );
+	channel->ring = to( byte ref, mapped ) + _OS_CHANNEL_HEADER;
+	channel->map_size = map_size;
+	channel->mask = channel->shared->capacity - 1;
+	out channel;
+}
+
+#if OS_WINDOWS
+	embed HANDLE _os_channel_event( byte const ref const name, byte const ref const suffix, flag const create )
+	{
+		byte event_name[ 80 ];
+		snprintf( event_name, size_of( event_name ), "%s-%s", name, suffix );
+		out pick( create, CreateEventA( nothing, FALSE, FALSE, event_name ), OpenEventA( EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, event_name ) );
+	}
+#endif
+
+// sleeps until woken while `waiting` is still set, or for a short nap so a vanished peer is noticed
+fn _os_channel_sleep( os_channel ref const channel, n4 ref const waiting, flag const reader )
+{
+	#if OS_LINUX
+		struct timespec nap = { 0, _OS_CHANNEL_NAP_MS * 1000000 };
+		syscall( SYS_futex, waiting, FUTEX_WAIT, 1, ref_of( nap ), nothing, 0 );
+		( anon )channel;
+		( anon )reader;
+	#elif OS_WINDOWS
+		WaitForSingleObject( pick( reader, channel->data_event, channel->room_event ), _OS_CHANNEL_NAP_MS );
+		( anon )waiting;
+	#endif
+}
+
+fn _os_channel_wake( os_channel ref const channel, n4 ref const waiting, flag const reader )
+{
+	atomic_fence();
+	out_if( not atomic_load_relaxed( waiting ) or not atomic_swap( waiting, 0 ) );
+	#if OS_LINUX
+		syscall( SYS_futex, waiting, FUTEX_WAKE, 1, nothing, nothing, 0 );
+		( anon )channel;
+		( anon )reader;
+	#elif OS_WINDOWS
+		SetEvent( pick( reader, channel->data_event, channel->room_event ) );
+	#endif
+}
+
+// spins briefly, then announces `waiting` and sleeps until `ready` holds or the peer closes
+#define _os_channel_wait( CHANNEL, WAITING, READER, READY, BLOCK, CLOSED_RESULT )\
+	START_DEF\
+	{\
+		temp n4 _spins = 0;\
+		while( not( READY ) )\
+		{\
+			out_if( not( BLOCK ) ) nothing;\
+			if( _spins < H_CHANNEL_SPIN )\
+			{\
+				++_spins;\
+				atomic_pause();\
+				next;\
+			}\
+			atomic_store_relaxed( WAITING, 1 );\
+			atomic_fence();\
+			if( READY )\
+			{\
+				atomic_store_relaxed( WAITING, 0 );\
+				skip;\
+			}\
+			if( atomic_load( ref_of( ( CHANNEL )->shared->closed ) ) )\
+			{\
+				atomic_store_relaxed( WAITING, 0 );\
+				out CLOSED_RESULT;\
+			}\
+			_os_channel_sleep( CHANNEL, WAITING, READER );\
+		}\
+	}\
+	END_DEF
+
+embed byte ref _os_channel_reserve( os_channel ref const channel, n8 const size, flag const block )
+{
+	temp _os_channel_shared ref const shared = channel->shared;
+	temp n8 const capacity = channel->mask + 1;
+	temp n8 const span = _os_channel_span( size );
+	out_if( span > capacity / 2 or atomic_load( ref_of( shared->closed ) ) ) nothing;
+	temp n8 const head = atomic_load_relaxed( ref_of( shared->head ) );
+	temp n8 const offset = head & channel->mask;
+	temp n8 const pad = pick( offset + span > capacity, capacity - offset, 0 );
+	temp n8 const end = head + pad + span;
+	if( end - channel->seen > capacity )
+	{
+		_os_channel_wait( channel, ref_of( shared->writer_waiting ), no, end - ( channel->seen = atomic_load( ref_of( shared->tail ) ) ) <= capacity, block, nothing );
+	}
+	channel->pending = span;
+	channel->pending_pad = pad;
+	out channel->ring + ( ( head + pad ) & channel->mask ) + 8;
+}
+
+embed byte const ref _os_channel_receive( os_channel ref const channel, n8 ref const size, flag const block )
+{
+	temp _os_channel_shared ref const shared = channel->shared;
+	loop
+	{
+		temp n8 const tail = atomic_load_relaxed( ref_of( shared->tail ) );
+		if( channel->seen is tail )
+		{
+			_os_channel_wait( channel, ref_of( shared->reader_waiting ), yes, ( channel->seen = atomic_load( ref_of( shared->head ) ) ) isnt tail, block, nothing );
+		}
+		temp byte ref const message = channel->ring + ( tail & channel->mask );
+		temp n4 const length = val_of( to( n4 ref, message ) );
+		if( length is _OS_CHANNEL_PAD )
+		{
+			atomic_store( ref_of( shared->tail ), tail + channel->mask + 1 - ( tail & channel->mask ) );
+			next;
+		}
+		channel->held = _os_channel_span( length );
+		val_of( size ) = length;
+		out message + 8;
+	}
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | channel / visible
+
+// `capacity` is rounded up to a power of two of at least 4 KiB; a message may take up to half of it
+embed os_channel ref os_create_channel( n8 const capacity )
+{
+	temp n8 ring_size = 4096;
+	while( ring_size < capacity and ring_size < ( n8( 1 ) << 31 ) ) ring_size <<= 1;
+	temp n8 const map_size = _OS_CHANNEL_HEADER + ring_size;
+	temp os_channel ref const channel = os_create_ref( os_channel );
+	out_if_nothing( channel ) nothing;
+	anon ref mapped = nothing;
+	#if OS_LINUX
+		channel->fd = memfd_create( "H channel", MFD_CLOEXEC );
+		if( channel->fd isnt -1 and ftruncate( channel->fd, to( off_t, map_size ) ) is 0 )
+		{
+			mapped = mmap( nothing, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, channel->fd, 0 );
+			if( mapped is MAP_FAILED ) mapped = nothing;
+		}
+		channel->name_size = to( n4, snprintf( channel->name, size_of( channel->name ), "/proc/%d/fd/%d", to( int, getpid() ), channel->fd ) );
+		if_nothing( mapped )
+		{
+			if( channel->fd isnt -1 ) close( channel->fd );
+			_free( channel );
+			out nothing;
+		}
+	#elif OS_WINDOWS
+		perm n4 made = 0;
+		channel->name_size = to( n4, snprintf( channel->name, size_of( channel->name ), "Local\\H-channel-%lu-%u", GetCurrentProcessId(), to( unsigned, atomic_add( ref_of( made ), 1 ) ) ) );
+		channel->mapping = CreateFileMappingA( INVALID_HANDLE_VALUE, nothing, PAGE_READWRITE, to( DWORD, map_size >> 32 ), to( DWORD, map_size ), channel->name );
+		channel->data_event = _os_channel_event( channel->name, "data", yes );
+		channel->room_event = _os_channel_event( channel->name, "room", yes );
+		if( channel->mapping ) mapped = MapViewOfFile( channel->mapping, FILE_MAP_ALL_ACCESS, 0, 0, map_size );
+		if( mapped is nothing or channel->data_event is nothing or channel->room_event is nothing )
+		{
+			if( mapped ) UnmapViewOfFile( mapped );
+			if( channel->mapping ) CloseHandle( channel->mapping );
+			if( channel->data_event ) CloseHandle( channel->data_event );
+			if( channel->room_event ) CloseHandle( channel->room_event );
+			_free( channel );
+			out nothing;
+		}
+	#endif
+	temp _os_channel_shared ref const shared = to( _os_channel_shared ref, mapped );
+	shared->capacity = to( n4, ring_size );
+	atomic_store( ref_of( shared->magic ), _OS_CHANNEL_MAGIC );
+	out _os_channel_attach( channel, mapped, map_size );
+}
+
+// opens the other end of a channel from its `os_channel_name`
+embed os_channel ref os_open_channel( byte const ref const name )
+{
+	temp n8 const name_size = bytes_measure( name );
+	out_if( name_size >= 64 ) nothing;
+	temp os_channel ref const channel = os_create_ref( os_channel );
+	out_if_nothing( channel ) nothing;
+	channel->name_size = to( n4, name_size );
+	bytes_copy( channel->name, name, name_size );
+	anon ref mapped = nothing;
+	n8 map_size = 0;
+	#if OS_LINUX
+		channel->fd = open( name, O_RDWR | O_CLOEXEC );
+		struct stat st;
+		if( channel->fd isnt -1 and fstat( channel->fd, ref_of( st ) ) is 0 and to( n8, st.st_size ) > _OS_CHANNEL_HEADER )
+		{
+			map_size = to( n8, st.st_size );
+			mapped = mmap( nothing, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, channel->fd, 0 );
+			if( mapped is MAP_FAILED ) mapped = nothing;
+		}
+		if( mapped and atomic_load( ref_of( ( to( _os_channel_shared ref, mapped ) )->magic ) ) isnt _OS_CHANNEL_MAGIC )
+		{
+			munmap( mapped, map_size );
+			mapped = nothing;
+		}
+		if_nothing( mapped )
+		{
+			if( channel->fd isnt -1 ) close( channel->fd );
+			_free( channel );
+			out nothing;
+		}
+	#elif OS_WINDOWS
+		channel->mapping = OpenFileMappingA( FILE_MAP_ALL_ACCESS, FALSE, name );
+		channel->data_event = _os_channel_event( name, "data", no );
+		channel->room_event = _os_channel_event( name, "room", no );
+		if( channel->mapping ) mapped = MapViewOfFile( channel->mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0 );
+		MEMORY_BASIC_INFORMATION info;
+		if( mapped and VirtualQuery( mapped, ref_of( info ), size_of( info ) ) ) map_size = info.RegionSize;
+		if( mapped and ( map_size <= _OS_CHANNEL_HEADER or atomic_load( ref_of( ( to( _os_channel_shared ref, mapped ) )->magic ) ) isnt _OS_CHANNEL_MAGIC ) )
+		{
+			UnmapViewOfFile( mapped );
+			mapped = nothing;
+		}
+		if( mapped is nothing or channel->data_event is nothing or channel->room_event is nothing )
+		{
+			if( mapped ) UnmapViewOfFile( mapped );
+			if( channel->mapping ) CloseHandle( channel->mapping );
+			if( channel->data_event ) CloseHandle( channel->data_event );
+			if( channel->room_event ) CloseHandle( channel->room_event );
+			_free( channel );
+			out nothing;
+		}
+	#endif
+	out _os_channel_attach( channel, mapped, map_size );
+}
+
+// marks the channel closed for the peer, which still drains what was already sent
+fn os_delete_channel( os_channel ref const channel )
+{
+	out_if_nothing( channel );
+	temp _os_channel_shared ref const shared = channel->shared;
+	atomic_store( ref_of( shared->closed ), 1 );
+	_os_channel_wake( channel, ref_of( shared->reader_waiting ), yes );
+	_os_channel_wake( channel, ref_of( shared->writer_waiting ), no );
+	#if OS_LINUX
+		munmap( shared, channel->map_size );
+		close( channel->fd );
+	#elif OS_WINDOWS
+		UnmapViewOfFile( shared );
+		CloseHandle( channel->mapping );
+		CloseHandle( channel->data_event );
+		CloseHandle( channel->room_event );
+	#endif
+	_free( channel );
+}
+
+#define os_channel_name( CHANNEL ) ( ( CHANNEL )->name )
+#define os_channel_max_message( CHANNEL ) ( ( ( CHANNEL )->mask + 1 ) / 2 - 8 )
+#define os_channel_closed( CHANNEL ) ( atomic_load( ref_of( ( CHANNEL )->shared->closed ) ) isnt 0 )
+
+// producer: room for a `size` message written in place, 8-byte aligned; blocks while the ring is full
+// nothing if the message is too large or the channel was closed
+#define os_channel_reserve( CHANNEL, SIZE ) _os_channel_reserve( CHANNEL, SIZE, yes )
+#define os_channel_try_reserve( CHANNEL, SIZE ) _os_channel_reserve( CHANNEL, SIZE, no )
+
+// producer: publishes the reserved message, trimmed to `size` if fewer bytes were written;
+// `size` must be at most the reserved size: no, with nothing published, when there is no
+// reservation or `size` outgrows it
+embed flag os_channel_commit( os_channel ref const channel, n8 const size )
+{
+	temp _os_channel_shared ref const shared = channel->shared;
+	temp n8 const head = atomic_load_relaxed( ref_of( shared->head ) );
+	temp n8 const span = _os_channel_span( size );
+	out_if( channel->pending is 0 or span > channel->pending ) no;
+	if( channel->pending_pad ) val_of( to( n4 ref, channel->ring + ( head & channel->mask ) ) ) = _OS_CHANNEL_PAD;
+	val_of( to( n4 ref, channel->ring + ( ( head + channel->pending_pad ) & channel->mask ) ) ) = to( n4, size );
+	atomic_store( ref_of( shared->head ), head + channel->pending_pad + span );
+	channel->pending = 0;
+	_os_channel_wake( channel, ref_of( shared->reader_waiting ), yes );
+	out yes;
+}
+
+embed flag os_channel_send( os_channel ref const channel, anon const ref const bytes, n8 const size )
+{
+	temp byte ref const message = os_channel_reserve( channel, size );
+	out_if_nothing( message ) no;
+	bytes_copy( message, bytes, size );
+	out os_channel_commit( channel, size );
+}
+
+// consumer: the next message in place, valid until `os_channel_release`; blocks while the ring is empty
+// nothing once the ring is empty and the producer has closed
+#define os_channel_receive( CHANNEL, SIZE_REF ) _os_channel_receive( CHANNEL, SIZE_REF, yes )
+#define os_channel_poll( CHANNEL, SIZE_REF ) _os_channel_receive( CHANNEL, SIZE_REF, no )
+
+fn os_channel_release( os_channel ref const channel )
+{
+	out_if( channel->held is 0 );
+	temp _os_channel_shared ref const shared = channel->shared;
+	atomic_store( ref_of( shared->tail ), atomic_load_relaxed( ref_of( shared->tail ) ) + channel->held );
+	channel->held = 0;
+	_os_channel_wake( channel, ref_of( shared->writer_waiting ), no );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion channel
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - thread
+
+#if OS_LINUX
+	type_from( pthread_t ) os_thread;
+	type_from( pthread_mutex_t ) os_lock;
+	type_from( pthread_cond_t ) os_signal;
+	#define os_lock_init( LOCK_REF ) pthread_mutex_init( LOCK_REF, nothing )
+	#define os_lock_enter( LOCK_REF ) pthread_mutex_lock( LOCK_REF )
+	#define os_lock_leave( LOCK_REF ) pthread_mutex_unlock( LOCK_REF )
+	#define os_signal_init( SIGNAL_REF ) pthread_cond_init( SIGNAL_REF, nothing )
+	#define os_signal_wait( SIGNAL_REF, LOCK_REF ) pthread_cond_wait( SIGNAL_REF, LOCK_REF )
+	#define os_signal_one( SIGNAL_REF ) pthread_cond_signal( SIGNAL_REF )
+	#define os_signal_all( SIGNAL_REF ) pthread_cond_broadcast( SIGNAL_REF )
+#elif OS_WINDOWS
+	type_from( HANDLE ) os_thread;
+	type_from( SRWLOCK ) os_lock;
+	type_from( CONDITION_VARIABLE ) os_signal;
+	#define os_lock_init( LOCK_REF ) InitializeSRWLock( LOCK_REF )
+	#define os_lock_enter( LOCK_REF ) AcquireSRWLockExclusive( LOCK_REF )
+	#define os_lock_leave( LOCK_REF ) ReleaseSRWLockExclusive( LOCK_REF )
+	#define os_signal_init( SIGNAL_REF ) InitializeConditionVariable( SIGNAL_REF )
+	#define os_signal_wait( SIGNAL_REF, LOCK_REF ) SleepConditionVariableSRW( SIGNAL_REF, LOCK_REF, INFINITE, 0 )
+	#define os_signal_one( SIGNAL_REF ) WakeConditionVariable( SIGNAL_REF )
+	#define os_signal_all( SIGNAL_REF ) WakeAllConditionVariable( SIGNAL_REF )
+#endif
+
+type_fn(, anon ref const, n8 const ) os_job;
+
+embed n4 os_cpu_count()
+{
+	perm n4 count = 0;
+	if( count is 0 )
+	{
+		#if OS_LINUX
+			temp long const online = sysconf( _SC_NPROCESSORS_ONLN );
+			count = pick( online > 0, to( n4, online ), 1 );
+		#elif OS_WINDOWS
+			SYSTEM_INFO info;
+			GetSystemInfo( ref_of( info ) );
+			count = pick( info.dwNumberOfProcessors > 0, info.dwNumberOfProcessors, 1 );
+		#endif
+	}
+	out count;
+}
+
+////////////////////////////////
+#pragma region | thread / hidden
+
+type_from( variant _os_thread_start ) _os_thread_start;
+variant _os_thread_start
+{
+	os_job job;
+	anon ref context;
+	n8 index;
+};
+
+#if OS_LINUX
+	perm anon ref _os_thread_entry( anon ref const start_ref )
+#elif OS_WINDOWS
+	perm DWORD WINAPI _os_thread_entry( anon ref const start_ref )
+#endif
+{
+	temp _os_thread_start const launch = val_of( to( _os_thread_start ref, start_ref ) );
+	_free( start_ref );
+	launch.job( launch.context, launch.index );
+	out 0;
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | thread / visible
+
+// runs `job( context, index )` on a new thread
+embed flag os_create_thread( os_thread ref const thread, os_job const job, anon ref const context, n8 const index )
+{
+	temp _os_thread_start ref const launch = os_create_ref( _os_thread_start );
+	out_if_nothing( launch ) no;
+	launch->job = job;
+	launch->context = context;
+	launch->index = index;
+	#if OS_LINUX
+		out_if( pthread_create( thread, nothing, _os_thread_entry, launch ) is 0 ) yes;
+	#elif OS_WINDOWS
+		val_of( thread ) = CreateThread( nothing, 0, _os_thread_entry, launch, 0, nothing );
+		out_if_something( val_of( thread ) ) yes;
+	#endif
+	_free( launch );
+	out no;
+}
+
+fn os_join_thread( os_thread const thread )
+{
+	#if OS_LINUX
+		pthread_join( thread, nothing );
+	#elif OS_WINDOWS
+		WaitForSingleObject( thread, INFINITE );
+		CloseHandle( thread );
+	#endif
+}
+
+// lets the thread run on without ever being joined
+fn os_detach_thread( os_thread const thread )
+{
+	#if OS_LINUX
+		pthread_detach( thread );
+	#elif OS_WINDOWS
+		CloseHandle( thread );
+	#endif
+}
+
+#pragma endregion visible
+///
+
+////////////////////////////////
+#pragma region | jobs / hidden
+
+// one pool of os_cpu_count() - 1 sleeping threads; a batch lives on the caller's stack, and the caller
+// works on it too, then unpublishes it and waits until every worker that joined has left
+type_from( variant _os_batch ) _os_batch;
+variant _os_batch
+{
+	os_job job;
+	anon ref context;
+	n8 jobs;
+	n8 next_job;
+	n4 workers;
+};
+
+type_from( variant _os_workers ) _os_workers;
+variant _os_workers
+{
+	os_lock lock;
+	os_lock run_lock;
+	os_signal wake;
+	os_signal done;
+	_os_batch ref batch;
+	n4 generation;
+	n4 state;
+};
+
+perm _os_workers _os_pool = { 0 };
+perm thread_local flag _os_in_job = no;
+
+fn _os_workers_work( _os_batch ref const batch )
+{
+	_os_in_job = yes;
+	loop
+	{
+		temp n8 const index = atomic_add( ref_of( batch->next_job ), 1 );
+		skip_if( index >= batch->jobs );
+		batch->job( batch->context, index );
+	}
+	_os_in_job = no;
+}
+
+fn _os_workers_loop( anon ref const context, n8 const index )
+{
+	( anon )context;
+	( anon )index;
+	temp n4 seen = 0;
+	os_lock_enter( ref_of( _os_pool.lock ) );
+	loop
+	{
+		while( _os_pool.batch is nothing or _os_pool.generation is seen ) os_signal_wait( ref_of( _os_pool.wake ), ref_of( _os_pool.lock ) );
+		seen = _os_pool.generation;
+		temp _os_batch ref const batch = _os_pool.batch;
+		++batch->workers;
+		os_lock_leave( ref_of( _os_pool.lock ) );
+		_os_workers_work( batch );
+		os_lock_enter( ref_of( _os_pool.lock ) );
+		if( --batch->workers is 0 ) os_signal_all( ref_of( _os_pool.done ) );
+	}
+}
+
+fn _os_workers_start()
+{
+	n4 expected = 0;
+	if( atomic_compare_swap( ref_of( _os_pool.state ), ref_of( expected ), 1 ) )
+	{
+		os_lock_init( ref_of( _os_pool.lock ) );
+		os_lock_init( ref_of( _os_pool.run_lock ) );
+		os_signal_init( ref_of( _os_pool.wake ) );
+		os_signal_init( ref_of( _os_pool.done ) );
+		iter( i, os_cpu_count() - 1 )
+		{
+			os_thread thread;
+			if( os_create_thread( ref_of( thread ), _os_workers_loop, nothing, i ) ) os_detach_thread( thread );
+		}
+		atomic_store( ref_of( _os_pool.state ), 2 );
+	}
+	else while( atomic_load( ref_of( _os_pool.state ) ) isnt 2 ) atomic_pause();
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | jobs / visible
+
+// calls `job( context, index )` for every index below `jobs` on the worker pool and the calling thread,
+// returning when all are done; one batch runs at a time, and calls from inside a job run inline
+fn os_run_jobs( os_job const job, anon ref const context, n8 const jobs )
+{
+	if( jobs <= 1 or _os_in_job or os_cpu_count() is 1 )
+	{
+		iter( i, jobs ) job( context, i );
+		out;
+	}
+	if( atomic_load( ref_of( _os_pool.state ) ) isnt 2 ) _os_workers_start();
+	_os_batch batch = { .job = job, .context = context, .jobs = jobs };
+	os_lock_enter( ref_of( _os_pool.run_lock ) );
+	os_lock_enter( ref_of( _os_pool.lock ) );
+	_os_pool.batch = ref_of( batch );
+	++_os_pool.generation;
+	os_signal_all( ref_of( _os_pool.wake ) );
+	os_lock_leave( ref_of( _os_pool.lock ) );
+	_os_workers_work( ref_of( batch ) );
+	os_lock_enter( ref_of( _os_pool.lock ) );
+	_os_pool.batch = nothing;
+	while( batch.workers > 0 ) os_signal_wait( ref_of( _os_pool.done ), ref_of( _os_pool.lock ) );
+	os_lock_leave( ref_of( _os_pool.lock ) );
+	os_lock_leave( ref_of( _os_pool.run_lock ) );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion thread
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - memory
+
+// os_cache_size( LEVEL ) is the data cache size in bytes at level 1/2/3 (0 if absent),
+// and os_cache_last_size() the largest of them
+// bytes_copy_stream / bytes_fill_stream write around the caches with non-temporal stores, for
+// buffers that will not be read again soon; the _parallel forms split the work over os_run_jobs,
+// and the _bulk forms pick plain, streaming or parallel streaming by comparing with the last cache
+
+embed n8 os_cache_size( n1 const level )
+{
+	perm n8 sizes[ 4 ] = { 0 };
+	perm flag known = no;
+	if( not known )
+	{
+		#if OS_LINUX
+			#if defined( _SC_LEVEL1_DCACHE_SIZE )
+				temp long const l1 = sysconf( _SC_LEVEL1_DCACHE_SIZE ), l2 = sysconf( _SC_LEVEL2_CACHE_SIZE ), l3 = sysconf( _SC_LEVEL3_CACHE_SIZE );
+				sizes[ 1 ] = pick( l1 > 0, l1, 0 );
+				sizes[ 2 ] = pick( l2 > 0, l2, 0 );
+				sizes[ 3 ] = pick( l3 > 0, l3, 0 );
+			#endif
+			iter( index, 8 )
+			{
+				next_if( sizes[ 1 ] and sizes[ 2 ] and sizes[ 3 ] );
+				byte path[ 64 ] = "/sys/devices/system/cpu/cpu0/cache/index";
+				byte ref write = path + bytes_measure( path );
+				n1_to_bytes_move( index, write );
+				temp byte ref const name = write;
+				bytes_paste_move( write, "/level" );
+				bytes_end( write );
+				temp os_handle handle = fopen( path, "rb" );
+				skip_if_nothing( handle );
+				temp i4 const found_level = fgetc( handle ) - '0';
+				fclose( handle );
+				write = name;
+				bytes_paste_move( write, "/type" );
+				bytes_end( write );
+				byte kind[ 16 ] = { 0 };
+				handle = fopen( path, "rb" );
+				next_if_nothing( handle );
+				fread( kind, 1, size_of( kind ) - 1, handle );
+				fclose( handle );
+				next_if( kind[ 0 ] is 'I' or found_level < 1 or found_level > 3 or sizes[ found_level ] );
+				write = name;
+				bytes_paste_move( write, "/size" );
+				bytes_end( write );
+				handle = fopen( path, "rb" );
+				next_if_nothing( handle );
+				temp n8 size = 0;
+				temp i4 c = fgetc( handle );
+				while( c >= '0' and c <= '9' )
+				{
+					size = size * 10 + ( c - '0' );
+					c = fgetc( handle );
+				}
+				fclose( handle );
+				sizes[ found_level ] = size << pick( c is 'K', 10, pick( c is 'M', 20, 0 ) );
+			}
+		#elif OS_WINDOWS
+			DWORD length = 0;
+			GetLogicalProcessorInformation( nothing, ref_of( length ) );
+			temp SYSTEM_LOGICAL_PROCESSOR_INFORMATION ref const infos = _alloc( length );
+			if( infos isnt nothing and GetLogicalProcessorInformation( infos, ref_of( length ) ) )
+			{
+				iter( i, length / size_of( SYSTEM_LOGICAL_PROCESSOR_INFORMATION ) )
+				{
+					temp SYSTEM_LOGICAL_PROCESSOR_INFORMATION const ref const info = infos + i;
+					next_if( info->Relationship isnt RelationCache or info->Cache.Level < 1 or info->Cache.Level > 3 );
+					next_if( info->Cache.Type is CacheInstruction );
+					if( info->Cache.Size > sizes[ info->Cache.Level ] ) sizes[ info->Cache.Level ] = info->Cache.Size;
+				}
+			}
+			if_something( infos ) _free( infos );
+		#endif
+		known = yes;
+	}
+	out pick( level >= 1 and level <= 3, sizes[ level ], 0 );
+}
+
+embed n8 os_cache_last_size()
+{
+	temp n8 size = os_cache_size( 3 );
+	if( size is 0 ) size = os_cache_size( 2 );
+	if( size is 0 ) size = os_cache_size( 1 );
+	out pick( size is 0, 8 << 20, size );
+}
+
+////////////////////////////////
+#pragma region | memory / hidden
+
+#if SIMD_AVX2
+	#define _STREAM_WIDTH 32
+	#define _stream_splat( BYTE ) _mm256_set1_epi8( BYTE )
+	#define _stream_load( REF ) _mm256_loadu_si256( to( __m256i const ref, REF ) )
+	#define _stream_store( REF, VALUE ) _mm256_stream_si256( to( __m256i ref, REF ), VALUE )
+#elif SIMD_SSE2
+	#define _STREAM_WIDTH 16
+	#define _stream_splat( BYTE ) _mm_set1_epi8( BYTE )
+	#define _stream_load( REF ) _mm_loadu_si128( to( __m128i const ref, REF ) )
+	#define _stream_store( REF, VALUE ) _mm_stream_si128( to( __m128i ref, REF ), VALUE )
+#endif
+
+#define _STREAM_JOB_MIN ( 1 << 20 )
+
+type_from( variant _stream_job ) _stream_job;
+variant _stream_job
+{
+	byte ref to;
+	byte const ref from;
+	n8 size;
+	n8 chunk;
+	byte value;
+};
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | memory / visible
+
+fn bytes_copy_stream( anon ref const to_ref, anon const ref const from_ref, n8 const size )
+{
+	#if SIMD_SSE2
+		temp byte ref write = to_ref;
+		temp byte const ref read = from_ref;
+		temp n8 const align = ( _STREAM_WIDTH - ( to( n8, write ) & ( _STREAM_WIDTH - 1 ) ) ) & ( _STREAM_WIDTH - 1 );
+		temp n8 const head = pick( align < size, align, size );
+		bytes_copy( write, read, head );
+		write += head;
+		read += head;
+		temp n8 const body = ( size - head ) & ~to( n8, _STREAM_WIDTH * 4 - 1 );
+		for( temp n8 i = 0; i < body; i += _STREAM_WIDTH * 4 )
+		{
+			prefetch( read + i + 512 );
+			_stream_store( write + i, _stream_load( read + i ) );
+			_stream_store( write + i + _STREAM_WIDTH, _stream_load( read + i + _STREAM_WIDTH ) );
+			_stream_store( write + i + _STREAM_WIDTH * 2, _stream_load( read + i + _STREAM_WIDTH * 2 ) );
+			_stream_store( write + i + _STREAM_WIDTH * 3, _stream_load( read + i + _STREAM_WIDTH * 3 ) );
+		}
+		_mm_sfence();
+		bytes_copy( write + body, read + body, size - head - body );
+	#else
+		bytes_copy( to_ref, from_ref, size );
+	#endif
+}
+
+fn bytes_fill_stream( anon ref const to_ref, byte const value, n8 const size )
+{
+	#if SIMD_SSE2
+		temp byte ref write = to_ref;
+		temp n8 const align = ( _STREAM_WIDTH - ( to( n8, write ) & ( _STREAM_WIDTH - 1 ) ) ) & ( _STREAM_WIDTH - 1 );
+		temp n8 const head = pick( align < size, align, size );
+		bytes_fill( write, value, head );
+		write += head;
+		temp n8 const body = ( size - head ) & ~to( n8, _STREAM_WIDTH * 4 - 1 );
+		temp type_of( _stream_splat( 0 ) ) const splat = _stream_splat( value );
+		for( temp n8 i = 0; i < body; i += _STREAM_WIDTH * 4 )
+		{
+			_stream_store( write + i, splat );
+			_stream_store( write + i + _STREAM_WIDTH, splat );
+			_stream_store( write + i + _STREAM_WIDTH * 2, splat );
+			_stream_store( write + i + _STREAM_WIDTH * 3, splat );
+		}
+		_mm_sfence();
+		bytes_fill( write + body, value, size - head - body );
+	#else
+		bytes_fill( to_ref, value, size );
+	#endif
+}
+
+#define bytes_clear_stream( REF, SIZE ) bytes_fill_stream( REF, 0, SIZE )
+
+fn _bytes_copy_job( anon ref const context, n8 const index )
+{
+	temp _stream_job const ref const job = context;
+	temp n8 const begin = index * job->chunk;
+	bytes_copy_stream( job->to + begin, job->from + begin, pick( job->chunk < job->size - begin, job->chunk, job->size - begin ) );
+}
+
+fn _bytes_fill_job( anon ref const context, n8 const index )
+{
+	temp _stream_job const ref const job = context;
+	temp n8 const begin = index * job->chunk;
+	bytes_fill_stream( job->to + begin, job->value, pick( job->chunk < job->size - begin, job->chunk, job->size - begin ) );
+}
+
+// chunks are whole 4 KiB pages, at least _STREAM_JOB_MIN, one per thread
+embed n8 _stream_chunk( n8 const size )
+{
+	temp n8 const chunk = ( size + os_cpu_count() - 1 ) / os_cpu_count();
+	out ( pick( chunk > _STREAM_JOB_MIN, chunk, _STREAM_JOB_MIN ) + 4095 ) & ~to( n8, 4095 );
+}
+
+fn bytes_copy_parallel( anon ref const to_ref, anon const ref const from_ref, n8 const size )
+{
+	_stream_job job = { .to = to_ref, .from = from_ref, .size = size, .chunk = _stream_chunk( size ) };
+	os_run_jobs( _bytes_copy_job, ref_of( job ), ( size + job.chunk - 1 ) / job.chunk );
+}
+
+fn bytes_fill_parallel( anon ref const to_ref, byte const value, n8 const size )
+{
+	_stream_job job = { .to = to_ref, .value = value, .size = size, .chunk = _stream_chunk( size ) };
+	os_run_jobs( _bytes_fill_job, ref_of( job ), ( size + job.chunk - 1 ) / job.chunk );
+}
+
+fn bytes_copy_bulk( anon ref const to_ref, anon const ref const from_ref, n8 const size )
+{
+	temp n8 const last_size = os_cache_last_size();
+	if( size < last_size / 2 ) bytes_copy( to_ref, from_ref, size );
+	else if( size < last_size * 2 or os_cpu_count() is 1 ) bytes_copy_stream( to_ref, from_ref, size );
+	else bytes_copy_parallel( to_ref, from_ref, size );
+}
+
+fn bytes_fill_bulk( anon ref const to_ref, byte const value, n8 const size )
+{
+	temp n8 const last_size = os_cache_last_size();
+	if( size < last_size / 2 ) bytes_fill( to_ref, value, size );
+	else if( size < last_size * 2 or os_cpu_count() is 1 ) bytes_fill_stream( to_ref, value, size );
+	else bytes_fill_parallel( to_ref, value, size );
+}
+
+#define bytes_clear_bulk( REF, SIZE ) bytes_fill_bulk( REF, 0, SIZE )
+
+#pragma endregion visible
+///
+
+#pragma endregion memory
+////
+
+#pragma endregion os
+/////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region - MATHEMATICS
+//
+
+#define MIN( A, B ) pick( ( A ) < ( B ), ( A ), ( B ) )
+#define MIN3( A, B, C ) MIN( A, MIN( B, C ) )
+#define MIN4( A, B, C, D ) MIN3( A, B, MIN( C, D ) )
+#define MIN5( A, B, C, D, E ) MIN4( A, B, C, MIN( D, E ) )
+
+#define MAX( A, B ) pick( ( A ) > ( B ), ( A ), ( B ) )
+#define MAX3( A, B, C ) MAX( A, MAX( B, C ) )
+#define MAX4( A, B, C, D ) MAX3( A, B, MAX( C, D ) )
+#define MAX5( A, B, C, D, E ) MAX4( A, B, C, MAX( D, E ) )
+
+#define MEDIAN( A, B, C ) pick( ( A ) > ( B ), pick( ( B ) > ( C ), ( B ), MIN( A, C ) ), pick( ( A ) > ( C ), ( A ), MIN( B, C ) ) )
+#define MEDIAN4( A, B, C, D ) ( ( ( MIN( MAX( A, B ), MAX( C, D ) ) + MAX( MIN( A, B ), MIN( C, D ) ) ) ) / 2 )
+#define MEDIAN4_BITWISE( A, B, C, D ) ( ( ( MIN( MAX( A, B ), MAX( C, D ) ) + MAX( MIN( A, B ), MIN( C, D ) ) ) ) >> 1 )
+#define MEDIAN5( A, B, C, D, E ) ( ( A + B + C + D + E - MIN5( A, B, C, D, E ) - MAX5( A, B, C, D, E ) ) / 3 )
+
+#define AVG( A, B ) ( ( ( A ) + ( B ) ) / 2 )
+#define AVG_BITWISE( A, B ) ( ( ( A ) + ( B ) ) >> 1 )
+#define AVG3( A, B, C ) ( ( ( A ) + ( B ) + ( C ) ) / 3 )
+#define AVG4( A, B, C, D ) ( ( ( A ) + ( B ) + ( C ) + ( D ) ) / 4 )
+#define AVG4_BITWISE( A, B, C, D ) ( ( ( A ) + ( B ) + ( C ) + ( D ) ) >> 2 )
+
+#define CLAMP( V, MINIMUM, MAXIMUM ) MIN( MAX( ( V ), ( MINIMUM ) ), ( MAXIMUM ) )
+#define SATURATE( V ) CLAMP( V, 0, 1 )
+#define SQR( V ) ( ( V ) * ( V ) )
+#define CUBE( V ) ( ( V ) * ( V ) * ( V ) )
+#define ABS( V ) pick( ( V ) < 0, -( V ), V )
+#define SIGN( V ) pick( ( V ) >= 0, 1, -1 )
+#define SIGN_ZERO( V ) pick( ( V ) > 0, 1, pick( ( V ) < 0, -1, 0 ) )
+
+#define MIX( A, B, AMOUNT ) ( ( A ) + ( AMOUNT ) * ( ( B ) - ( A ) ) )
+#define MAP( V, A, B, C, D ) ( ( V ) - ( A ) ) * ( ( D ) - ( C ) ) / ( ( B ) - ( A ) ) + ( C )
+#define RANGE( V, LOWER, UPPER ) ( ( V - ( LOWER ) ) / ( ( UPPER ) - ( LOWER ) ) )
+
+////////////////////////////////////////////////////////////////
+#pragma region - bitwise
+
+embed n8 n8_rotl( n8 const v, n1 const amount )
+{
+	out ( v << amount ) | ( v >> ( ( 64 - amount ) & 63 ) );
+}
+
+embed n4 n4_rotr( n4 const v, n1 const amount )
+{
+	out ( v >> amount ) | ( v << ( ( 32 - amount ) & 31 ) );
+}
+
+// full 64x64 -> 128 multiply, returns the high half
+embed n8 n8_mul_hi( n8 const a, n8 const b, n8 ref const out_lo )
+{
+	#if COMPILER_GCC
+		temp __uint128_t const product = to( __uint128_t, a ) * b;
+		val_of( out_lo ) = n8( product );
+		out n8( product >> 64 );
+	#else
+		temp n8 const a_lo = a & n4_max_val, a_hi = a >> 32;
+		temp n8 const b_lo = b & n4_max_val, b_hi = b >> 32;
+		temp n8 const lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+		temp n8 const cross = ( lo_lo >> 32 ) + ( hi_lo & n4_max_val ) + lo_hi;
+		val_of( out_lo ) = ( cross << 32 ) | ( lo_lo & n4_max_val );
+		out ( hi_lo >> 32 ) + ( cross >> 32 ) + hi_hi;
+	#endif
+}
+
+embed n1 n4_ctz( n4 const v )
+{
+	#if COMPILER_GCC
+		out n1( __builtin_ctz( v ) );
+	#else
+		temp n1 count = 0;
+		while( count < 32 and not( ( v >> count ) & 1 ) ) ++count;
+		out count;
+	#endif
+}
+
+embed n1 n8_ctz( n8 const v )
+{
+	#if COMPILER_GCC
+		out n1( __builtin_ctzll( v ) );
+	#else
+		out pick( n4( v ) isnt 0, n4_ctz( n4( v ) ), 32 + n4_ctz( n4( v >> 32 ) ) );
+	#endif
+}
+
+embed n1 n8_clz( n8 const v )
+{
+	#if COMPILER_GCC
+		out n1( __builtin_clzll( v ) );
+	#else
+		temp n1 count = 0;
+		while( count < 64 and not( ( v << count ) >> 63 ) ) ++count;
+		out count;
+	#endif
+}
+
+embed n1 n8_popcount( n8 const v )
+{
+	#if COMPILER_GCC
+		out n1( __builtin_popcountll( v ) );
+	#else
+		temp n8 x = v - ( ( v >> 1 ) & 0x5555555555555555ull );
+		x = ( x & 0x3333333333333333ull ) + ( ( x >> 2 ) & 0x3333333333333333ull );
+		x = ( x + ( x >> 4 ) ) & 0x0F0F0F0F0F0F0F0Full;
+		out n1( ( x * 0x0101010101010101ull ) >> 56 );
+	#endif
+}
+
+#pragma endregion bitwise
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - random
+
+// generators: xoshiro256** / pcg32 / wyrand, each with an explicit state, `_seed`, `_n4` and `_n8`
+// every generator gets `_below_n4` / `_below_n8` (unbiased, Lemire) and `_unit_r4` / `_unit_r8` in [0,1)
+// `random_*` use a lazily seeded xoshiro256** per thread
+
+embed n8 splitmix_n8( n8 ref const state )
+{
+	temp n8 z = ( val_of( state ) += 0x9E3779B97F4A7C15ull );
+	z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+	z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+	out z ^ ( z >> 31 );
+}
+
+////////////////////////////////
+#pragma region | random / hidden
+
+#define _GEN_RANDOM( NAME )\
+	embed n4 NAME##_below_n4( NAME##_state ref const state, n4 const bound )\
+	{\
+		temp n8 m = n8( NAME##_n4( state ) ) * bound;\
+		temp n4 low = n4( m );\
+		if( low < bound )\
+		{\
+			temp n4 const threshold = n4( -bound ) mod bound;\
+			while( low < threshold )\
+			{\
+				m = n8( NAME##_n4( state ) ) * bound;\
+				low = n4( m );\
+			}\
+		}\
+		out n4( m >> 32 );\
+	}\
+	embed n8 NAME##_below_n8( NAME##_state ref const state, n8 const bound )\
+	{\
+		n8 low;\
+		temp n8 high = n8_mul_hi( NAME##_n8( state ), bound, ref_of( low ) );\
+		if( low < bound )\
+		{\
+			temp n8 const threshold = ( 0 - bound ) mod bound;\
+			while( low < threshold )\
+			{\
+				high = n8_mul_hi( NAME##_n8( state ), bound, ref_of( low ) );\
+			}\
+		}\
+		out high;\
+	}\
+	embed r4 NAME##_unit_r4( NAME##_state ref const state )\
+	{\
+		out r4( NAME##_n4( state ) >> 8 ) * 0x1.0p-24f;\
+	}\
+	embed r8 NAME##_unit_r8( NAME##_state ref const state )\
+	{\
+		out r8( NAME##_n8( state ) >> 11 ) * 0x1.0p-53;\
+	}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | random / xoshiro256**
+
+type( xoshiro_state )
+{
+	n8 s[ 4 ];
+};
+
+fn xoshiro_seed( xoshiro_state ref const state, n8 seed )
+{
+	iter( i, 4 ) state->s[ i ] = splitmix_n8( ref_of( seed ) );
+}
+
+embed n8 xoshiro_n8( xoshiro_state ref const state )
+{
+	temp n8 const result = n8_rotl( state->s[ 1 ] * 5, 7 ) * 9;
+	temp n8 const t = state->s[ 1 ] << 17;
+	state->s[ 2 ] ^= state->s[ 0 ];
+	state->s[ 3 ] ^= state->s[ 1 ];
+	state->s[ 1 ] ^= state->s[ 2 ];
+	state->s[ 0 ] ^= state->s[ 3 ];
+	state->s[ 2 ] ^= t;
+	state->s[ 3 ] = n8_rotl( state->s[ 3 ], 45 );
+	out result;
+}
+
+embed n4 xoshiro_n4( xoshiro_state ref const state )
+{
+	out n4( xoshiro_n8( state ) >> 32 );
+}
+
+// advances 2^128 steps, giving non-overlapping streams from one seed
+fn xoshiro_jump( xoshiro_state ref const state )
+{
+	perm n8 const jump_table[ 4 ] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+	temp n8 s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	iter( i, 4 )
+	{
+		iter( b, 64 )
+		{
+			if( jump_table[ i ] & ( n8( 1 ) << b ) )
+			{
+				s0 ^= state->s[ 0 ];
+				s1 ^= state->s[ 1 ];
+				s2 ^= state->s[ 2 ];
+				s3 ^= state->s[ 3 ];
+			}
+			xoshiro_n8( state );
+		}
+	}
+	state->s[ 0 ] = s0;
+	state->s[ 1 ] = s1;
+	state->s[ 2 ] = s2;
+	state->s[ 3 ] = s3;
+}
+
+_GEN_RANDOM( xoshiro );
+
+#pragma endregion xoshiro
+///
+
+////////////////////////////////
+#pragma region | random / pcg32
+
+type( pcg_state )
+{
+	n8 state;
+	n8 inc;
+};
+
+embed n4 pcg_n4( pcg_state ref const state )
+{
+	temp n8 const old = state->state;
+	state->state = old * 6364136223846793005ull + state->inc;
+	temp n4 const xorshifted = n4( ( ( old >> 18 ) ^ old ) >> 27 );
+	out n4_rotr( xorshifted, n1( old >> 59 ) );
+}
+
+embed n8 pcg_n8( pcg_state ref const state )
+{
+	temp n8 const high = pcg_n4( state );
+	out ( high << 32 ) | pcg_n4( state );
+}
+
+fn pcg_seed_stream( pcg_state ref const state, n8 const seed, n8 const stream )
+{
+	state->state = 0;
+	state->inc = ( stream << 1 ) | 1;
+	pcg_n4( state );
+	state->state += seed;
+	pcg_n4( state );
+}
+
+fn pcg_seed( pcg_state ref const state, n8 seed )
+{
+	temp n8 const stream = splitmix_n8( ref_of( seed ) );
+	pcg_seed_stream( state, seed, stream );
+}
+
+_GEN_RANDOM( pcg );
+
+#pragma endregion pcg32
+///
+
+////////////////////////////////
+#pragma region | random / wyrand
+
+type( wyrand_state )
+{
+	n8 s;
+};
+
+fn wyrand_seed( wyrand_state ref const state, n8 const seed )
+{
+	state->s = seed;
+}
+
+embed n8 wyrand_n8( wyrand_state ref const state )
+{
+	n8 low;
+	state->s += 0xA0761D6478BD642Full;
+	temp n8 const high = n8_mul_hi( state->s, state->s ^ 0xE7037ED1A0B428DBull, ref_of( low ) );
+	out high ^ low;
+}
+
+embed n4 wyrand_n4( wyrand_state ref const state )
+{
+	out n4( wyrand_n8( state ) >> 32 );
+}
+
+_GEN_RANDOM( wyrand );
+
+#pragma endregion wyrand
+///
+
+////////////////////////////////
+#pragma region | random / thread
+
+perm thread_local xoshiro_state _random_thread_state;
+perm thread_local flag _random_thread_seeded = no;
+
+fn random_seed( n8 const seed )
+{
+	xoshiro_seed( ref_of( _random_thread_state ), seed );
+	_random_thread_seeded = yes;
+}
+
+embed xoshiro_state ref _random_thread()
+{
+	if( not _random_thread_seeded )
+	{
+		random_seed( n8( time( nothing ) ) ^ n8( to( uintptr_t, ref_of( _random_thread_state ) ) ) );
+	}
+	out ref_of( _random_thread_state );
+}
+
+#define random_n4() xoshiro_n4( _random_thread() )
+#define random_n8() xoshiro_n8( _random_thread() )
+#define random_below_n4( BOUND ) xoshiro_below_n4( _random_thread(), BOUND )
+#define random_below_n8( BOUND ) xoshiro_below_n8( _random_thread(), BOUND )
+#define random_unit_r4() xoshiro_unit_r4( _random_thread() )
+#define random_unit_r8() xoshiro_unit_r8( _random_thread() )
+
+// uniform in [0,span), where a span of 0 means the full 64 bits
+embed n8 random_span( n8 const span )
+{
+	out_if( span is 0 ) random_n8();
+	out pick( span <= n4_max_val, n8( random_below_n4( n4( span ) ) ), random_below_n8( span ) );
+}
+
+#pragma endregion thread
+///
+
+////////////////////////////////
+#pragma region | random / fill
+
+// 4 interleaved xoshiro256** lanes stepped together, so the fill loop maps onto SIMD registers
+
+type( random_lanes )
+{
+	n8 s[ 4 ][ 4 ];
+};
+
+fn random_lanes_seed( random_lanes ref const lanes, n8 seed )
+{
+	iter( w, 4 ) iter( l, 4 ) lanes->s[ w ][ l ] = splitmix_n8( ref_of( seed ) );
+}
+
+fn random_lanes_fill( random_lanes ref const lanes, anon ref const to_ref, n8 const size )
+{
+	temp n1 ref const bytes = to( n1 ref, to_ref );
+	temp n8 pos = 0;
+	#if SIMD_AVX2
+		#define _RANDOM_ROTL_256( V, K ) _mm256_or_si256( _mm256_slli_epi64( V, K ), _mm256_srli_epi64( V, 64 - K ) )
+		__m256i s0 = _mm256_loadu_si256( to( __m256i const ref, lanes->s[ 0 ] ) );
+		__m256i s1 = _mm256_loadu_si256( to( __m256i const ref, lanes->s[ 1 ] ) );
+		__m256i s2 = _mm256_loadu_si256( to( __m256i const ref, lanes->s[ 2 ] ) );
+		__m256i s3 = _mm256_loadu_si256( to( __m256i const ref, lanes->s[ 3 ] ) );
+		for( ; pos + 32 <= size; pos += 32 )
+		{
+			__m256i const x5 = _mm256_add_epi64( _mm256_slli_epi64( s1, 2 ), s1 );
+			__m256i const rotated = _RANDOM_ROTL_256( x5, 7 );
+			__m256i const result = _mm256_add_epi64( _mm256_slli_epi64( rotated, 3 ), rotated );
+			__m256i const t = _mm256_slli_epi64( s1, 17 );
+			s2 = _mm256_xor_si256( s2, s0 );
+			s3 = _mm256_xor_si256( s3, s1 );
+			s1 = _mm256_xor_si256( s1, s2 );
+			s0 = _mm256_xor_si256( s0, s3 );
+			s2 = _mm256_xor_si256( s2, t );
+			s3 = _RANDOM_ROTL_256( s3, 45 );
+			_mm256_storeu_si256( to( __m256i ref, bytes + pos ), result );
+		}
+		_mm256_storeu_si256( to( __m256i ref, lanes->s[ 0 ] ), s0 );
+		_mm256_storeu_si256( to( __m256i ref, lanes->s[ 1 ] ), s1 );
+		_mm256_storeu_si256( to( __m256i ref, lanes->s[ 2 ] ), s2 );
+		_mm256_storeu_si256( to( __m256i ref, lanes->s[ 3 ] ), s3 );
+		#undef _RANDOM_ROTL_256
+	#endif
+	n8 block[ 4 ];
+	while( pos < size )
+	{
+		iter( l, 4 )
+		{
+			temp n8 const s1 = lanes->s[ 1 ][ l ];
+			temp n8 const t = s1 << 17;
+			block[ l ] = n8_rotl( s1 * 5, 7 ) * 9;
+			lanes->s[ 2 ][ l ] ^= lanes->s[ 0 ][ l ];
+			lanes->s[ 3 ][ l ] ^= s1;
+			lanes->s[ 1 ][ l ] ^= lanes->s[ 2 ][ l ];
+			lanes->s[ 0 ][ l ] ^= lanes->s[ 3 ][ l ];
+			lanes->s[ 2 ][ l ] ^= t;
+			lanes->s[ 3 ][ l ] = n8_rotl( lanes->s[ 3 ][ l ], 45 );
+		}
+		temp n8 const amount = pick( size - pos < size_of( block ), size - pos, size_of( block ) );
+		bytes_copy( bytes + pos, block, amount );
+		pos += amount;
+	}
+}
+
+perm thread_local random_lanes _random_thread_lanes;
+perm thread_local flag _random_thread_lanes_seeded = no;
+
+embed random_lanes ref _random_lanes_thread()
+{
+	if( not _random_thread_lanes_seeded )
+	{
+		random_lanes_seed( ref_of( _random_thread_lanes ), random_n8() );
+		_random_thread_lanes_seeded = yes;
+	}
+	out ref_of( _random_thread_lanes );
+}
+
+#define random_fill( TO_REF, SIZE ) random_lanes_fill( _random_lanes_thread(), TO_REF, SIZE )
+#define random_fill_n4( TO_REF, COUNT ) random_fill( TO_REF, size_of( n4 ) * ( COUNT ) )
+#define random_fill_n8( TO_REF, COUNT ) random_fill( TO_REF, size_of( n8 ) * ( COUNT ) )
+
+fn random_fill_r4( r4 ref const to_ref, n8 const count )
+{
+	random_fill_n4( to_ref, count );
+	temp n4 ref const bits = to( n4 ref, to_ref );
+	iter( i, count ) to_ref[ i ] = r4( bits[ i ] >> 8 ) * 0x1.0p-24f;
+}
+
+fn random_fill_r8( r8 ref const to_ref, n8 const count )
+{
+	random_fill_n8( to_ref, count );
+	temp n8 ref const bits = to( n8 ref, to_ref );
+	iter( i, count ) to_ref[ i ] = r8( bits[ i ] >> 11 ) * 0x1.0p-53;
+}
+
+#pragma endregion fill
+///
+
+#pragma endregion random
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - functions
+
+#define FUNCTION_GROUP_BASE( T, N )\
+	embed T##N T##N##_min( T##N const a, T##N const b )\
+	{\
+		out MIN( a, b );\
+	}\
+	embed T##N T##N##_min3( T##N const a, T##N const b, T##N const c )\
+	{\
+		out MIN3( a, b, c );\
+	}\
+	embed T##N T##N##_min4( T##N const a, T##N const b, T##N const c, T##N const d )\
+	{\
+		out MIN4( a, b, c, d );\
+	}\
+	embed T##N T##N##_min5( T##N const a, T##N const b, T##N const c, T##N const d, T##N const e )\
+	{\
 		out MIN5( a, b, c, d, e );\
 	}\
-	embed T##N T##N##_max( T##N const a, T##N const b )\
+	embed T##N T##N##_max( T##N const a, T##N const b )\
+	{\
+		out MAX( a, b );\
+	}\
+	embed T##N T##N##_max3( T##N const a, T##N const b, T##N const c )\
+	{\
+		out MAX3( a, b, c );\
+	}\
+	embed T##N T##N##_max4( T##N const a, T##N const b, T##N const c, T##N const d )\
+	{\
+		out MAX4( a, b, c, d );\
+	}\
+	embed T##N T##N##_max5( T##N const a, T##N const b, T##N const c, T##N const d, T##N const e )\
+	{\
+		out MAX5( a, b, c, d, e );\
+	}\
+	embed T##N T##N##_median( T##N const a, T##N const b, T##N const c )\
+	{\
+		out MEDIAN( a, b, c );\
+	}\
+	embed T##N T##N##_median5( T##N const a, T##N const b, T##N const c, T##N const d, T##N const e )\
+	{\
+		out MEDIAN5( a, b, c, d, e );\
+	}\
+	embed T##N T##N##_avg3( T##N const a, T##N const b, T##N const c )\
+	{\
+		out AVG3( a, b, c );\
+	}\
+	embed T##N T##N##_clamp( T##N const v, T##N const min, T##N const max )\
+	{\
+		out CLAMP( v, min, max );\
+	}\
+	embed T##N T##N##_saturate( T##N const v )\
+	{\
+		out SATURATE( v );\
+	}\
+	embed T##N T##N##_sqr( T##N const v )\
+	{\
+		out SQR( v );\
+	}\
+	embed T##N T##N##_cube( T##N const v )\
+	{\
+		out CUBE( v );\
+	}
+
+#define FUNCTION_GROUP_BASE_NI( T, N )\
+	embed T##N T##N##_median4( T##N const a, T##N const b, T##N const c, T##N const d )\
+	{\
+		out MEDIAN4_BITWISE( a, b, c, d );\
+	}\
+	embed T##N T##N##_avg( T##N const a, T##N const b )\
+	{\
+		out AVG_BITWISE( a, b );\
+	}\
+	embed T##N T##N##_avg4( T##N const a, T##N const b, T##N const c, T##N const d )\
+	{\
+		out AVG4_BITWISE( a, b, c, d );\
+	}\
+	embed T##N T##N##_random()\
+	{\
+		out T##N( random_n8() );\
+	}\
+	embed T##N T##N##_random_range( T##N const minimum, T##N const maximum )\
+	{\
+		out T##N( n8( minimum ) + random_span( n8( maximum ) - n8( minimum ) + 1 ) );\
+	}
+
+#define FUNCTION_GROUP_BASE_IR( T, N )\
+	embed T##N T##N##_abs( T##N const v )\
+	{\
+		out ABS( v );\
+	}\
+	embed T##N T##N##_sign( T##N const v )\
+	{\
+		out SIGN( v );\
+	}\
+	embed T##N T##N##_sign_zero( T##N const v )\
+	{\
+		out SIGN_ZERO( v );\
+	}
+
+#define FUNCTION_GROUP_N( N )\
+	FUNCTION_GROUP_BASE( n, N );\
+	FUNCTION_GROUP_BASE_NI( n, N )
+
+#define FUNCTION_GROUP_I( N )\
+	FUNCTION_GROUP_BASE( i, N );\
+	FUNCTION_GROUP_BASE_NI( i, N );\
+	FUNCTION_GROUP_BASE_IR( i, N )
+
+#define FUNCTION_GROUP_R( N )\
+	FUNCTION_GROUP_BASE( r, N );\
+	FUNCTION_GROUP_BASE_IR( r, N );\
+	embed r##N r##N##_median4( const r##N a, const r##N b, const r##N c, const r##N d )\
+	{\
+		out MEDIAN4( a, b, c, d );\
+	}\
+	embed r##N r##N##_avg( const r##N a, const r##N b )\
+	{\
+		out AVG( a, b );\
+	}\
+	embed r##N r##N##_avg4( const r##N a, const r##N b, const r##N c, const r##N d )\
+	{\
+		out AVG4( a, b, c, d );\
+	}\
+	embed r##N r##N##_mix( const r##N a, const r##N b, const r##N amount )\
+	{\
+		out MIX( a, b, amount );\
+	}\
+	embed r##N r##N##_map( const r##N v, const r##N from_lower, const r##N from_upper, const r##N to_lower, const r##N to_upper )\
+	{\
+		out MAP( v, from_lower, from_upper, to_lower, to_upper );\
+	}\
+	embed r##N r##N##_range( const r##N v, const r##N lower, const r##N upper )\
+	{\
+		out RANGE( v, lower, upper );\
+	}\
+	embed r##N r##N##_random()\
+	{\
+		out r##N( random_n4() );\
+	}\
+	embed r##N r##N##_random_unit()\
+	{\
+		out random_unit_r##N();\
+	}\
+	embed r##N r##N##_random_range( const r##N minimum, const r##N maximum )\
+	{\
+		out minimum + r##N##_random_unit() * ( maximum - minimum );\
+	}
+
+FUNCTION_GROUP_N( 1 );
+FUNCTION_GROUP_I( 1 );
+
+FUNCTION_GROUP_N( 2 );
+FUNCTION_GROUP_I( 2 );
+
+FUNCTION_GROUP_N( 4 );
+FUNCTION_GROUP_I( 4 );
+FUNCTION_GROUP_R( 4 );
+#define r4_trunc truncf
+#define r4_floor floorf
+#define r4_ceil ceilf
+#define r4_round roundf
+#define r4_mod fmodf
+#define r4_sqrt sqrtf
+#define r4_pow powf
+#define r4_sincos sincosf
+#define r4_sin sinf
+#define r4_cos cosf
+#define r4_tan tanf
+#define r4_asin asinf
+#define r4_acos acosf
+#define r4_atan atanf
+#define r4_atanyx atan2f
+
+FUNCTION_GROUP_N( 8 );
+FUNCTION_GROUP_I( 8 );
+FUNCTION_GROUP_R( 8 );
+#define r8_round round
+#define r8_trunc trunc
+#define r8_floor floor
+#define r8_ceil ceil
+#define r8_mod fmod
+#define r8_sqrt sqrt
+#define r8_pow pow
+#define r8_sincos sincos
+#define r8_sin sin
+#define r8_cos cos
+#define r8_tan tan
+#define r8_asin asin
+#define r8_acos acos
+#define r8_atan atan
+#define r8_atanyx atan2
+
+#pragma endregion functions
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - arrays
+
+// `T_NAME_array( to_ref, from_ref, count, ... )` kernels and `T_array_*` reductions, any count
+// SIMD paths use GCC vector extensions at SIMD_WIDTH, which lower to SSE2 / AVX2 / NEON
+// sums and dots add in 8 fixed lanes, combine pairwise, then add the tail in order,
+// so results don't depend on which path ran
+
+////////////////////////////////
+#pragma region | arrays / hidden
+
+#if SIMD_WIDTH
+	#define _SIMD_ONLY( CODE... ) CODE
+#else
+	#define _SIMD_ONLY( CODE... )
+#endif
+
+#define _SIMD_LANES( N ) ( SIMD_WIDTH / ( N ) )
+#define _SIMD_ACCS( N ) ( 8 / _SIMD_LANES( N ) )
+
+#define _GEN_SIMD( T, N )\
+	type_from( T##N ) _simd_##T##N __attribute__( ( vector_size( SIMD_WIDTH ) ) );\
+	embed _simd_##T##N _simd_load_##T##N( T##N const ref const from_ref )\
+	{\
+		_simd_##T##N v;\
+		bytes_copy( ref_of( v ), from_ref, SIMD_WIDTH );\
+		out v;\
+	}\
+	fn _simd_store_##T##N( T##N ref const to_ref, _simd_##T##N const v )\
+	{\
+		bytes_copy( to_ref, ref_of( v ), SIMD_WIDTH );\
+	}\
+	embed _simd_##T##N _simd_splat_##T##N( T##N const v )\
+	{\
+		out ( _simd_##T##N ){ 0 } + v;\
+	}\
+	embed _simd_##T##N _simd_select_##T##N( _simd_i##N const mask, _simd_##T##N const a, _simd_##T##N const b )\
+	{\
+		out to( _simd_##T##N, ( mask & to( _simd_i##N, a ) ) | ( ~mask & to( _simd_i##N, b ) ) );\
+	}\
+	embed _simd_##T##N _simd_min_##T##N( _simd_##T##N const a, _simd_##T##N const b )\
+	{\
+		out _simd_select_##T##N( to( _simd_i##N, a < b ), a, b );\
+	}\
+	embed _simd_##T##N _simd_max_##T##N( _simd_##T##N const a, _simd_##T##N const b )\
+	{\
+		out _simd_select_##T##N( to( _simd_i##N, a > b ), a, b );\
+	}
+
+#if SIMD_WIDTH
+	type_from( i1 ) _simd_i1 __attribute__( ( vector_size( SIMD_WIDTH ) ) );
+	type_from( i2 ) _simd_i2 __attribute__( ( vector_size( SIMD_WIDTH ) ) );
+	type_from( i4 ) _simd_i4 __attribute__( ( vector_size( SIMD_WIDTH ) ) );
+	type_from( i8 ) _simd_i8 __attribute__( ( vector_size( SIMD_WIDTH ) ) );
+	_GEN_SIMD( n, 1 );
+	_GEN_SIMD( i, 1 );
+	_GEN_SIMD( n, 2 );
+	_GEN_SIMD( i, 2 );
+	_GEN_SIMD( n, 4 );
+	_GEN_SIMD( i, 4 );
+	_GEN_SIMD( r, 4 );
+	_GEN_SIMD( n, 8 );
+	_GEN_SIMD( i, 8 );
+	_GEN_SIMD( r, 8 );
+#endif
+
+#define _GEN_ARRAY_UNARY( T, N, NAME, SIMD_EXPR, SCALAR_EXPR, EXTRA_INPUTS... )\
+	fn T##N##_##NAME##_array( T##N ref const to_ref, T##N const ref const from_ref, n8 const count EXTRA_INPUTS )\
+	{\
+		temp n8 i = 0;\
+		_SIMD_ONLY(\
+			for( ; i < count - count mod _SIMD_LANES( N ); i += _SIMD_LANES( N ) )\
+			{\
+				_simd_##T##N const v = _simd_load_##T##N( from_ref + i );\
+				_simd_store_##T##N( to_ref + i, SIMD_EXPR );\
+			}\
+		)\
+		for( ; i < count; ++i )\
+		{\
+			temp T##N const v = from_ref[ i ];\
+			to_ref[ i ] = SCALAR_EXPR;\
+		}\
+	}
+
+#define _GEN_ARRAY_BINARY( T, N, NAME, SIMD_EXPR, SCALAR_EXPR, EXTRA_INPUTS... )\
+	fn T##N##_##NAME##_array( T##N ref const to_ref, T##N const ref const a_ref, T##N const ref const b_ref, n8 const count EXTRA_INPUTS )\
+	{\
+		temp n8 i = 0;\
+		_SIMD_ONLY(\
+			for( ; i < count - count mod _SIMD_LANES( N ); i += _SIMD_LANES( N ) )\
+			{\
+				_simd_##T##N const a = _simd_load_##T##N( a_ref + i );\
+				_simd_##T##N const b = _simd_load_##T##N( b_ref + i );\
+				_simd_store_##T##N( to_ref + i, SIMD_EXPR );\
+			}\
+		)\
+		for( ; i < count; ++i )\
+		{\
+			temp T##N const a = a_ref[ i ];\
+			temp T##N const b = b_ref[ i ];\
+			to_ref[ i ] = SCALAR_EXPR;\
+		}\
+	}
+
+#define _GEN_ARRAY_EXTREME( T, N, NAME, SCALAR_OP )\
+	embed T##N T##N##_array_##NAME( T##N const ref const from_ref, n8 const count )\
+	{\
+		out_if( count is 0 ) 0;\
+		temp T##N result = from_ref[ 0 ];\
+		temp n8 i = 0;\
+		_SIMD_ONLY(\
+			if( count >= _SIMD_LANES( N ) )\
+			{\
+				_simd_##T##N v = _simd_load_##T##N( from_ref );\
+				for( i = _SIMD_LANES( N ); i < count - count mod _SIMD_LANES( N ); i += _SIMD_LANES( N ) )\
+				{\
+					v = _simd_##NAME##_##T##N( v, _simd_load_##T##N( from_ref + i ) );\
+				}\
+				T##N lanes[ _SIMD_LANES( N ) ];\
+				bytes_copy( lanes, ref_of( v ), SIMD_WIDTH );\
+				iter( l, _SIMD_LANES( N ) ) result = SCALAR_OP( result, lanes[ l ] );\
+			}\
+		)\
+		for( ; i < count; ++i ) result = SCALAR_OP( result, from_ref[ i ] );\
+		out result;\
+	}
+
+#define _ARRAY_LANES_SUM( LANES ) ( ( ( LANES[ 0 ] + LANES[ 1 ] ) + ( LANES[ 2 ] + LANES[ 3 ] ) ) + ( ( LANES[ 4 ] + LANES[ 5 ] ) + ( LANES[ 6 ] + LANES[ 7 ] ) ) )
+
+// sums into ACC across 8 lanes; narrow integers widen to n8 / i8 instead of wrapping
+#define _GEN_ARRAY_SUM_WIDE( T, N, ACC )\
+	embed ACC T##N##_array_sum( T##N const ref const from_ref, n8 const count )\
+	{\
+		ACC lanes[ 8 ] = { 0 };\
+		temp n8 i = 0;\
+		for( ; i < count - count mod 8; i += 8 ) iter( l, 8 ) lanes[ l ] += from_ref[ i + l ];\
+		temp ACC sum = _ARRAY_LANES_SUM( lanes );\
+		for( ; i < count; ++i ) sum += from_ref[ i ];\
+		out sum;\
+	}\
+	embed ACC T##N##_array_dot( T##N const ref const a_ref, T##N const ref const b_ref, n8 const count )\
+	{\
+		ACC lanes[ 8 ] = { 0 };\
+		temp n8 i = 0;\
+		for( ; i < count - count mod 8; i += 8 ) iter( l, 8 ) lanes[ l ] += ACC( a_ref[ i + l ] ) * ACC( b_ref[ i + l ] );\
+		temp ACC sum = _ARRAY_LANES_SUM( lanes );\
+		for( ; i < count; ++i ) sum += ACC( a_ref[ i ] ) * ACC( b_ref[ i ] );\
+		out sum;\
+	}
+
+#define _GEN_ARRAY_SUM_SIMD( T, N )\
+	embed T##N T##N##_array_sum( T##N const ref const from_ref, n8 const count )\
+	{\
+		T##N lanes[ 8 ] = { 0 };\
+		temp n8 i = 0;\
+		_SIMD_ONLY(\
+			_simd_##T##N acc[ _SIMD_ACCS( N ) ];\
+			bytes_clear( acc, size_of( acc ) );\
+			for( ; i < count - count mod 8; i += 8 )\
+			{\
+				iter( j, _SIMD_ACCS( N ) ) acc[ j ] += _simd_load_##T##N( from_ref + i + j * _SIMD_LANES( N ) );\
+			}\
+			bytes_copy( lanes, acc, size_of( acc ) );\
+		)\
+		for( ; i < count - count mod 8; i += 8 ) iter( l, 8 ) lanes[ l ] += from_ref[ i + l ];\
+		temp T##N sum = _ARRAY_LANES_SUM( lanes );\
+		for( ; i < count; ++i ) sum += from_ref[ i ];\
+		out sum;\
+	}\
+	embed T##N T##N##_array_dot( T##N const ref const a_ref, T##N const ref const b_ref, n8 const count )\
+	{\
+		T##N lanes[ 8 ] = { 0 };\
+		temp n8 i = 0;\
+		_SIMD_ONLY(\
+			_simd_##T##N acc[ _SIMD_ACCS( N ) ];\
+			bytes_clear( acc, size_of( acc ) );\
+			for( ; i < count - count mod 8; i += 8 )\
+			{\
+				iter( j, _SIMD_ACCS( N ) )\
+				{\
+					temp n8 const at = i + j * _SIMD_LANES( N );\
+					acc[ j ] += _simd_load_##T##N( a_ref + at ) * _simd_load_##T##N( b_ref + at );\
+				}\
+			}\
+			bytes_copy( lanes, acc, size_of( acc ) );\
+		)\
+		for( ; i < count - count mod 8; i += 8 ) iter( l, 8 ) lanes[ l ] += a_ref[ i + l ] * b_ref[ i + l ];\
+		temp T##N sum = _ARRAY_LANES_SUM( lanes );\
+		for( ; i < count; ++i ) sum += a_ref[ i ] * b_ref[ i ];\
+		out sum;\
+	}
+
+#define _GEN_ARRAY_SUM_n1 _GEN_ARRAY_SUM_WIDE( n, 1, n8 )
+#define _GEN_ARRAY_SUM_i1 _GEN_ARRAY_SUM_WIDE( i, 1, i8 )
+#define _GEN_ARRAY_SUM_n2 _GEN_ARRAY_SUM_WIDE( n, 2, n8 )
+#define _GEN_ARRAY_SUM_i2 _GEN_ARRAY_SUM_WIDE( i, 2, i8 )
+#define _GEN_ARRAY_SUM_n4 _GEN_ARRAY_SUM_WIDE( n, 4, n8 )
+#define _GEN_ARRAY_SUM_i4 _GEN_ARRAY_SUM_WIDE( i, 4, i8 )
+#define _GEN_ARRAY_SUM_r4 _GEN_ARRAY_SUM_SIMD( r, 4 )
+#define _GEN_ARRAY_SUM_n8 _GEN_ARRAY_SUM_SIMD( n, 8 )
+#define _GEN_ARRAY_SUM_i8 _GEN_ARRAY_SUM_SIMD( i, 8 )
+#define _GEN_ARRAY_SUM_r8 _GEN_ARRAY_SUM_SIMD( r, 8 )
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | arrays / visible
+
+#define FUNCTION_GROUP_ARRAY_BASE( T, N )\
+	_GEN_ARRAY_BINARY( T, N, min, _simd_min_##T##N( a, b ), MIN( a, b ) )\
+	_GEN_ARRAY_BINARY( T, N, max, _simd_max_##T##N( a, b ), MAX( a, b ) )\
+	_GEN_ARRAY_UNARY( T, N, clamp, _simd_min_##T##N( _simd_max_##T##N( v, _simd_splat_##T##N( min ) ), _simd_splat_##T##N( max ) ), CLAMP( v, min, max ), , T##N const min, T##N const max )\
+	_GEN_ARRAY_UNARY( T, N, sqr, v * v, SQR( v ) )\
+	_GEN_ARRAY_EXTREME( T, N, min, MIN )\
+	_GEN_ARRAY_EXTREME( T, N, max, MAX )\
+	_GEN_ARRAY_SUM_##T##N
+
+#define FUNCTION_GROUP_ARRAY_IR( T, N )\
+	_GEN_ARRAY_UNARY( T, N, abs, _simd_select_##T##N( to( _simd_i##N, v < 0 ), -v, v ), ABS( v ) )
+
+#define FUNCTION_GROUP_ARRAY_R( N )\
+	_GEN_ARRAY_UNARY( r, N, saturate, _simd_min_r##N( _simd_max_r##N( v, _simd_splat_r##N( 0 ) ), _simd_splat_r##N( 1 ) ), SATURATE( v ) )\
+	_GEN_ARRAY_BINARY( r, N, mix, a + ( b - a ) * amount, MIX( a, b, amount ), , r##N const amount )
+
+FUNCTION_GROUP_ARRAY_BASE( n, 1 );
+FUNCTION_GROUP_ARRAY_BASE( i, 1 );
+FUNCTION_GROUP_ARRAY_IR( i, 1 );
+
+FUNCTION_GROUP_ARRAY_BASE( n, 2 );
+FUNCTION_GROUP_ARRAY_BASE( i, 2 );
+FUNCTION_GROUP_ARRAY_IR( i, 2 );
+
+FUNCTION_GROUP_ARRAY_BASE( n, 4 );
+FUNCTION_GROUP_ARRAY_BASE( i, 4 );
+FUNCTION_GROUP_ARRAY_IR( i, 4 );
+FUNCTION_GROUP_ARRAY_BASE( r, 4 );
+FUNCTION_GROUP_ARRAY_IR( r, 4 );
+FUNCTION_GROUP_ARRAY_R( 4 );
+
+FUNCTION_GROUP_ARRAY_BASE( n, 8 );
+FUNCTION_GROUP_ARRAY_BASE( i, 8 );
+FUNCTION_GROUP_ARRAY_IR( i, 8 );
+FUNCTION_GROUP_ARRAY_BASE( r, 8 );
+FUNCTION_GROUP_ARRAY_IR( r, 8 );
+FUNCTION_GROUP_ARRAY_R( 8 );
+
+#pragma endregion visible
+///
+
+#pragma endregion arrays
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - fast
+
+// minimax / series r4 approximations with no error handling, max error measured against r8 libm:
+// r4_fast_sin / _cos / _sincos    |x| <= pi          2 ulp, |x| <= 8192: 1e-7 absolute
+// r4_fast_atanyx                  normal inputs      3 ulp
+// r4_fast_exp2                    -126 <= x < 128    2 ulp, clamped outside
+// r4_fast_log2                    normal x > 0       3 ulp
+// r4_fast_rsqrt                   normal x > 0       2 ulp
+// r4_fast_pow                     x > 0              relative 7e-7 while |y * log2( x )| <= 4, growing with it
+// each has an `_array` batch form that runs the same math on SIMD_WIDTH vectors
+
+embed n4 r4_as_n4( r4 const v )
+{
+	n4 bits;
+	bytes_copy( ref_of( bits ), ref_of( v ), size_of( n4 ) );
+	out bits;
+}
+
+embed r4 n4_as_r4( n4 const v )
+{
+	r4 real;
+	bytes_copy( ref_of( real ), ref_of( v ), size_of( r4 ) );
+	out real;
+}
+
+////////////////////////////////
+#pragma region | fast / hidden
+
+#define _R4_FAST_MAGIC 12582912.0f
+#define _R4_FAST_MAGIC_BITS 0x4B400000u
+#define _R4_FAST_SIGN 0x80000000u
+
+// written once over scalar or vector types, so the array forms share the exact scalar math
+#define _GEN_R4_FAST( P, R, I, AS_I, AS_R, LESS, SPLAT )\
+	embed R P##select( I const mask, R const a, R const b )\
+	{\
+		out AS_R( ( mask & AS_I( a ) ) | ( ~mask & AS_I( b ) ) );\
+	}\
+	fn P##sincos( R const x, R ref const out_sin, R ref const out_cos )\
+	{\
+		R const k = x * 0.636619772f + _R4_FAST_MAGIC;\
+		R const q_real = k - _R4_FAST_MAGIC;\
+		I const q = AS_I( k ) - _R4_FAST_MAGIC_BITS;\
+		R const r = ( ( x - q_real * 1.5703125f ) - q_real * 4.837512969970703125e-4f ) - q_real * 7.54978995489188216e-8f;\
+		R const z = r * r;\
+		R const s = r + r * z * ( -1.6666654611e-1f + z * ( 8.3321608736e-3f + z * -1.9515295891e-4f ) );\
+		R const c = 1.0f - 0.5f * z + z * z * ( 4.166664568298827e-2f + z * ( -1.388731625493765e-3f + z * 2.443315711809948e-5f ) );\
+		I const swap = 0 - ( q & 1 );\
+		val_of( out_sin ) = AS_R( AS_I( P##select( swap, c, s ) ) ^ ( ( q << 30 ) & _R4_FAST_SIGN ) );\
+		val_of( out_cos ) = AS_R( AS_I( P##select( swap, s, c ) ) ^ ( ( ( q + 1 ) << 30 ) & _R4_FAST_SIGN ) );\
+	}\
+	embed R P##sin( R const x )\
+	{\
+		R s, c;\
+		P##sincos( x, ref_of( s ), ref_of( c ) );\
+		out s;\
+	}\
+	embed R P##cos( R const x )\
+	{\
+		R s, c;\
+		P##sincos( x, ref_of( s ), ref_of( c ) );\
+		out c;\
+	}\
+	embed R P##atanyx( R const y, R const x )\
+	{\
+		R const ax = AS_R( AS_I( x ) & ~_R4_FAST_SIGN );\
+		R const ay = AS_R( AS_I( y ) & ~_R4_FAST_SIGN );\
+		I const swap = 0 - ( AS_I( ax - ay ) >> 31 );\
+		R const num = P##select( swap, ax, ay );\
+		R den = P##select( swap, ay, ax );\
+		den = P##select( LESS( den, 1e-37f ), SPLAT( 1.0f ), den );\
+		R const a = num / den;\
+		R const z = a * a;\
+		R p = a * ( 0.999999984531457f + z * ( -0.33333069934809384f + z * ( 0.19992547283465417f + z * ( -0.14203070702301507f + z * ( 0.10638697078022409f + z * ( -0.0749955888134352f + z * ( 0.04263595093836481f + z * ( -0.016034654096434585f + z * 0.002841445326795142f ) ) ) ) ) ) ) );\
+		p = P##select( swap, 1.570796327f - p, p );\
+		p = P##select( 0 - ( AS_I( x ) >> 31 ), 3.141592654f - p, p );\
+		out AS_R( AS_I( p ) ^ ( AS_I( y ) & _R4_FAST_SIGN ) );\
+	}\
+	embed R P##exp2( R x )\
+	{\
+		x = P##select( LESS( x, -126.0f ), SPLAT( -126.0f ), x );\
+		x = P##select( LESS( 127.99999f, x ), SPLAT( 127.99999f ), x );\
+		R const k = x + _R4_FAST_MAGIC;\
+		I const n = AS_I( k ) - _R4_FAST_MAGIC_BITS;\
+		R const f = x - ( k - _R4_FAST_MAGIC );\
+		R const p = 1.0f + f * ( 0.6931472028558353f + f * ( 0.2402264791343484f + f * ( 0.055503324698896815f + f * ( 0.009618437374472525f + f * ( 0.0013398874807035313f + f * 0.0001535335835715864f ) ) ) ) );\
+		out AS_R( AS_I( p ) + ( n << 23 ) );\
+	}\
+	embed R P##log2( R const x )\
+	{\
+		I const e = ( AS_I( x ) + ( 0x40000000u - 0x3F3504F3u ) ) >> 23;\
+		R const m = AS_R( AS_I( x ) - ( ( e - 128 ) << 23 ) );\
+		R const u = ( m - 1.0f ) / ( m + 1.0f );\
+		R const z = u * u;\
+		R const p = u * ( 2.8853900817779268f + z * ( 0.9617966939259756f + z * ( 0.5770780163555854f + z * ( 0.41219858311113244f + z * 0.3205988979753252f ) ) ) );\
+		R const exponent = AS_R( e + _R4_FAST_MAGIC_BITS ) - ( _R4_FAST_MAGIC + 128.0f );\
+		out p + exponent;\
+	}\
+	embed R P##rsqrt( R const x )\
+	{\
+		R y = AS_R( 0x5F375A86u - ( AS_I( x ) >> 1 ) );\
+		y = y * ( 1.5f - 0.5f * ( x * y ) * y );\
+		y = y * ( 1.5f - 0.5f * ( x * y ) * y );\
+		out y + y * ( 0.5f - 0.5f * ( x * y ) * y );\
+	}\
+	embed R P##pow( R const x, R const y )\
+	{\
+		out P##exp2( y * P##log2( x ) );\
+	}
+
+#define _R4_FAST_LESS( A, B ) ( n4( 0 ) - n4( ( A ) < ( B ) ) )
+#define _R4_FAST_SPLAT( V ) ( V )
+_GEN_R4_FAST( r4_fast_, r4, n4, r4_as_n4, n4_as_r4, _R4_FAST_LESS, _R4_FAST_SPLAT );
+
+#if SIMD_WIDTH
+	#define _SIMD_R4_AS_N4( V ) to( _simd_n4, V )
+	#define _SIMD_N4_AS_R4( V ) to( _simd_r4, V )
+	#define _SIMD_R4_FAST_LESS( A, B ) to( _simd_n4, ( A ) < ( B ) )
+	_GEN_R4_FAST( _r4_fast_simd_, _simd_r4, _simd_n4, _SIMD_R4_AS_N4, _SIMD_N4_AS_R4, _SIMD_R4_FAST_LESS, _simd_splat_r4 );
+#endif
+
+#define _GEN_R4_FAST_ARRAY( NAME )\
+	fn r4_fast_##NAME##_array( r4 ref const to_ref, r4 const ref const from_ref, n8 const count )\
+	{\
+		temp n8 i = 0;\
+		_SIMD_ONLY(\
+			for( ; i < count - count mod _SIMD_LANES( 4 ); i += _SIMD_LANES( 4 ) )\
+			{\
+				_simd_store_r4( to_ref + i, _r4_fast_simd_##NAME( _simd_load_r4( from_ref + i ) ) );\
+			}\
+		)\
+		for( ; i < count; ++i ) to_ref[ i ] = r4_fast_##NAME( from_ref[ i ] );\
+	}
+
+#define _GEN_R4_FAST_ARRAY_2( NAME, A, B )\
+	fn r4_fast_##NAME##_array( r4 ref const to_ref, r4 const ref const A##_ref, r4 const ref const B##_ref, n8 const count )\
+	{\
+		temp n8 i = 0;\
+		_SIMD_ONLY(\
+			for( ; i < count - count mod _SIMD_LANES( 4 ); i += _SIMD_LANES( 4 ) )\
+			{\
+				_simd_store_r4( to_ref + i, _r4_fast_simd_##NAME( _simd_load_r4( A##_ref + i ), _simd_load_r4( B##_ref + i ) ) );\
+			}\
+		)\
+		for( ; i < count; ++i ) to_ref[ i ] = r4_fast_##NAME( A##_ref[ i ], B##_ref[ i ] );\
+	}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | fast / visible
+
+_GEN_R4_FAST_ARRAY( sin );
+_GEN_R4_FAST_ARRAY( cos );
+_GEN_R4_FAST_ARRAY( exp2 );
+_GEN_R4_FAST_ARRAY( log2 );
+_GEN_R4_FAST_ARRAY( rsqrt );
+_GEN_R4_FAST_ARRAY_2( atanyx, y, x );
+_GEN_R4_FAST_ARRAY_2( pow, x, y );
+
+fn r4_fast_sincos_array( r4 ref const sin_ref, r4 ref const cos_ref, r4 const ref const from_ref, n8 const count )
+{
+	temp n8 i = 0;
+	_SIMD_ONLY(
+		for( ; i < count - count mod _SIMD_LANES( 4 ); i += _SIMD_LANES( 4 ) )
+		{
+			_simd_r4 s, c;
+			_r4_fast_simd_sincos( _simd_load_r4( from_ref + i ), ref_of( s ), ref_of( c ) );
+			_simd_store_r4( sin_ref + i, s );
+			_simd_store_r4( cos_ref + i, c );
+		}
+	)
+	for( ; i < count; ++i ) r4_fast_sincos( from_ref[ i ], sin_ref + i, cos_ref + i );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion fast
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - vectors
+
+// r4x2 / r4x3 / r4x4 / i4x4 are GCC vector types that stay in SIMD registers; without
+// vector support they fall back to plain arrays with the same functions
+// r4x3 has a 4th lane kept at 0 so it fills one register; r4x4x4 is 4 r4x4 columns
+
+////////////////////////////////
+#pragma region | vectors / hidden
+
+#if COMPILER_GCC
+	#define _GEN_VECTOR_TYPE( NAME, T, SIZE ) type_from( T ) NAME __attribute__( ( vector_size( SIZE ) ) )
+	#define vector_at( V, I ) ( V )[ I ]
+	#define _VECTOR_OP( NAME, LANES, A, OP, B ) ( ( A ) OP ( B ) )
+	#define _VECTOR_OP_SCALAR( NAME, LANES, A, OP, S ) ( ( A ) OP ( S ) )
+#else
+	#define _GEN_VECTOR_TYPE( NAME, T, SIZE ) type_from( variant { T v[ ( SIZE ) / size_of( T ) ]; } ) NAME
+	#define vector_at( V, I ) ( V ).v[ I ]
+	#define _VECTOR_OP( NAME, LANES, A, OP, B ) ( { NAME _r; iter( _i, LANES ) vector_at( _r, _i ) = vector_at( A, _i ) OP vector_at( B, _i ); _r; } )
+	#define _VECTOR_OP_SCALAR( NAME, LANES, A, OP, S ) ( { NAME _r; iter( _i, LANES ) vector_at( _r, _i ) = vector_at( A, _i ) OP ( S ); _r; } )
+#endif
+
+#define _GEN_VECTOR( NAME, T, LANES, USED_LANES )\
+	embed NAME NAME##_add( NAME const a, NAME const b )\
+	{\
+		out _VECTOR_OP( NAME, LANES, a, +, b );\
+	}\
+	embed NAME NAME##_sub( NAME const a, NAME const b )\
+	{\
+		out _VECTOR_OP( NAME, LANES, a, -, b );\
+	}\
+	embed NAME NAME##_mul( NAME const a, NAME const b )\
+	{\
+		out _VECTOR_OP( NAME, LANES, a, *, b );\
+	}\
+	embed NAME NAME##_scale( NAME const v, T const s )\
+	{\
+		out _VECTOR_OP_SCALAR( NAME, LANES, v, *, s );\
+	}\
+	embed NAME NAME##_neg( NAME const v )\
+	{\
+		out NAME##_scale( v, -1 );\
+	}\
+	embed NAME NAME##_min( NAME const a, NAME const b )\
+	{\
+		NAME r = a;\
+		iter( i, USED_LANES ) vector_at( r, i ) = MIN( vector_at( a, i ), vector_at( b, i ) );\
+		out r;\
+	}\
+	embed NAME NAME##_max( NAME const a, NAME const b )\
+	{\
+		NAME r = a;\
+		iter( i, USED_LANES ) vector_at( r, i ) = MAX( vector_at( a, i ), vector_at( b, i ) );\
+		out r;\
+	}\
+	embed T NAME##_dot( NAME const a, NAME const b )\
+	{\
+		NAME const p = NAME##_mul( a, b );\
+		temp T sum = 0;\
+		iter( i, USED_LANES ) sum += vector_at( p, i );\
+		out sum;\
+	}\
+	embed T NAME##_sum( NAME const v )\
+	{\
+		temp T sum = 0;\
+		iter( i, USED_LANES ) sum += vector_at( v, i );\
+		out sum;\
+	}
+
+#define _GEN_VECTOR_R( NAME, LANES, USED_LANES )\
+	_GEN_VECTOR( NAME, r4, LANES, USED_LANES )\
+	embed NAME NAME##_div( NAME const a, NAME const b )\
+	{\
+		NAME r = a;\
+		iter( i, USED_LANES ) vector_at( r, i ) = vector_at( a, i ) / vector_at( b, i );\
+		out r;\
+	}\
+	embed NAME NAME##_mix( NAME const a, NAME const b, r4 const amount )\
+	{\
+		out NAME##_add( a, NAME##_scale( NAME##_sub( b, a ), amount ) );\
+	}\
+	embed r4 NAME##_length_sqr( NAME const v )\
+	{\
+		out NAME##_dot( v, v );\
+	}\
+	embed r4 NAME##_length( NAME const v )\
+	{\
+		out r4_sqrt( NAME##_dot( v, v ) );\
+	}\
+	embed NAME NAME##_normalize( NAME const v )\
+	{\
+		temp r4 const length_sqr = NAME##_dot( v, v );\
+		out_if( length_sqr is 0 ) v;\
+		out NAME##_scale( v, 1.0f / r4_sqrt( length_sqr ) );\
+	}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | vectors / types
+
+_GEN_VECTOR_TYPE( r4x2, r4, 8 );
+_GEN_VECTOR_TYPE( r4x3, r4, 16 );
+_GEN_VECTOR_TYPE( r4x4, r4, 16 );
+_GEN_VECTOR_TYPE( i4x4, i4, 16 );
+
+type_from( variant r4x4x4 ) r4x4x4;
+variant r4x4x4
+{
+	r4x4 col[ 4 ];
+};
+
+#define r4x2( X, Y ) make( r4x2, X, Y )
+#define r4x3( X, Y, Z ) make( r4x3, X, Y, Z, 0 )
+#define r4x4( X, Y, Z, W ) make( r4x4, X, Y, Z, W )
+#define i4x4( X, Y, Z, W ) make( i4x4, X, Y, Z, W )
+
+_GEN_VECTOR_R( r4x2, 2, 2 );
+_GEN_VECTOR_R( r4x3, 4, 3 );
+_GEN_VECTOR_R( r4x4, 4, 4 );
+_GEN_VECTOR( i4x4, i4, 4, 4 );
+
+embed r4x3 r4x3_cross( r4x3 const a, r4x3 const b )
+{
+	out r4x3(
+		vector_at( a, 1 ) * vector_at( b, 2 ) - vector_at( a, 2 ) * vector_at( b, 1 ),
+		vector_at( a, 2 ) * vector_at( b, 0 ) - vector_at( a, 0 ) * vector_at( b, 2 ),
+		vector_at( a, 0 ) * vector_at( b, 1 ) - vector_at( a, 1 ) * vector_at( b, 0 )
+	);
+}
+
+#pragma endregion types
+///
+
+////////////////////////////////
+#pragma region | vectors / matrix
+
+// column-major: transform( m, v ) = col[ 0 ] * v.x + col[ 1 ] * v.y + col[ 2 ] * v.z + col[ 3 ] * v.w
+
+embed r4x4x4 r4x4x4_identity()
+{
+	r4x4x4 m;
+	m.col[ 0 ] = r4x4( 1, 0, 0, 0 );
+	m.col[ 1 ] = r4x4( 0, 1, 0, 0 );
+	m.col[ 2 ] = r4x4( 0, 0, 1, 0 );
+	m.col[ 3 ] = r4x4( 0, 0, 0, 1 );
+	out m;
+}
+
+embed r4x4x4 r4x4x4_translation( r4x3 const offset )
+{
+	r4x4x4 m = r4x4x4_identity();
+	m.col[ 3 ] = r4x4( vector_at( offset, 0 ), vector_at( offset, 1 ), vector_at( offset, 2 ), 1 );
+	out m;
+}
+
+embed r4x4x4 r4x4x4_scaling( r4x3 const scale )
+{
+	r4x4x4 m = r4x4x4_identity();
+	iter( i, 3 ) vector_at( m.col[ i ], i ) = vector_at( scale, i );
+	out m;
+}
+
+embed r4x4x4 r4x4x4_rotation( r4x3 const axis, r4 const angle )
+{
+	r4 s, c;
+	r4_sincos( angle, ref_of( s ), ref_of( c ) );
+	r4x3 const a = r4x3_normalize( axis );
+	temp r4 const x = vector_at( a, 0 ), y = vector_at( a, 1 ), z = vector_at( a, 2 ), t = 1 - c;
+	r4x4x4 m;
+	m.col[ 0 ] = r4x4( t * x * x + c, t * x * y + s * z, t * x * z - s * y, 0 );
+	m.col[ 1 ] = r4x4( t * x * y - s * z, t * y * y + c, t * y * z + s * x, 0 );
+	m.col[ 2 ] = r4x4( t * x * z + s * y, t * y * z - s * x, t * z * z + c, 0 );
+	m.col[ 3 ] = r4x4( 0, 0, 0, 1 );
+	out m;
+}
+
+embed r4x4 r4x4x4_transform( r4x4x4 const ref const m, r4x4 const v )
+{
+	r4x4 r = r4x4_scale( m->col[ 0 ], vector_at( v, 0 ) );
+	r = r4x4_add( r, r4x4_scale( m->col[ 1 ], vector_at( v, 1 ) ) );
+	r = r4x4_add( r, r4x4_scale( m->col[ 2 ], vector_at( v, 2 ) ) );
+	out r4x4_add( r, r4x4_scale( m->col[ 3 ], vector_at( v, 3 ) ) );
+}
+
+embed r4x3 r4x4x4_transform_point( r4x4x4 const ref const m, r4x3 const p )
+{
+	r4x4 r = r4x4x4_transform( m, r4x4( vector_at( p, 0 ), vector_at( p, 1 ), vector_at( p, 2 ), 1 ) );
+	out r4x3( vector_at( r, 0 ), vector_at( r, 1 ), vector_at( r, 2 ) );
+}
+
+embed r4x3 r4x4x4_transform_direction( r4x4x4 const ref const m, r4x3 const d )
+{
+	r4x4 r = r4x4x4_transform( m, r4x4( vector_at( d, 0 ), vector_at( d, 1 ), vector_at( d, 2 ), 0 ) );
+	out r4x3( vector_at( r, 0 ), vector_at( r, 1 ), vector_at( r, 2 ) );
+}
+
+embed r4x4x4 r4x4x4_mul( r4x4x4 const ref const a, r4x4x4 const ref const b )
+{
+	r4x4x4 m;
+	iter( i, 4 ) m.col[ i ] = r4x4x4_transform( a, b->col[ i ] );
+	out m;
+}
+
+embed r4x4x4 r4x4x4_transpose( r4x4x4 const ref const m )
+{
+	r4x4x4 t;
+	iter( c, 4 ) iter( r, 4 ) vector_at( t.col[ r ], c ) = vector_at( m->col[ c ], r );
+	out t;
+}
+
+#pragma endregion matrix
+///
+
+////////////////////////////////
+#pragma region | vectors / batch
+
+fn r4x4x4_transform_points( r4x4x4 const ref const m, r4x3 ref const to_ref, r4x3 const ref const from_ref, n8 const count )
+{
+	r4x4x4 const local = val_of( m );
+	iter( i, count ) to_ref[ i ] = r4x4x4_transform_point( ref_of( local ), from_ref[ i ] );
+}
+
+// SoA points in place, SIMD_WIDTH points per step
+fn r4x4x4_transform_points_soa( r4x4x4 const ref const m, r4 ref const xs, r4 ref const ys, r4 ref const zs, n8 const count )
+{
+	r4 e[ 4 ][ 4 ];
+	iter( c, 4 ) iter( r, 4 ) e[ c ][ r ] = vector_at( m->col[ c ], r );
+	temp n8 i = 0;
+	_SIMD_ONLY(
+		for( ; i < count - count mod _SIMD_LANES( 4 ); i += _SIMD_LANES( 4 ) )
+		{
+			_simd_r4 const x = _simd_load_r4( xs + i );
+			_simd_r4 const y = _simd_load_r4( ys + i );
+			_simd_r4 const z = _simd_load_r4( zs + i );
+			_simd_store_r4( xs + i, x * e[ 0 ][ 0 ] + y * e[ 1 ][ 0 ] + z * e[ 2 ][ 0 ] + e[ 3 ][ 0 ] );
+			_simd_store_r4( ys + i, x * e[ 0 ][ 1 ] + y * e[ 1 ][ 1 ] + z * e[ 2 ][ 1 ] + e[ 3 ][ 1 ] );
+			_simd_store_r4( zs + i, x * e[ 0 ][ 2 ] + y * e[ 1 ][ 2 ] + z * e[ 2 ][ 2 ] + e[ 3 ][ 2 ] );
+		}
+	)
+	for( ; i < count; ++i )
+	{
+		temp r4 const x = xs[ i ], y = ys[ i ], z = zs[ i ];
+		xs[ i ] = x * e[ 0 ][ 0 ] + y * e[ 1 ][ 0 ] + z * e[ 2 ][ 0 ] + e[ 3 ][ 0 ];
+		ys[ i ] = x * e[ 0 ][ 1 ] + y * e[ 1 ][ 1 ] + z * e[ 2 ][ 1 ] + e[ 3 ][ 1 ];
+		zs[ i ] = x * e[ 0 ][ 2 ] + y * e[ 1 ][ 2 ] + z * e[ 2 ][ 2 ] + e[ 3 ][ 2 ];
+	}
+}
+
+// AoS <-> SoA, so `iter` loops can run over plain r4 arrays
+
+fn r4x2_to_soa( r4 ref const xs, r4 ref const ys, r4x2 const ref const from_ref, n8 const count )
+{
+	iter( i, count )
+	{
+		xs[ i ] = vector_at( from_ref[ i ], 0 );
+		ys[ i ] = vector_at( from_ref[ i ], 1 );
+	}
+}
+
+fn r4x2_from_soa( r4x2 ref const to_ref, r4 const ref const xs, r4 const ref const ys, n8 const count )
+{
+	iter( i, count ) to_ref[ i ] = r4x2( xs[ i ], ys[ i ] );
+}
+
+fn r4x3_to_soa( r4 ref const xs, r4 ref const ys, r4 ref const zs, r4x3 const ref const from_ref, n8 const count )
+{
+	iter( i, count )
+	{
+		xs[ i ] = vector_at( from_ref[ i ], 0 );
+		ys[ i ] = vector_at( from_ref[ i ], 1 );
+		zs[ i ] = vector_at( from_ref[ i ], 2 );
+	}
+}
+
+fn r4x3_from_soa( r4x3 ref const to_ref, r4 const ref const xs, r4 const ref const ys, r4 const ref const zs, n8 const count )
+{
+	iter( i, count ) to_ref[ i ] = r4x3( xs[ i ], ys[ i ], zs[ i ] );
+}
+
+fn r4x4_to_soa( r4 ref const xs, r4 ref const ys, r4 ref const zs, r4 ref const ws, r4x4 const ref const from_ref, n8 const count )
+{
+	iter( i, count )
+	{
+		xs[ i ] = vector_at( from_ref[ i ], 0 );
+		ys[ i ] = vector_at( from_ref[ i ], 1 );
+		zs[ i ] = vector_at( from_ref[ i ], 2 );
+		ws[ i ] = vector_at( from_ref[ i ], 3 );
+	}
+}
+
+fn r4x4_from_soa( r4x4 ref const to_ref, r4 const ref const xs, r4 const ref const ys, r4 const ref const zs, r4 const ref const ws, n8 const count )
+{
+	iter( i, count ) to_ref[ i ] = r4x4( xs[ i ], ys[ i ], zs[ i ], ws[ i ] );
+}
+
+// one field of a `type()` record array to / from a plain array
+#define soa_gather( TO_REF, FROM_REF, COUNT, FIELD ) iter( _SOA_I, COUNT ) ( TO_REF )[ _SOA_I ] = ( FROM_REF )[ _SOA_I ].FIELD
+#define soa_scatter( TO_REF, FROM_REF, COUNT, FIELD ) iter( _SOA_I, COUNT ) ( TO_REF )[ _SOA_I ].FIELD = ( FROM_REF )[ _SOA_I ]
+
+#pragma endregion batch
+///
+
+#pragma endregion vectors
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - bitset
+
+// a growable array of bits packed in n8 words; bits past `count` in the last word stay 0,
+// so bulk ops, counts and `iter_bits` never see them
+// bulk ops run over the shorter of the sets, as SIMD_WIDTH vectors of words
+
+type( bitset )
+{
+	n8 ref words;
+	n8 count;
+};
+
+#define bitset_words( COUNT ) ( ( ( COUNT ) + 63 ) / 64 )
+
+////////////////////////////////
+#pragma region | bitset / hidden
+
+#define _bitset_tail_mask( COUNT ) pick( ( COUNT ) & 63, ( 1ull << ( ( COUNT ) & 63 ) ) - 1, n8_max_val )
+
+// the first set bit at or past POS, or n8_max_val
+embed n8 _bitset_next( n8 const ref const words, n8 const count, n8 const pos )
+{
+	out_if( pos >= count ) n8_max_val;
+	temp n8 const word_count = bitset_words( count );
+	temp n8 w = pos / 64;
+	temp n8 word = words[ w ] & ( n8_max_val << ( pos & 63 ) );
+	while( word is 0 )
+	{
+		out_if( ++w >= word_count ) n8_max_val;
+		word = words[ w ];
+	}
+	out w * 64 + n8_ctz( word );
+}
+
+// without a popcount instruction, SSE2 counts 2 words at a time by nibble sums and `psadbw`
+embed n8 _bitset_popcount_words( n8 const ref const words, n8 const word_count )
+{
+	temp n8 a = 0, b = 0, c = 0, d = 0;
+	temp n8 w = 0;
+	#if SIMD_SSE2 and not SIMD_POPCNT
+		temp __m128i const m1 = _mm_set1_epi8( 0x55 ), m2 = _mm_set1_epi8( 0x33 ), m4 = _mm_set1_epi8( 0x0F );
+		temp __m128i sum = _mm_setzero_si128();
+		for( ; w + 2 <= word_count; w += 2 )
+		{
+			temp __m128i x = _mm_loadu_si128( to( __m128i const ref, words + w ) );
+			x = _mm_sub_epi8( x, _mm_and_si128( _mm_srli_epi64( x, 1 ), m1 ) );
+			x = _mm_add_epi8( _mm_and_si128( x, m2 ), _mm_and_si128( _mm_srli_epi64( x, 2 ), m2 ) );
+			x = _mm_and_si128( _mm_add_epi8( x, _mm_srli_epi64( x, 4 ) ), m4 );
+			sum = _mm_add_epi64( sum, _mm_sad_epu8( x, _mm_setzero_si128() ) );
+		}
+		n8 lanes[ 2 ];
+		_mm_storeu_si128( to( __m128i ref, lanes ), sum );
+		a = lanes[ 0 ] + lanes[ 1 ];
+	#endif
+	for( ; w + 4 <= word_count; w += 4 )
+	{
+		a += n8_popcount( words[ w ] );
+		b += n8_popcount( words[ w + 1 ] );
+		c += n8_popcount( words[ w + 2 ] );
+		d += n8_popcount( words[ w + 3 ] );
+	}
+	for( ; w < word_count; ++w ) a += n8_popcount( words[ w ] );
+	out a + b + c + d;
+}
+
+#define _GEN_BITSET_OP( NAME, OP )\
+	fn bitset_##NAME( bitset ref const to_ref, bitset const ref const a_ref, bitset const ref const b_ref )\
+	{\
+		temp n8 const count = MIN3( to_ref->count, a_ref->count, b_ref->count );\
+		temp n8 const word_count = bitset_words( count );\
+		temp n8 ref const to = to_ref->words;\
+		temp n8 const ref const a = a_ref->words;\
+		temp n8 const ref const b = b_ref->words;\
+		temp n8 const tail_mask = _bitset_tail_mask( count );\
+		temp n8 const kept = pick( count & 63, to[ word_count - 1 ] & ~tail_mask, 0 );\
+		temp n8 w = 0;\
+		_SIMD_ONLY(\
+			for( ; w + _SIMD_LANES( 8 ) <= word_count; w += _SIMD_LANES( 8 ) )\
+			{\
+				_simd_n8 const x = _simd_load_n8( a + w );\
+				_simd_n8 const y = _simd_load_n8( b + w );\
+				_simd_store_n8( to + w, OP( x, y ) );\
+			}\
+		)\
+		for( ; w < word_count; ++w ) to[ w ] = OP( a[ w ], b[ w ] );\
+		if( count & 63 ) to[ word_count - 1 ] = ( to[ word_count - 1 ] & tail_mask ) | kept;\
+	}
+
+#define _BITSET_AND( X, Y ) ( ( X ) & ( Y ) )
+#define _BITSET_OR( X, Y ) ( ( X ) | ( Y ) )
+#define _BITSET_XOR( X, Y ) ( ( X ) ^ ( Y ) )
+#define _BITSET_ANDNOT( X, Y ) ( ( X ) & ~( Y ) )
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | bitset / visible
+
+// all bits 0; `words` is nothing when memory runs out
+embed bitset bitset_create( n8 const count )
+{
+	bitset set = { .words = os_create_ref( n8, MAX( bitset_words( count ), 1 ) ), .count = count };
+	if_nothing( set.words ) set.count = 0;
+	out set;
+}
+
+fn bitset_delete( bitset ref const set )
+{
+	os_delete_ref( set->words );
+	set->count = 0;
+}
+
+// new bits are 0
+embed flag bitset_resize( bitset ref const set, n8 const count )
+{
+	temp n8 const old_words = bitset_words( set->count );
+	temp n8 const new_words = bitset_words( count );
+	temp n8 ref const words = os_resize_ref( set->words, size_of( n8 ) * MAX( new_words, 1 ), yes );
+	out_if_nothing( words ) no;
+	set->words = words;
+	if( new_words > old_words ) bytes_clear( words + old_words, size_of( n8 ) * ( new_words - old_words ) );
+	if( count < set->count and count & 63 ) words[ new_words - 1 ] &= _bitset_tail_mask( count );
+	set->count = count;
+	out yes;
+}
+
+embed flag bitset_test( bitset const ref const set, n8 const pos )
+{
+	out ( set->words[ pos / 64 ] >> ( pos & 63 ) ) & 1;
+}
+
+fn bitset_set( bitset ref const set, n8 const pos )
+{
+	set->words[ pos / 64 ] |= 1ull << ( pos & 63 );
+}
+
+fn bitset_clear( bitset ref const set, n8 const pos )
+{
+	set->words[ pos / 64 ] &= ~( 1ull << ( pos & 63 ) );
+}
+
+fn bitset_flip( bitset ref const set, n8 const pos )
+{
+	set->words[ pos / 64 ] ^= 1ull << ( pos & 63 );
+}
+
+fn bitset_set_all( bitset ref const set )
+{
+	temp n8 const word_count = bitset_words( set->count );
+	out_if( word_count is 0 );
+	bytes_fill( set->words, 0xFF, size_of( n8 ) * word_count );
+	set->words[ word_count - 1 ] &= _bitset_tail_mask( set->count );
+}
+
+fn bitset_clear_all( bitset ref const set )
+{
+	bytes_clear( set->words, size_of( n8 ) * bitset_words( set->count ) );
+}
+
+// `bitset_and / _or / _xor / _andnot( to_ref, a_ref, b_ref )`, TO may be A or B; only the bits
+// below the smallest of the three counts are written, the rest of TO stays as it was
+_GEN_BITSET_OP( and, _BITSET_AND );
+_GEN_BITSET_OP( or, _BITSET_OR );
+_GEN_BITSET_OP( xor, _BITSET_XOR );
+_GEN_BITSET_OP( andnot, _BITSET_ANDNOT );
+
+embed n8 bitset_popcount( bitset const ref const set )
+{
+	out _bitset_popcount_words( set->words, bitset_words( set->count ) );
+}
+
+// set bits before POS
+embed n8 bitset_rank( bitset const ref const set, n8 const pos )
+{
+	temp n8 const end = MIN( pos, set->count );
+	temp n8 rank = _bitset_popcount_words( set->words, end / 64 );
+	if( end & 63 ) rank += n8_popcount( set->words[ end / 64 ] & _bitset_tail_mask( end ) );
+	out rank;
+}
+
+// the first set bit at or past POS, or the set's count
+embed n8 bitset_find_next( bitset const ref const set, n8 const pos )
+{
+	temp n8 const found = _bitset_next( set->words, set->count, pos );
+	out pick( found is n8_max_val, set->count, found );
+}
+
+// visits only the set bits of SET, in order, skipping clear words with `ctz`
+#define iter_bits( POS_NAME, SET )\
+	for( temp n8 POS_NAME = _bitset_next( ( SET ).words, ( SET ).count, 0 ); POS_NAME isnt n8_max_val; POS_NAME = _bitset_next( ( SET ).words, ( SET ).count, POS_NAME + 1 ) )
+
+#pragma endregion visible
+///
+
+#pragma endregion bitset
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - grid
+
+// `morton_encode` interleaves x into the even bits and y into the odd bits (Z-order),
+// by `pdep` / `pext` with BMI2
+// a `grid` stores cells row-major, or in square tiles of 2^tile_log cells a side laid out row-major,
+// each tile holding its cells row-major ( grid_tiled ) or in Z-order ( grid_morton ), so
+// neighborhoods stay on a few cache lines and pages; a tile as large as the grid is pure Z-order
+
+#ifndef H_GRID_TILE_LOG
+	#define H_GRID_TILE_LOG 3
+#endif
+
+group( grid_layout )
+{
+	grid_row_major,
+	grid_tiled,
+	grid_morton
+};
+
+type( grid )
+{
+	byte ref cells;
+	n8 cell_count;
+	n4 width;
+	n4 height;
+	n4 tiles_x;
+	n2 cell_size;
+	grid_layout layout;
+	n1 tile_log;
+};
+
+////////////////////////////////
+#pragma region | grid / hidden
+
+#define _MORTON_EVEN 0x5555555555555555ull
+#define _MORTON_ODD 0xAAAAAAAAAAAAAAAAull
+
+embed n8 _morton_spread( n4 const v )
+{
+	temp n8 x = v;
+	x = ( x | ( x << 16 ) ) & 0x0000FFFF0000FFFFull;
+	x = ( x | ( x << 8 ) ) & 0x00FF00FF00FF00FFull;
+	x = ( x | ( x << 4 ) ) & 0x0F0F0F0F0F0F0F0Full;
+	x = ( x | ( x << 2 ) ) & 0x3333333333333333ull;
+	out ( x | ( x << 1 ) ) & _MORTON_EVEN;
+}
+
+embed n4 _morton_compact( n8 const v )
+{
+	temp n8 x = v & _MORTON_EVEN;
+	x = ( x | ( x >> 1 ) ) & 0x3333333333333333ull;
+	x = ( x | ( x >> 2 ) ) & 0x0F0F0F0F0F0F0F0Full;
+	x = ( x | ( x >> 4 ) ) & 0x00FF00FF00FF00FFull;
+	x = ( x | ( x >> 8 ) ) & 0x0000FFFF0000FFFFull;
+	out n4( x | ( x >> 16 ) );
+}
+
+#define _iter_grid_morton( X_NAME, Y_NAME, WIDTH, HEIGHT, COUNTER )\
+	for( temp n8 JOIN( _MORTON_, COUNTER ) = 0, JOIN( _MORTON_END_, COUNTER ) = morton_span( WIDTH, HEIGHT ); JOIN( _MORTON_, COUNTER ) < JOIN( _MORTON_END_, COUNTER ); ++JOIN( _MORTON_, COUNTER ) )\
+		for( temp i8 X_NAME = morton_decode_x( JOIN( _MORTON_, COUNTER ) ), Y_NAME = morton_decode_y( JOIN( _MORTON_, COUNTER ) ), JOIN( _MORTON_ONCE_, COUNTER ) = 1; JOIN( _MORTON_ONCE_, COUNTER ) and X_NAME < i8( WIDTH ) and Y_NAME < i8( HEIGHT ); JOIN( _MORTON_ONCE_, COUNTER ) = 0 )
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | grid / visible
+
+embed n8 morton_encode( n4 const x, n4 const y )
+{
+	#if SIMD_BMI2
+		out _pdep_u64( x, _MORTON_EVEN ) | _pdep_u64( y, _MORTON_ODD );
+	#else
+		out _morton_spread( x ) | ( _morton_spread( y ) << 1 );
+	#endif
+}
+
+embed n4 morton_decode_x( n8 const code )
+{
+	#if SIMD_BMI2
+		out n4( _pext_u64( code, _MORTON_EVEN ) );
+	#else
+		out _morton_compact( code );
+	#endif
+}
+
+embed n4 morton_decode_y( n8 const code )
+{
+	#if SIMD_BMI2
+		out n4( _pext_u64( code, _MORTON_ODD ) );
+	#else
+		out _morton_compact( code >> 1 );
+	#endif
+}
+
+fn morton_decode( n8 const code, n4 ref const x, n4 ref const y )
+{
+	val_of( x ) = morton_decode_x( code );
+	val_of( y ) = morton_decode_y( code );
+}
+
+// the Z-order codes covering WIDTH x HEIGHT: the square of the next power of two of the larger side;
+// above a side of 2^31 that would need 2^64, so it gives n8_max_val, leaving out only the last cell of 2^32 x 2^32
+embed n8 morton_span( n4 const width, n4 const height )
+{
+	temp n4 const side = MAX( width, height );
+	out_if( side <= 1 ) side;
+	temp n1 const side_log = 64 - n8_clz( n8( side ) - 1 );
+	out_if( side_log >= 32 ) n8_max_val;
+	out 1ull << ( 2 * side_log );
+}
+
+// visits WIDTH x HEIGHT in Z-order, skipping codes outside it; best on square-ish grids
+#define iter_grid_morton( X_NAME, Y_NAME, WIDTH, HEIGHT ) _iter_grid_morton( X_NAME, Y_NAME, WIDTH, HEIGHT, __COUNTER__ )
+
+// the cell number of X, Y; multiply by `cell_size` for the byte offset
+embed n8 grid_index( grid const ref const g, n4 const x, n4 const y )
+{
+	out_if( g->layout is grid_row_major ) n8( y ) * g->width + x;
+	temp n1 const tile_log = g->tile_log;
+	temp n4 const mask = ( 1u << tile_log ) - 1;
+	temp n8 const tile = ( n8( y >> tile_log ) * g->tiles_x + ( x >> tile_log ) ) << ( 2 * tile_log );
+	out_if( g->layout is grid_tiled ) tile + ( n8( y & mask ) << tile_log ) + ( x & mask );
+	out tile + morton_encode( x & mask, y & mask );
+}
+
+#define grid_at( GRID_REF, TYPE, X, Y ) to( TYPE ref, ( GRID_REF )->cells + grid_index( GRID_REF, X, Y ) * ( GRID_REF )->cell_size )
+
+// all cells 0; `cells` is nothing when memory runs out
+embed grid _grid_create( n4 const width, n4 const height, n2 const cell_size, grid_layout const layout, n1 const tile_log )
+{
+	grid g = { .width = width, .height = height, .cell_size = cell_size, .layout = layout, .tile_log = tile_log };
+	if( layout is grid_row_major ) g.cell_count = n8( width ) * height;
+	else
+	{
+		temp n4 const side = 1u << tile_log;
+		g.tiles_x = ( width + side - 1 ) >> tile_log;
+		g.cell_count = n8( g.tiles_x ) * ( ( height + side - 1 ) >> tile_log ) << ( 2 * tile_log );
+	}
+	g.cells = os_create_ref( byte, MAX( g.cell_count * cell_size, 1 ) );
+	out g;
+}
+#define grid_create( WIDTH, HEIGHT, TYPE, LAYOUT, TILE_LOG... ) _grid_create( WIDTH, HEIGHT, size_of( TYPE ), LAYOUT, DEFAULT( H_GRID_TILE_LOG, TILE_LOG ) )
+
+fn grid_delete( grid ref const g )
+{
+	os_delete_ref( g->cells );
+	g->cell_count = 0;
+}
+
+// copies between the grid and row-major ROWS, ROW_STRIDE bytes apart, one tile row run at a time
+fn _grid_rows( grid ref const g, byte ref const rows, n8 const row_stride, flag const save )
+{
+	temp n8 const cell_size = g->cell_size;
+	if( g->layout is grid_row_major )
+	{
+		temp n8 const row_size = n8( g->width ) * cell_size;
+		iter( y, g->height )
+		{
+			temp byte ref const cells = g->cells + n8( y ) * row_size;
+			if( save ) bytes_copy( rows + y * row_stride, cells, row_size );
+			else bytes_copy( cells, rows + y * row_stride, row_size );
+		}
+		out;
+	}
+	temp n4 const side = 1u << g->tile_log;
+	iter_step( tile_y, g->height, side ) iter_step( tile_x, g->width, side )
+	{
+		temp n8 const run = MIN( side, g->width - n4( tile_x ) ) * cell_size;
+		range( y, tile_y, MIN( tile_y + side, g->height ) - 1 )
+		{
+			temp byte ref const row = rows + y * row_stride + tile_x * cell_size;
+			if( g->layout is grid_tiled )
+			{
+				temp byte ref const cells = g->cells + grid_index( g, n4( tile_x ), n4( y ) ) * cell_size;
+				if( save ) bytes_copy( row, cells, run );
+				else bytes_copy( cells, row, run );
+				next;
+			}
+			iter( x, run / cell_size )
+			{
+				temp byte ref const cells = g->cells + grid_index( g, n4( tile_x + x ), n4( y ) ) * cell_size;
+				if( save ) bytes_copy( row + x * cell_size, cells, cell_size );
+				else bytes_copy( cells, row + x * cell_size, cell_size );
+			}
+		}
+	}
+}
+
+#define grid_load_rows( GRID_REF, ROWS, ROW_STRIDE ) _grid_rows( GRID_REF, to( byte ref, ROWS ), ROW_STRIDE, no )
+#define grid_save_rows( GRID_REF, ROWS, ROW_STRIDE ) _grid_rows( GRID_REF, to( byte ref, ROWS ), ROW_STRIDE, yes )
+
+#pragma endregion visible
+///
+
+#pragma endregion grid
+////
+
+#pragma endregion mathematics
+/////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region - HASH
+//
+
+////////////////////////////////////////////////////////////////
+#pragma region - hash
+
+// wyhash-style 64-bit hashing, not cryptographic
+
+#define _HASH_SECRET_0 0xA0761D6478BD642Full
+#define _HASH_SECRET_1 0xE7037ED1A0B428DBull
+#define _HASH_SECRET_2 0x8EBC6AF09C88C6E3ull
+#define _HASH_SECRET_3 0x589965CC75374CC3ull
+
+embed n8 hash_mix( n8 const a, n8 const b )
+{
+	n8 low;
+	temp n8 const high = n8_mul_hi( a, b, ref_of( low ) );
+	out high ^ low;
+}
+
+embed n8 hash_n8( n8 const v )
+{
+	out hash_mix( v ^ _HASH_SECRET_0, _HASH_SECRET_1 );
+}
+
+embed n8 _hash_read_n8( n1 const ref const p )
+{
+	n8 v;
+	bytes_copy( ref_of( v ), p, size_of( n8 ) );
+	out v;
+}
+
+embed n8 _hash_read_n4( n1 const ref const p )
+{
+	n4 v;
+	bytes_copy( ref_of( v ), p, size_of( n4 ) );
+	out v;
+}
+
+embed n8 _hash_bytes( anon const ref const bytes, n8 const size, n8 seed )
+{
+	temp n1 const ref p = to( n1 const ref, bytes );
+	n8 a, b;
+	seed ^= hash_mix( seed ^ _HASH_SECRET_0, _HASH_SECRET_1 );
+	if( size <= 16 )
+	{
+		if( size >= 4 )
+		{
+			temp n8 const shift = ( size >> 3 ) << 2;
+			a = ( _hash_read_n4( p ) << 32 ) | _hash_read_n4( p + shift );
+			b = ( _hash_read_n4( p + size - 4 ) << 32 ) | _hash_read_n4( p + size - 4 - shift );
+		}
+		else if( size > 0 )
+		{
+			a = ( n8( p[ 0 ] ) << 16 ) | ( n8( p[ size >> 1 ] ) << 8 ) | p[ size - 1 ];
+			b = 0;
+		}
+		else a = b = 0;
+	}
+	else
+	{
+		temp n8 remaining = size;
+		if( remaining > 48 )
+		{
+			temp n8 see1 = seed, see2 = seed;
+			do
+			{
+				seed = hash_mix( _hash_read_n8( p ) ^ _HASH_SECRET_1, _hash_read_n8( p + 8 ) ^ seed );
+				see1 = hash_mix( _hash_read_n8( p + 16 ) ^ _HASH_SECRET_2, _hash_read_n8( p + 24 ) ^ see1 );
+				see2 = hash_mix( _hash_read_n8( p + 32 ) ^ _HASH_SECRET_3, _hash_read_n8( p + 40 ) ^ see2 );
+				p += 48;
+				remaining -= 48;
+			}
+			while( remaining > 48 );
+			seed ^= see1 ^ see2;
+		}
+		while( remaining > 16 )
+		{
+			seed = hash_mix( _hash_read_n8( p ) ^ _HASH_SECRET_1, _hash_read_n8( p + 8 ) ^ seed );
+			p += 16;
+			remaining -= 16;
+		}
+		a = _hash_read_n8( p + remaining - 16 );
+		b = _hash_read_n8( p + remaining - 8 );
+	}
+	a ^= _HASH_SECRET_1;
+	b ^= seed;
+	n8 low;
+	temp n8 const high = n8_mul_hi( a, b, ref_of( low ) );
+	out hash_mix( low ^ _HASH_SECRET_0 ^ size, high ^ _HASH_SECRET_1 );
+}
+#define hash_bytes( BYTES, SIZE, SEED... ) _hash_bytes( BYTES, SIZE, DEFAULT( 0, SEED ) )
+
+#pragma endregion hash
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - crc
+
+// CRC32C (Castagnoli) with SSE4.2 / ARMv8 crc32 instructions, interleaved over 3 streams to
+// cover the instruction latency; chains as `crc32c( b, size_b, crc32c( a, size_a ) )`
+
+////////////////////////////////
+#pragma region | crc / hidden
+
+#define _CRC_POLY 0x82F63B78u
+#define _CRC_STREAM 4096
+#define _CRC_SHIFT_1 0x35D73A62u
+#define _CRC_SHIFT_2 0x28461564u
+
+perm n4 const _crc_table[ 256 ] =
+{
+	0x00000000, 0xF26B8303, 0xE13B70F7, 0x1350F3F4, 0xC79A971F, 0x35F1141C, 0x26A1E7E8, 0xD4CA64EB,
+	0x8AD958CF, 0x78B2DBCC, 0x6BE22838, 0x9989AB3B, 0x4D43CFD0, 0xBF284CD3, 0xAC78BF27, 0x5E133C24,
+	0x105EC76F, 0xE235446C, 0xF165B798, 0x030E349B, 0xD7C45070, 0x25AFD373, 0x36FF2087, 0xC494A384,
+	0x9A879FA0, 0x68EC1CA3, 0x7BBCEF57, 0x89D76C54, 0x5D1D08BF, 0xAF768BBC, 0xBC267848, 0x4E4DFB4B,
+	0x20BD8EDE, 0xD2D60DDD, 0xC186FE29, 0x33ED7D2A, 0xE72719C1, 0x154C9AC2, 0x061C6936, 0xF477EA35,
+	0xAA64D611, 0x580F5512, 0x4B5FA6E6, 0xB93425E5, 0x6DFE410E, 0x9F95C20D, 0x8CC531F9, 0x7EAEB2FA,
+	0x30E349B1, 0xC288CAB2, 0xD1D83946, 0x23B3BA45, 0xF779DEAE, 0x05125DAD, 0x1642AE59, 0xE4292D5A,
+	0xBA3A117E, 0x4851927D, 0x5B016189, 0xA96AE28A, 0x7DA08661, 0x8FCB0562, 0x9C9BF696, 0x6EF07595,
+	0x417B1DBC, 0xB3109EBF, 0xA0406D4B, 0x522BEE48, 0x86E18AA3, 0x748A09A0, 0x67DAFA54, 0x95B17957,
+	0xCBA24573, 0x39C9C670, 0x2A993584, 0xD8F2B687, 0x0C38D26C, 0xFE53516F, 0xED03A29B, 0x1F682198,
+	0x5125DAD3, 0xA34E59D0, 0xB01EAA24, 0x42752927, 0x96BF4DCC, 0x64D4CECF, 0x77843D3B, 0x85EFBE38,
+	0xDBFC821C, 0x2997011F, 0x3AC7F2EB, 0xC8AC71E8, 0x1C661503, 0xEE0D9600, 0xFD5D65F4, 0x0F36E6F7,
+	0x61C69362, 0x93AD1061, 0x80FDE395, 0x72966096, 0xA65C047D, 0x5437877E, 0x4767748A, 0xB50CF789,
+	0xEB1FCBAD, 0x197448AE, 0x0A24BB5A, 0xF84F3859, 0x2C855CB2, 0xDEEEDFB1, 0xCDBE2C45, 0x3FD5AF46,
+	0x7198540D, 0x83F3D70E, 0x90A324FA, 0x62C8A7F9, 0xB602C312, 0x44694011, 0x5739B3E5, 0xA55230E6,
+	0xFB410CC2, 0x092A8FC1, 0x1A7A7C35, 0xE811FF36, 0x3CDB9BDD, 0xCEB018DE, 0xDDE0EB2A, 0x2F8B6829,
+	0x82F63B78, 0x709DB87B, 0x63CD4B8F, 0x91A6C88C, 0x456CAC67, 0xB7072F64, 0xA457DC90, 0x563C5F93,
+	0x082F63B7, 0xFA44E0B4, 0xE9141340, 0x1B7F9043, 0xCFB5F4A8, 0x3DDE77AB, 0x2E8E845F, 0xDCE5075C,
+	0x92A8FC17, 0x60C37F14, 0x73938CE0, 0x81F80FE3, 0x55326B08, 0xA759E80B, 0xB4091BFF, 0x466298FC,
+	0x1871A4D8, 0xEA1A27DB, 0xF94AD42F, 0x0B21572C, 0xDFEB33C7, 0x2D80B0C4, 0x3ED04330, 0xCCBBC033,
+	0xA24BB5A6, 0x502036A5, 0x4370C551, 0xB11B4652, 0x65D122B9, 0x97BAA1BA, 0x84EA524E, 0x7681D14D,
+	0x2892ED69, 0xDAF96E6A, 0xC9A99D9E, 0x3BC21E9D, 0xEF087A76, 0x1D63F975, 0x0E330A81, 0xFC588982,
+	0xB21572C9, 0x407EF1CA, 0x532E023E, 0xA145813D, 0x758FE5D6, 0x87E466D5, 0x94B49521, 0x66DF1622,
+	0x38CC2A06, 0xCAA7A905, 0xD9F75AF1, 0x2B9CD9F2, 0xFF56BD19, 0x0D3D3E1A, 0x1E6DCDEE, 0xEC064EED,
+	0xC38D26C4, 0x31E6A5C7, 0x22B65633, 0xD0DDD530, 0x0417B1DB, 0xF67C32D8, 0xE52CC12C, 0x1747422F,
+	0x49547E0B, 0xBB3FFD08, 0xA86F0EFC, 0x5A048DFF, 0x8ECEE914, 0x7CA56A17, 0x6FF599E3, 0x9D9E1AE0,
+	0xD3D3E1AB, 0x21B862A8, 0x32E8915C, 0xC083125F, 0x144976B4, 0xE622F5B7, 0xF5720643, 0x07198540,
+	0x590AB964, 0xAB613A67, 0xB831C993, 0x4A5A4A90, 0x9E902E7B, 0x6CFBAD78, 0x7FAB5E8C, 0x8DC0DD8F,
+	0xE330A81A, 0x115B2B19, 0x020BD8ED, 0xF0605BEE, 0x24AA3F05, 0xD6C1BC06, 0xC5914FF2, 0x37FACCF1,
+	0x69E9F0D5, 0x9B8273D6, 0x88D28022, 0x7AB90321, 0xAE7367CA, 0x5C18E4C9, 0x4F48173D, 0xBD23943E,
+	0xF36E6F75, 0x0105EC76, 0x12551F82, 0xE03E9C81, 0x34F4F86A, 0xC69F7B69, 0xD5CF889D, 0x27A40B9E,
+	0x79B737BA, 0x8BDCB4B9, 0x988C474D, 0x6AE7C44E, 0xBE2DA0A5, 0x4C4623A6, 0x5F16D052, 0xAD7D5351
+};
+
+#if SIMD_SSE4_2
+	#define _CRC_HARDWARE 1
+	#define _crc_n8( CRC, V ) n4( _mm_crc32_u64( CRC, V ) )
+	#define _crc_n1( CRC, V ) _mm_crc32_u8( CRC, V )
+#elif SIMD_ARM_CRC
+	#define _CRC_HARDWARE 1
+	#define _crc_n8( CRC, V ) __crc32cd( CRC, V )
+	#define _crc_n1( CRC, V ) __crc32cb( CRC, V )
+#else
+	#define _CRC_HARDWARE 0
+	#define _crc_n1( CRC, V ) ( _crc_table[ ( ( CRC ) ^ ( V ) ) & 0xFF ] ^ ( ( CRC ) >> 8 ) )
+#endif
+
+// A * B mod P, reflected; multiplying by x^( 8 * N ) mod P appends N zero bytes
+embed n4 _crc_multiply( n4 a, n4 b )
+{
+	temp n4 product = 0;
+	iter( i, 32 )
+	{
+		if( a & 0x80000000u ) product ^= b;
+		a <<= 1;
+		b = ( b >> 1 ) ^ pick( b & 1, _CRC_POLY, 0 );
+	}
+	out product;
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | crc / visible
+
+embed n4 _crc32c( anon const ref const bytes, n8 size, n4 const previous )
+{
+	temp n1 const ref p = bytes;
+	temp n4 crc = ~previous;
+	#if _CRC_HARDWARE
+		while( size and ( to( n8, p ) & 7 ) )
+		{
+			crc = _crc_n1( crc, val_of( p++ ) );
+			--size;
+		}
+		while( size >= _CRC_STREAM * 3 )
+		{
+			temp n4 a = crc;
+			temp n4 b = 0;
+			temp n4 c = 0;
+			for( temp n8 i = 0; i < _CRC_STREAM; i += 8 )
+			{
+				a = _crc_n8( a, _hash_read_n8( p + i ) );
+				b = _crc_n8( b, _hash_read_n8( p + _CRC_STREAM + i ) );
+				c = _crc_n8( c, _hash_read_n8( p + _CRC_STREAM * 2 + i ) );
+			}
+			crc = _crc_multiply( _CRC_SHIFT_2, a ) ^ _crc_multiply( _CRC_SHIFT_1, b ) ^ c;
+			p += _CRC_STREAM * 3;
+			size -= _CRC_STREAM * 3;
+		}
+		while( size >= 8 )
+		{
+			crc = _crc_n8( crc, _hash_read_n8( p ) );
+			p += 8;
+			size -= 8;
+		}
+	#endif
+	while( size-- ) crc = _crc_n1( crc, val_of( p++ ) );
+	out ~crc;
+}
+#define crc32c( BYTES, SIZE, PREVIOUS... ) _crc32c( BYTES, SIZE, DEFAULT( 0, PREVIOUS ) )
+
+#pragma endregion visible
+///
+
+#pragma endregion crc
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - content
+
+// a 64 / 128-bit content hash for large inputs, in the XXH3 style (not XXH3-compatible): 8 lanes
+// take 64-byte stripes as 32x32 products plus the neighbour lane, scrambled every 1 KiB block,
+// with SSE2 / AVX2 doing whole stripes; up to _HASH_SHORT_MAX bytes it is `hash_bytes`.
+// `hash_stream_*` gives the same result for the same bytes fed in any pieces
+
+type( hash_128 )
+{
+	n8 low;
+	n8 high;
+};
+
+////////////////////////////////
+#pragma region | content / hidden
+
+#define _HASH_STRIPE 64
+#define _HASH_BLOCK 1024
+#define _HASH_BLOCK_STRIPES ( _HASH_BLOCK / _HASH_STRIPE )
+#define _HASH_SHORT_MAX 240
+#define _HASH_SECRET_COUNT 24
+#define _HASH_PRIME_32 0x9E3779B1ull
+#define _HASH_PRIME_64_1 0x9E3779B185EBCA87ull
+#define _HASH_PRIME_64_2 0xC2B2AE3D27D4EB4Full
+
+perm n8 const _hash_secret[ _HASH_SECRET_COUNT ] =
+{
+	0x6E789E6AA1B965F4ull, 0x06C45D188009454Full, 0xF88BB8A8724C81ECull, 0x1B39896A51A8749Bull,
+	0x53CB9F0C747EA2EAull, 0x2C829ABE1F4532E1ull, 0xC584133AC916AB3Cull, 0x3EE5789041C98AC3ull,
+	0xF3B8488C368CB0A6ull, 0x657EECDD3CB13D09ull, 0xC2D326E0055BDEF6ull, 0x8621A03FE0BBDB7Bull,
+	0x8E1F7555983AA92Full, 0xB54E0F1600CC4D19ull, 0x84BB3F97971D80ABull, 0x7D29825C75521255ull,
+	0xC3CF17102B7F7F86ull, 0x3466E9A083914F64ull, 0xD81A8D2B5A4485ACull, 0xDB01602B100B9ED7ull,
+	0xA9038A921825F10Dull, 0xEDF5F1D90DCA2F6Aull, 0x54496AD67BD2634Cull, 0xDD7C01D4F5407269ull
+};
+
+// stripe s uses secret[ s .. s + 7 ], scrambles [ 16 .. 23 ], the last stripe [ 13 .. 20 ],
+// and the merges [ 3 .. 10 ] and [ 11 .. 18 ]
+#define _HASH_SECRET_SCRAMBLE 16
+#define _HASH_SECRET_LAST 13
+#define _HASH_SECRET_LOW 3
+#define _HASH_SECRET_HIGH 11
+
+#if SIMD_AVX2
+	#define _HASH_LANES 4
+	#define _hash_load( REF ) _mm256_loadu_si256( to( __m256i const ref, REF ) )
+	#define _hash_store( REF, V ) _mm256_storeu_si256( to( __m256i ref, REF ), V )
+	#define _hash_splat( V ) _mm256_set1_epi64x( V )
+	#define _hash_xor( A, B ) _mm256_xor_si256( A, B )
+	#define _hash_add( A, B ) _mm256_add_epi64( A, B )
+	#define _hash_mul_32( A, B ) _mm256_mul_epu32( A, B )
+	#define _hash_right( A, N ) _mm256_srli_epi64( A, N )
+	#define _hash_left( A, N ) _mm256_slli_epi64( A, N )
+	#define _hash_swap( A ) _mm256_shuffle_epi32( A, _MM_SHUFFLE( 1, 0, 3, 2 ) )
+#elif SIMD_SSE2
+	#define _HASH_LANES 2
+	#define _hash_load( REF ) _mm_loadu_si128( to( __m128i const ref, REF ) )
+	#define _hash_store( REF, V ) _mm_storeu_si128( to( __m128i ref, REF ), V )
+	#define _hash_splat( V ) _mm_set1_epi64x( V )
+	#define _hash_xor( A, B ) _mm_xor_si128( A, B )
+	#define _hash_add( A, B ) _mm_add_epi64( A, B )
+	#define _hash_mul_32( A, B ) _mm_mul_epu32( A, B )
+	#define _hash_right( A, N ) _mm_srli_epi64( A, N )
+	#define _hash_left( A, N ) _mm_slli_epi64( A, N )
+	#define _hash_swap( A ) _mm_shuffle_epi32( A, _MM_SHUFFLE( 1, 0, 3, 2 ) )
+#else
+	#define _HASH_LANES 0
+#endif
+
+fn _hash_wide_init( n8 ref const acc )
+{
+	acc[ 0 ] = 0xC2B2AE3Dull;
+	acc[ 1 ] = _HASH_PRIME_64_1;
+	acc[ 2 ] = _HASH_PRIME_64_2;
+	acc[ 3 ] = 0x165667B19E3779F9ull;
+	acc[ 4 ] = 0x85EBCA77C2B2AE63ull;
+	acc[ 5 ] = 0x85EBCA77ull;
+	acc[ 6 ] = 0x27D4EB2F165667C5ull;
+	acc[ 7 ] = _HASH_PRIME_32;
+}
+
+fn _hash_wide_seed( n8 ref const secret, n8 const seed )
+{
+	iter( i, _HASH_SECRET_COUNT ) secret[ i ] = _hash_secret[ i ] + pick( i & 1, -seed, seed );
+}
+
+fn _hash_wide_stripes( n8 ref const acc, n1 const ref const bytes, n8 const stripes, n8 const ref const secret )
+{
+	#if _HASH_LANES
+		type_of( _hash_splat( 0 ) ) lanes[ 8 / _HASH_LANES ];
+		iter( v, 8 / _HASH_LANES ) lanes[ v ] = _hash_load( acc + v * _HASH_LANES );
+		iter( s, stripes )
+		{
+			iter( v, 8 / _HASH_LANES )
+			{
+				temp type_of( _hash_splat( 0 ) ) const data = _hash_load( bytes + s * _HASH_STRIPE + v * _HASH_LANES * 8 );
+				temp type_of( _hash_splat( 0 ) ) const keyed = _hash_xor( data, _hash_load( secret + s + v * _HASH_LANES ) );
+				lanes[ v ] = _hash_add( lanes[ v ], _hash_add( _hash_mul_32( keyed, _hash_right( keyed, 32 ) ), _hash_swap( data ) ) );
+			}
+		}
+		iter( v, 8 / _HASH_LANES ) _hash_store( acc + v * _HASH_LANES, lanes[ v ] );
+	#else
+		iter( s, stripes )
+		{
+			iter( i, 8 )
+			{
+				temp n8 const data = _hash_read_n8( bytes + s * _HASH_STRIPE + i * 8 );
+				temp n8 const keyed = data ^ secret[ s + i ];
+				acc[ i ^ 1 ] += data;
+				acc[ i ] += ( keyed & 0xFFFFFFFFull ) * ( keyed >> 32 );
+			}
+		}
+	#endif
+}
+
+fn _hash_wide_scramble( n8 ref const acc, n8 const ref const secret )
+{
+	#if _HASH_LANES
+		temp type_of( _hash_splat( 0 ) ) const prime = _hash_splat( _HASH_PRIME_32 );
+		iter( v, 8 / _HASH_LANES )
+		{
+			temp type_of( _hash_splat( 0 ) ) lane = _hash_load( acc + v * _HASH_LANES );
+			lane = _hash_xor( _hash_xor( lane, _hash_right( lane, 47 ) ), _hash_load( secret + v * _HASH_LANES ) );
+			lane = _hash_add( _hash_mul_32( lane, prime ), _hash_left( _hash_mul_32( _hash_right( lane, 32 ), prime ), 32 ) );
+			_hash_store( acc + v * _HASH_LANES, lane );
+		}
+	#else
+		iter( i, 8 ) acc[ i ] = ( acc[ i ] ^ ( acc[ i ] >> 47 ) ^ secret[ i ] ) * _HASH_PRIME_32;
+	#endif
+}
+
+fn _hash_wide_block( n8 ref const acc, n1 const ref const bytes, n8 const ref const secret )
+{
+	_hash_wide_stripes( acc, bytes, _HASH_BLOCK_STRIPES, secret );
+	_hash_wide_scramble( acc, secret + _HASH_SECRET_SCRAMBLE );
+}
+
+// BLOCK holds the final 1 .. _HASH_BLOCK bytes, LAST_STRIPE the final _HASH_STRIPE bytes
+fn _hash_wide_last( n8 ref const acc, n1 const ref const block, n8 const block_size, n1 const ref const last_stripe, n8 const ref const secret )
+{
+	_hash_wide_stripes( acc, block, ( block_size - 1 ) / _HASH_STRIPE, secret );
+	_hash_wide_stripes( acc, last_stripe, 1, secret + _HASH_SECRET_LAST );
+}
+
+embed n8 _hash_wide_merge( n8 const ref const acc, n8 const ref const secret, n8 result )
+{
+	iter( i, 4 ) result += hash_mix( acc[ i * 2 ] ^ secret[ i * 2 ], acc[ i * 2 + 1 ] ^ secret[ i * 2 + 1 ] );
+	result ^= result >> 37;
+	result *= 0x165667919E3779F9ull;
+	out result ^ ( result >> 32 );
+}
+
+embed hash_128 _hash_wide_result( n8 const ref const acc, n8 const ref const secret, n8 const size )
+{
+	out make( hash_128,
+		_hash_wide_merge( acc, secret + _HASH_SECRET_LOW, size * _HASH_PRIME_64_1 ),
+		_hash_wide_merge( acc, secret + _HASH_SECRET_HIGH, ~( size * _HASH_PRIME_64_2 ) )
+	);
+}
+
+fn _hash_wide_long( n8 ref const acc, n8 ref const secret, n1 const ref const bytes, n8 const size, n8 const seed )
+{
+	_hash_wide_seed( secret, seed );
+	_hash_wide_init( acc );
+	temp n8 const blocks = ( size - 1 ) / _HASH_BLOCK;
+	iter( b, blocks ) _hash_wide_block( acc, bytes + b * _HASH_BLOCK, secret );
+	_hash_wide_last( acc, bytes + blocks * _HASH_BLOCK, size - blocks * _HASH_BLOCK, bytes + size - _HASH_STRIPE, secret );
+}
+
+embed hash_128 _hash_short_128( anon const ref const bytes, n8 const size, n8 const seed )
+{
+	out make( hash_128, _hash_bytes( bytes, size, seed ), _hash_bytes( bytes, size, seed ^ _HASH_PRIME_64_2 ) );
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | content / visible
+
+embed n8 _hash_content( anon const ref const bytes, n8 const size, n8 const seed )
+{
+	out_if( size <= _HASH_SHORT_MAX ) _hash_bytes( bytes, size, seed );
+	n8 acc[ 8 ];
+	n8 secret[ _HASH_SECRET_COUNT ];
+	_hash_wide_long( acc, secret, bytes, size, seed );
+	out _hash_wide_merge( acc, secret + _HASH_SECRET_LOW, size * _HASH_PRIME_64_1 );
+}
+#define hash_content( BYTES, SIZE, SEED... ) _hash_content( BYTES, SIZE, DEFAULT( 0, SEED ) )
+
+embed hash_128 _hash_content_128( anon const ref const bytes, n8 const size, n8 const seed )
+{
+	out_if( size <= _HASH_SHORT_MAX ) _hash_short_128( bytes, size, seed );
+	n8 acc[ 8 ];
+	n8 secret[ _HASH_SECRET_COUNT ];
+	_hash_wide_long( acc, secret, bytes, size, seed );
+	out _hash_wide_result( acc, secret, size );
+}
+#define hash_content_128( BYTES, SIZE, SEED... ) _hash_content_128( BYTES, SIZE, DEFAULT( 0, SEED ) )
+
+#define hash_128_match( A, B ) ( ( A ).low is ( B ).low and ( A ).high is ( B ).high )
+
+// the last _HASH_BLOCK bytes are held back until more arrive or `hash_stream_final`, with the
+// _HASH_STRIPE bytes before them kept for a final stripe that reaches back
+type_from( variant hash_stream ) hash_stream;
+variant hash_stream
+{
+	n8 acc[ 8 ];
+	n8 secret[ _HASH_SECRET_COUNT ];
+	n1 bytes[ _HASH_STRIPE + _HASH_BLOCK ];
+	n8 buffered;
+	n8 size;
+	n8 seed;
+};
+
+#define _hash_stream_buffer( STREAM ) ( ( STREAM )->bytes + _HASH_STRIPE )
+
+fn hash_stream_init( hash_stream ref const stream, n8 const seed )
+{
+	_hash_wide_init( stream->acc );
+	_hash_wide_seed( stream->secret, seed );
+	stream->buffered = 0;
+	stream->size = 0;
+	stream->seed = seed;
+}
+
+fn hash_stream_update( hash_stream ref const stream, anon const ref const bytes, n8 size )
+{
+	temp n1 const ref p = bytes;
+	temp n1 ref const buffer = _hash_stream_buffer( stream );
+	temp n1 const ref tail = buffer + _HASH_BLOCK - _HASH_STRIPE;
+	stream->size += size;
+	if( stream->buffered + size <= _HASH_BLOCK )
+	{
+		bytes_copy( buffer + stream->buffered, p, size );
+		stream->buffered += size;
+		out;
+	}
+	if( stream->buffered )
+	{
+		temp n8 const fill = _HASH_BLOCK - stream->buffered;
+		bytes_copy( buffer + stream->buffered, p, fill );
+		_hash_wide_block( stream->acc, buffer, stream->secret );
+		p += fill;
+		size -= fill;
+	}
+	while( size > _HASH_BLOCK )
+	{
+		_hash_wide_block( stream->acc, p, stream->secret );
+		p += _HASH_BLOCK;
+		size -= _HASH_BLOCK;
+		tail = p - _HASH_STRIPE;
+	}
+	bytes_copy( stream->bytes, tail, _HASH_STRIPE );
+	bytes_copy( buffer, p, size );
+	stream->buffered = size;
+}
+
+embed n8 hash_stream_final( hash_stream const ref const stream )
+{
+	temp n1 const ref const buffer = _hash_stream_buffer( stream );
+	out_if( stream->size <= _HASH_SHORT_MAX ) _hash_bytes( buffer, stream->size, stream->seed );
+	n8 acc[ 8 ];
+	bytes_copy( acc, stream->acc, size_of( acc ) );
+	_hash_wide_last( acc, buffer, stream->buffered, buffer + stream->buffered - _HASH_STRIPE, stream->secret );
+	out _hash_wide_merge( acc, stream->secret + _HASH_SECRET_LOW, stream->size * _HASH_PRIME_64_1 );
+}
+
+embed hash_128 hash_stream_final_128( hash_stream const ref const stream )
+{
+	temp n1 const ref const buffer = _hash_stream_buffer( stream );
+	out_if( stream->size <= _HASH_SHORT_MAX ) _hash_short_128( buffer, stream->size, stream->seed );
+	n8 acc[ 8 ];
+	bytes_copy( acc, stream->acc, size_of( acc ) );
+	_hash_wide_last( acc, buffer, stream->buffered, buffer + stream->buffered - _HASH_STRIPE, stream->secret );
+	out _hash_wide_result( acc, stream->secret, stream->size );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion content
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - map
+
+// open addressing with one control byte per slot, probed 16 at a time:
+// empty 0x80, deleted 0xFE, full = low 7 hash bits; the first group is mirrored past the end
+// so any group load is contiguous
+
+////////////////////////////////
+#pragma region | map / hidden
+
+#define _HASH_GROUP 16
+#define _HASH_EMPTY n1( 0x80 )
+#define _HASH_DELETED n1( 0xFE )
+#define _HASH_MIN_CAPACITY 16
+#define _hash_h1( HASH ) ( ( HASH ) >> 7 )
+#define _hash_h2( HASH ) n1( ( HASH ) & 0x7F )
+
+embed n4 _hash_group_match( n1 const ref const ctrl, n1 const tag )
+{
+	#if SIMD_SSE2
+		out n4( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( to( __m128i const ref, ctrl ) ), _mm_set1_epi8( to( i1, tag ) ) ) ) );
+	#else
+		temp n4 mask = 0;
+		iter( i, _HASH_GROUP ) mask |= n4( ctrl[ i ] is tag ) << i;
+		out mask;
+	#endif
+}
+
+// empty or deleted
+embed n4 _hash_group_free( n1 const ref const ctrl )
+{
+	#if SIMD_SSE2
+		out n4( _mm_movemask_epi8( _mm_loadu_si128( to( __m128i const ref, ctrl ) ) ) );
+	#else
+		temp n4 mask = 0;
+		iter( i, _HASH_GROUP ) mask |= n4( ctrl[ i ] >> 7 ) << i;
+		out mask;
+	#endif
+}
+
+fn _hash_set_ctrl( n1 ref const ctrl, n8 const capacity, n8 const index, n1 const tag )
+{
+	ctrl[ index ] = tag;
+	if( index < _HASH_GROUP ) ctrl[ capacity + index ] = tag;
+}
+
+embed n8 _hash_find_free( n1 const ref const ctrl, n8 const capacity, n8 const hash )
+{
+	temp n8 const mask = capacity - 1;
+	temp n8 pos = _hash_h1( hash ) & mask;
+	temp n8 step = 0;
+	loop
+	{
+		temp n4 const free = _hash_group_free( ctrl + pos );
+		out_if( free ) ( pos + n4_ctz( free ) ) & mask;
+		step += _HASH_GROUP;
+		pos = ( pos + step ) & mask;
+	}
+}
+
+embed n1 ref _hash_create_ctrl( n8 const capacity )
+{
+	temp n1 ref const ctrl = to( n1 ref, _alloc( capacity + _HASH_GROUP ) );
+	if_something( ctrl ) bytes_fill( ctrl, _HASH_EMPTY, capacity + _HASH_GROUP );
+	out ctrl;
+}
+
+embed n8 _hash_capacity_for( n8 const count )
+{
+	temp n8 capacity = _HASH_MIN_CAPACITY;
+	while( capacity * 7 < count * 8 ) capacity <<= 1;
+	out capacity;
+}
+
+// KEY_FIELDS / KEY_INPUTS / KEY_ARGS are parenthesized lists
+#define _GEN_HASH_MAP( NAME, VALUE, KEY_FIELDS, KEY_INPUTS, KEY_ARGS, HASH_EXPR, SLOT_HASH, SLOT_MATCH, SLOT_STORE )\
+	type_from( variant NAME##_slot ) NAME##_slot;\
+	variant NAME##_slot\
+	{\
+		EVAL KEY_FIELDS;\
+		VALUE value;\
+	};\
+	type( NAME )\
+	{\
+		n1 ref ctrl;\
+		NAME##_slot ref slots;\
+		n8 capacity;\
+		n8 count;\
+		n8 tombstones;\
+	};\
+	fn NAME##_delete( NAME ref const map )\
+	{\
+		os_delete_ref( map->ctrl );\
+		os_delete_ref( map->slots );\
+		map->capacity = map->count = map->tombstones = 0;\
+	}\
+	embed flag NAME##_resize( NAME ref const map, n8 const min_count )\
+	{\
+		temp n8 const capacity = _hash_capacity_for( MAX( min_count, map->count ) );\
+		temp n1 ref const ctrl = _hash_create_ctrl( capacity );\
+		temp NAME##_slot ref const slots = os_create_ref( NAME##_slot, capacity );\
+		if( ctrl is nothing or slots is nothing )\
+		{\
+			if_something( ctrl ) _free( ctrl );\
+			if_something( slots ) _free( slots );\
+			out no;\
+		}\
+		iter( i, map->capacity )\
+		{\
+			next_if( map->ctrl[ i ] & 0x80 );\
+			temp NAME##_slot const ref const slot = map->slots + i;\
+			temp n8 const hash = SLOT_HASH( slot );\
+			temp n8 const index = _hash_find_free( ctrl, capacity, hash );\
+			_hash_set_ctrl( ctrl, capacity, index, _hash_h2( hash ) );\
+			slots[ index ] = val_of( slot );\
+		}\
+		if_something( map->ctrl ) _free( map->ctrl );\
+		if_something( map->slots ) _free( map->slots );\
+		map->ctrl = ctrl;\
+		map->slots = slots;\
+		map->capacity = capacity;\
+		map->tombstones = 0;\
+		out yes;\
+	}\
+	embed NAME NAME##_create( n8 const expected_count )\
+	{\
+		NAME map = { 0 };\
+		NAME##_resize( ref_of( map ), expected_count );\
+		out map;\
+	}\
+	embed n8 NAME##_find_index( NAME const ref const map, EVAL KEY_INPUTS )\
+	{\
+		out_if( map->count is 0 ) n8_max_val;\
+		temp n8 const hash = HASH_EXPR;\
+		temp n1 const tag = _hash_h2( hash );\
+		temp n8 const mask = map->capacity - 1;\
+		temp n8 pos = _hash_h1( hash ) & mask;\
+		temp n8 step = 0;\
+		loop\
+		{\
+			temp n4 match = _hash_group_match( map->ctrl + pos, tag );\
+			while( match )\
+			{\
+				temp n8 const index = ( pos + n4_ctz( match ) ) & mask;\
+				temp NAME##_slot const ref const slot = map->slots + index;\
+				out_if( SLOT_MATCH( slot ) ) index;\
+				match &= match - 1;\
+			}\
+			out_if( _hash_group_match( map->ctrl + pos, _HASH_EMPTY ) ) n8_max_val;\
+			step += _HASH_GROUP;\
+			pos = ( pos + step ) & mask;\
+		}\
+	}\
+	embed VALUE ref NAME##_find( NAME const ref const map, EVAL KEY_INPUTS )\
+	{\
+		temp n8 const index = NAME##_find_index( map, EVAL KEY_ARGS );\
+		out pick( index is n8_max_val, nothing, ref_of( map->slots[ index ].value ) );\
+	}\
+	embed VALUE ref NAME##_insert( NAME ref const map, EVAL KEY_INPUTS )\
+	{\
+		temp n8 index = NAME##_find_index( map, EVAL KEY_ARGS );\
+		out_if( index isnt n8_max_val ) ref_of( map->slots[ index ].value );\
+		if( ( map->count + map->tombstones + 1 ) * 8 > map->capacity * 7 )\
+		{\
+			out_if( not NAME##_resize( map, ( map->count + 1 ) * 2 ) ) nothing;\
+		}\
+		temp n8 const hash = HASH_EXPR;\
+		index = _hash_find_free( map->ctrl, map->capacity, hash );\
+		map->tombstones -= ( map->ctrl[ index ] is _HASH_DELETED );\
+		_hash_set_ctrl( map->ctrl, map->capacity, index, _hash_h2( hash ) );\
+		temp NAME##_slot ref const slot = map->slots + index;\
+		bytes_clear( slot, size_of( NAME##_slot ) );\
+		SLOT_STORE( slot );\
+		++map->count;\
+		out ref_of( slot->value );\
+	}\
+	embed flag NAME##_set( NAME ref const map, EVAL KEY_INPUTS, VALUE const value )\
+	{\
+		temp VALUE ref const value_ref = NAME##_insert( map, EVAL KEY_ARGS );\
+		out_if_nothing( value_ref ) no;\
+		val_of( value_ref ) = value;\
+		out yes;\
+	}\
+	embed flag NAME##_remove( NAME ref const map, EVAL KEY_INPUTS )\
+	{\
+		temp n8 const index = NAME##_find_index( map, EVAL KEY_ARGS );\
+		out_if( index is n8_max_val ) no;\
+		_hash_set_ctrl( map->ctrl, map->capacity, index, _HASH_DELETED );\
+		--map->count;\
+		++map->tombstones;\
+		out yes;\
+	}
+
+#define _HASH_N8_SLOT_HASH( SLOT ) hash_n8( ( SLOT )->key )
+#define _HASH_N8_SLOT_MATCH( SLOT ) ( ( SLOT )->key is key )
+#define _HASH_N8_SLOT_STORE( SLOT ) ( SLOT )->key = key
+
+#define _HASH_BYTES_SLOT_HASH( SLOT ) ( ( SLOT )->hash )
+#define _HASH_BYTES_SLOT_MATCH( SLOT ) ( ( SLOT )->hash is hash and ( SLOT )->key_size is key_size and bytes_compare( ( SLOT )->key, key, key_size ) is 0 )
+#define _HASH_BYTES_SLOT_STORE( SLOT ) START_DEF { ( SLOT )->key = key; ( SLOT )->key_size = key_size; ( SLOT )->hash = hash; } END_DEF
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | map / visible
+
+// NAME_create( expected_count ), NAME_find / _insert (returns value ref) / _set / _remove, NAME_delete
+// byte keys are not copied: keep them alive, or intern them first
+
+#define hash_map_n8( NAME, VALUE )\
+	_GEN_HASH_MAP( NAME, VALUE, ( n8 key ), ( n8 const key ), ( key ), hash_n8( key ),\
+		_HASH_N8_SLOT_HASH, _HASH_N8_SLOT_MATCH, _HASH_N8_SLOT_STORE )
+
+#define hash_map_bytes( NAME, VALUE )\
+	_GEN_HASH_MAP( NAME, VALUE, ( byte const ref key; n8 key_size; n8 hash ), ( byte const ref const key, n8 const key_size ), ( key, key_size ), hash_bytes( key, key_size ),\
+		_HASH_BYTES_SLOT_HASH, _HASH_BYTES_SLOT_MATCH, _HASH_BYTES_SLOT_STORE )
+
+#define iter_hash_map( POS_NAME, MAP ) iter( POS_NAME, ( MAP ).capacity ) if( not( ( MAP ).ctrl[ POS_NAME ] & 0x80 ) )
+
+#pragma endregion visible
+///
+
+#pragma endregion map
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - intern
+
+// each distinct byte string gets a stable n4 id; the bytes are stored once, back to back with an eof,
+// in one growing arena, so `intern_get` refs are valid until the next `intern_add`
+
+#define intern_none n4_max_val
+
+type( intern_table )
+{
+	byte ref bytes;
+	n8 bytes_size;
+	n8 bytes_capacity;
+	n8 ref offsets;
+	n8 ref hashes;
+	n4 count;
+	n4 ids_capacity;
+	n1 ref ctrl;
+	n4 ref slots;
+	n8 capacity;
+};
+
+#define intern_get( TABLE_REF, ID ) to( byte const ref, ( TABLE_REF )->bytes + ( TABLE_REF )->offsets[ ID ] )
+#define intern_size( TABLE_REF, ID ) ( ( TABLE_REF )->offsets[ ( ID ) + 1 ] - ( TABLE_REF )->offsets[ ID ] - 1 )
+
+fn intern_delete( intern_table ref const table )
+{
+	os_delete_ref( table->bytes );
+	os_delete_ref( table->offsets );
+	os_delete_ref( table->hashes );
+	os_delete_ref( table->ctrl );
+	os_delete_ref( table->slots );
+	bytes_clear( table, size_of( intern_table ) );
+}
+
+embed n4 _intern_find( intern_table const ref const table, byte const ref const bytes, n8 const size, n8 const hash )
+{
+	out_if( table->count is 0 ) intern_none;
+	temp n1 const tag = _hash_h2( hash );
+	temp n8 const mask = table->capacity - 1;
+	temp n8 pos = _hash_h1( hash ) & mask;
+	temp n8 step = 0;
+	loop
+	{
+		temp n4 match = _hash_group_match( table->ctrl + pos, tag );
+		while( match )
+		{
+			temp n4 const id = table->slots[ ( pos + n4_ctz( match ) ) & mask ];
+			if( table->hashes[ id ] is hash and intern_size( table, id ) is size and bytes_compare( intern_get( table, id ), bytes, size ) is 0 )
+			{
+				out id;
+			}
+			match &= match - 1;
+		}
+		out_if( _hash_group_match( table->ctrl + pos, _HASH_EMPTY ) ) intern_none;
+		step += _HASH_GROUP;
+		pos = ( pos + step ) & mask;
+	}
+}
+
+#define intern_find( TABLE_REF, BYTES, SIZE ) _intern_find( TABLE_REF, BYTES, SIZE, hash_bytes( BYTES, SIZE ) )
+
+embed flag _intern_grow_index( intern_table ref const table )
+{
+	temp n8 const capacity = _hash_capacity_for( n8( table->count + 1 ) * 2 );
+	temp n1 ref const ctrl = _hash_create_ctrl( capacity );
+	temp n4 ref const slots = os_create_ref( n4, capacity );
+	if( ctrl is nothing or slots is nothing )
+	{
+		if_something( ctrl ) _free( ctrl );
+		if_something( slots ) _free( slots );
+		out no;
+	}
+	iter( id, table->count )
+	{
+		temp n8 const index = _hash_find_free( ctrl, capacity, table->hashes[ id ] );
+		_hash_set_ctrl( ctrl, capacity, index, _hash_h2( table->hashes[ id ] ) );
+		slots[ index ] = n4( id );
+	}
+	if_something( table->ctrl ) _free( table->ctrl );
+	if_something( table->slots ) _free( table->slots );
+	table->ctrl = ctrl;
+	table->slots = slots;
+	table->capacity = capacity;
+	out yes;
+}
+
+embed n4 intern_add( intern_table ref const table, byte const ref const bytes, n8 const size )
+{
+	temp n8 const hash = hash_bytes( bytes, size );
+	temp n4 const found = _intern_find( table, bytes, size, hash );
+	out_if( found isnt intern_none ) found;
+
+	if( ( n8( table->count ) + 1 ) * 8 > table->capacity * 7 )
+	{
+		out_if( not _intern_grow_index( table ) ) intern_none;
+	}
+	if( table->count + 1 >= table->ids_capacity )
+	{
+		temp n4 const ids_capacity = MAX( table->ids_capacity * 2, 64 );
+		temp n8 ref const offsets = os_resize_ref( table->offsets, size_of( n8 ) * ( ids_capacity + 1 ), yes );
+		out_if_nothing( offsets ) intern_none;
+		table->offsets = offsets;
+		temp n8 ref const hashes = os_resize_ref( table->hashes, size_of( n8 ) * ids_capacity, yes );
+		out_if_nothing( hashes ) intern_none;
+		table->hashes = hashes;
+		table->ids_capacity = ids_capacity;
+	}
+	if( table->bytes_size + size + 1 > table->bytes_capacity )
+	{
+		temp n8 const bytes_capacity = MAX( table->bytes_capacity * 2, table->bytes_size + size + 1 );
+		temp byte ref const arena = os_resize_ref( table->bytes, bytes_capacity, yes );
+		out_if_nothing( arena ) intern_none;
+		table->bytes = arena;
+		table->bytes_capacity = bytes_capacity;
+	}
+
+	temp n4 const id = table->count++;
+	table->offsets[ id ] = table->bytes_size;
+	table->hashes[ id ] = hash;
+	bytes_copy( table->bytes + table->bytes_size, bytes, size );
+	table->bytes[ table->bytes_size + size ] = eof_byte;
+	table->bytes_size += size + 1;
+	table->offsets[ id + 1 ] = table->bytes_size;
+
+	temp n8 const index = _hash_find_free( table->ctrl, table->capacity, hash );
+	_hash_set_ctrl( table->ctrl, table->capacity, index, _hash_h2( hash ) );
+	table->slots[ index ] = id;
+	out id;
+}
+
+#pragma endregion intern
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - bloom
+
+// a blocked Bloom filter on a `bitset`: each key sets `hashes` bits inside one 512-bit block,
+// so a lookup touches one cache line; 10 bits per key gives about 1% false positives
+
+type( bloom )
+{
+	bitset bits;
+	n8 blocks;
+	n1 hashes;
+};
+
+////////////////////////////////
+#pragma region | bloom / hidden
+
+#define _BLOOM_BLOCK_BITS 512
+
+embed n8 _bloom_block( bloom const ref const filter, n8 const hash )
+{
+	n8 low;
+	out n8_mul_hi( hash, filter->blocks, ref_of( low ) ) * _BLOOM_BLOCK_BITS;
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | bloom / visible
+
+embed bloom bloom_create( n8 const expected_count, n1 const bits_per_key )
+{
+	temp n8 const blocks = MAX( ( expected_count * bits_per_key + _BLOOM_BLOCK_BITS - 1 ) / _BLOOM_BLOCK_BITS, 1 );
+	bloom filter = { .bits = bitset_create( blocks * _BLOOM_BLOCK_BITS ), .blocks = blocks };
+	filter.hashes = n1( CLAMP( ( n4( bits_per_key ) * 69 + 50 ) / 100, 1, 16 ) );
+	if_nothing( filter.bits.words ) filter.blocks = 0;
+	out filter;
+}
+
+fn bloom_delete( bloom ref const filter )
+{
+	bitset_delete( ref_of( filter->bits ) );
+	filter->blocks = 0;
+}
+
+fn bloom_clear( bloom ref const filter )
+{
+	bitset_clear_all( ref_of( filter->bits ) );
+}
+
+// keys by a 64-bit hash such as `hash_bytes` or `hash_n8`
+fn bloom_add_hash( bloom ref const filter, n8 const hash )
+{
+	out_if( filter->blocks is 0 );
+	temp n8 const block = _bloom_block( filter, hash );
+	temp n4 const step = n4( hash >> 32 ) | 1;
+	temp n4 bit = n4( hash );
+	iter( i, filter->hashes )
+	{
+		bitset_set( ref_of( filter->bits ), block + ( bit & ( _BLOOM_BLOCK_BITS - 1 ) ) );
+		bit += step;
+	}
+}
+
+// no means never added; yes means probably added
+embed flag bloom_has_hash( bloom const ref const filter, n8 const hash )
+{
+	out_if( filter->blocks is 0 ) no;
+	temp n8 const block = _bloom_block( filter, hash );
+	temp n4 const step = n4( hash >> 32 ) | 1;
+	temp n4 bit = n4( hash );
+	iter( i, filter->hashes )
+	{
+		out_if( not bitset_test( ref_of( filter->bits ), block + ( bit & ( _BLOOM_BLOCK_BITS - 1 ) ) ) ) no;
+		bit += step;
+	}
+	out yes;
+}
+
+#define bloom_add( FILTER_REF, BYTES, SIZE ) bloom_add_hash( FILTER_REF, hash_bytes( BYTES, SIZE ) )
+#define bloom_has( FILTER_REF, BYTES, SIZE ) bloom_has_hash( FILTER_REF, hash_bytes( BYTES, SIZE ) )
+
+#pragma endregion visible
+///
+
+#pragma endregion bloom
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - file
+
+// bytes over H_HASH_FILE_CHUNK hash as chunks, each by `hash_content_128` seeded with its index
+// and in parallel, then the chunk hashes seeded with the total size; the result does not depend
+// on the thread count, and `hash_content_tree` gives the same for bytes already in memory
+
+#ifndef H_HASH_FILE_CHUNK
+	#define H_HASH_FILE_CHUNK ( 4 << 20 )
+#endif
+
+////////////////////////////////
+#pragma region | file / hidden
+
+type_from( variant _hash_tree_job ) _hash_tree_job;
+variant _hash_tree_job
+{
+	n1 const ref bytes;
+	n8 size;
+	hash_128 ref hashes;
+};
+
+embed hash_128 _hash_tree_chunk( n1 const ref const bytes, n8 const size, n8 const index )
+{
+	temp n8 const begin = index * H_HASH_FILE_CHUNK;
+	out _hash_content_128( bytes + begin, pick( H_HASH_FILE_CHUNK < size - begin, H_HASH_FILE_CHUNK, size - begin ), index );
+}
+
+fn _hash_tree_job_run( anon ref const context, n8 const index )
+{
+	temp _hash_tree_job const ref const job = context;
+	job->hashes[ index ] = _hash_tree_chunk( job->bytes, job->size, index );
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | file / visible
+
+embed hash_128 hash_content_tree( anon const ref const bytes, n8 const size )
+{
+	out_if( size <= H_HASH_FILE_CHUNK ) _hash_content_128( bytes, size, 0 );
+	temp n8 const chunks = ( size + H_HASH_FILE_CHUNK - 1 ) / H_HASH_FILE_CHUNK;
+	_hash_tree_job job = { .bytes = bytes, .size = size, .hashes = os_create_ref( hash_128, chunks ) };
+	if_nothing( job.hashes )
+	{
+		hash_stream stream;
+		hash_stream_init( ref_of( stream ), size );
+		iter( c, chunks )
+		{
+			hash_128 const chunk = _hash_tree_chunk( job.bytes, size, c );
+			hash_stream_update( ref_of( stream ), ref_of( chunk ), size_of( hash_128 ) );
+		}
+		out hash_stream_final_128( ref_of( stream ) );
+	}
+	os_run_jobs( _hash_tree_job_run, ref_of( job ), chunks );
+	temp hash_128 const result = _hash_content_128( job.hashes, chunks * size_of( hash_128 ), size );
+	os_delete_ref( job.hashes );
+	out result;
+}
+
+// maps the file and hashes it with `hash_content_tree`; no when it can't be read
+embed flag _os_hash_file( byte const ref const path, n4 const path_size, hash_128 ref const result )
+{
+	os_file file = _os_map_file( path, path_size );
+	if( file.mapped_bytes is nothing )
+	{
+		out_if( not os_file_exists( path ) or _os_file_size( path ) isnt 0 ) no;
+		val_of( result ) = hash_content_tree( nothing, 0 );
+		out yes;
+	}
+	val_of( result ) = hash_content_tree( file.mapped_bytes, file.size );
+	os_file_ref_unmap( ref_of( file ) );
+	out yes;
+}
+#define os_hash_file( PATH, HASH_REF, PATH_SIZE... ) _os_hash_file( PATH, DEFAULT( bytes_measure( PATH ), PATH_SIZE ), HASH_REF )
+
+#pragma endregion visible
+///
+
+#pragma endregion file
+////
+
+#pragma endregion hash
+/////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region - FIND
+//
+
+////////////////////////////////////////////////////////////////
+#pragma region - bytes
+
+// `bytes_find_bytes` filters candidates on the needle's first and last bytes with SIMD and verifies
+// them, and uses Two-Way (linear time, no tables) for needles over H_FIND_FILTER_MAX bytes
+
+#ifndef H_FIND_FILTER_MAX
+	#define H_FIND_FILTER_MAX 64
+#endif
+
+////////////////////////////////
+#pragma region | bytes / hidden
+
+#if SIMD_AVX2
+	#define _FIND_WIDTH 32
+	#define _find_splat( BYTE ) _mm256_set1_epi8( BYTE )
+	#define _find_load( REF ) _mm256_loadu_si256( to( __m256i const ref, REF ) )
+	#define _find_table( REF ) _mm256_broadcastsi128_si256( _mm_loadu_si128( to( __m128i const ref, REF ) ) )
+	#define _find_equal( A, B ) _mm256_cmpeq_epi8( A, B )
+	#define _find_greater( A, B ) _mm256_cmpgt_epi8( A, B )
+	#define _find_and( A, B ) _mm256_and_si256( A, B )
+	#define _find_or( A, B ) _mm256_or_si256( A, B )
+	#define _find_and_not( A, B ) _mm256_andnot_si256( B, A )
+	#define _find_shift_4( A ) _mm256_srli_epi16( A, 4 )
+	#define _find_shuffle( TABLE, INDEX ) _mm256_shuffle_epi8( TABLE, INDEX )
+	#define _find_mask( V ) n4( _mm256_movemask_epi8( V ) )
+	#define _FIND_SHUFFLE 1
+#elif SIMD_SSE2
+	#define _FIND_WIDTH 16
+	#define _find_splat( BYTE ) _mm_set1_epi8( BYTE )
+	#define _find_load( REF ) _mm_loadu_si128( to( __m128i const ref, REF ) )
+	#define _find_table( REF ) _find_load( REF )
+	#define _find_equal( A, B ) _mm_cmpeq_epi8( A, B )
+	#define _find_greater( A, B ) _mm_cmpgt_epi8( A, B )
+	#define _find_and( A, B ) _mm_and_si128( A, B )
+	#define _find_or( A, B ) _mm_or_si128( A, B )
+	#define _find_and_not( A, B ) _mm_andnot_si128( B, A )
+	#define _find_shift_4( A ) _mm_srli_epi16( A, 4 )
+	#define _find_mask( V ) n4( _mm_movemask_epi8( V ) )
+	#if SIMD_SSSE3
+		#define _find_shuffle( TABLE, INDEX ) _mm_shuffle_epi8( TABLE, INDEX )
+		#define _FIND_SHUFFLE 1
+	#else
+		#define _FIND_SHUFFLE 0
+	#endif
+#else
+	#define _FIND_WIDTH 0
+	#define _FIND_SHUFFLE 0
+#endif
+
+embed i8 _find_maximal_suffix( n1 const ref const needle, i8 const size, i8 ref const period, flag const reverse )
+{
+	temp i8 suffix = -1;
+	temp i8 j = 0;
+	temp i8 k = 1;
+	temp i8 p = 1;
+	while( j + k < size )
+	{
+		temp n1 const a = needle[ j + k ];
+		temp n1 const b = needle[ suffix + k ];
+		if( pick( reverse, a > b, a < b ) )
+		{
+			j += k;
+			k = 1;
+			p = j - suffix;
+		}
+		else if( a is b )
+		{
+			if( k isnt p ) ++k;
+			else
+			{
+				j += p;
+				k = 1;
+			}
+		}
+		else
+		{
+			suffix = j;
+			j = suffix + 1;
+			k = p = 1;
+		}
+	}
+	val_of( period ) = p;
+	out suffix;
+}
+
+embed byte const ref _find_two_way( byte const ref const bytes, i8 const size, byte const ref const needle_bytes, i8 const needle_size )
+{
+	temp n1 const ref const haystack = to( n1 const ref, bytes );
+	temp n1 const ref const needle = to( n1 const ref, needle_bytes );
+	i8 period = 0;
+	i8 reverse_period = 0;
+	temp i8 const forward = _find_maximal_suffix( needle, needle_size, ref_of( period ), no );
+	temp i8 const backward = _find_maximal_suffix( needle, needle_size, ref_of( reverse_period ), yes );
+	temp i8 const split = MAX( forward, backward );
+	temp i8 shift = pick( forward > backward, period, reverse_period );
+	temp i8 position = 0;
+
+	if( bytes_compare( needle, needle + shift, split + 1 ) is 0 )
+	{
+		temp i8 memory = -1;
+		while( position <= size - needle_size )
+		{
+			temp i8 i = MAX( split, memory ) + 1;
+			while( i < needle_size and needle[ i ] is haystack[ i + position ] ) ++i;
+			if( i >= needle_size )
+			{
+				i = split;
+				while( i > memory and needle[ i ] is haystack[ i + position ] ) --i;
+				out_if( i <= memory ) bytes + position;
+				position += shift;
+				memory = needle_size - shift - 1;
+			}
+			else
+			{
+				position += i - split;
+				memory = -1;
+			}
+		}
+	}
+	else
+	{
+		shift = MAX( split + 1, needle_size - split - 1 ) + 1;
+		while( position <= size - needle_size )
+		{
+			temp i8 i = split + 1;
+			while( i < needle_size and needle[ i ] is haystack[ i + position ] ) ++i;
+			if( i >= needle_size )
+			{
+				i = split;
+				while( i >= 0 and needle[ i ] is haystack[ i + position ] ) --i;
+				out_if( i < 0 ) bytes + position;
+				position += shift;
+			}
+			else position += i - split;
+		}
+	}
+	out nothing;
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | bytes / visible
+
+// the first NEEDLE in BYTES, or nothing
+embed byte const ref bytes_find_bytes( anon const ref const bytes_ref, n8 const size, anon const ref const needle_ref, n8 const needle_size )
+{
+	temp byte const ref const bytes = bytes_ref;
+	temp byte const ref const needle = needle_ref;
+	out_if( needle_size is 0 ) bytes;
+	out_if( needle_size > size ) nothing;
+	out_if( needle_size is 1 ) bytes_find( bytes, needle[ 0 ], size );
+
+	#if _FIND_WIDTH
+		if( needle_size <= H_FIND_FILTER_MAX )
+		{
+			temp n8 const starts = size - needle_size + 1;
+			temp type_of( _find_splat( 0 ) ) const first = _find_splat( needle[ 0 ] );
+			temp type_of( _find_splat( 0 ) ) const last = _find_splat( needle[ needle_size - 1 ] );
+			temp n8 i = 0;
+			for( ; i + _FIND_WIDTH <= starts; i += _FIND_WIDTH )
+			{
+				temp n4 mask = _find_mask( _find_and(
+					_find_equal( _find_load( bytes + i ), first ),
+					_find_equal( _find_load( bytes + i + needle_size - 1 ), last )
+				) );
+				while( mask )
+				{
+					temp byte const ref const found = bytes + i + n4_ctz( mask );
+					out_if( bytes_match( found + 1, needle + 1, needle_size - 2 ) ) found;
+					mask &= mask - 1;
+				}
+			}
+			for( ; i < starts; ++i )
+			{
+				out_if( bytes[ i ] is needle[ 0 ] and bytes_match( bytes + i + 1, needle + 1, needle_size - 1 ) ) bytes + i;
+			}
+			out nothing;
+		}
+	#endif
+
+	out _find_two_way( bytes, i8( size ), needle, i8( needle_size ) );
+}
+
+// a set of bytes to search for: nibble tables for SIMD shuffles, a bitmap for the rest
+type( bytes_set )
+{
+	n1 low[ 16 ];
+	n1 high[ 16 ];
+	n8 bits[ 4 ];
+	byte members[ 16 ];
+	n2 count;
+};
+
+#define bytes_set_has( SET_REF, BYTE ) ( ( ( SET_REF )->bits[ n1( BYTE ) >> 6 ] >> ( n1( BYTE ) & 63 ) ) & 1 )
+
+embed bytes_set bytes_set_make( anon const ref const set_ref, n8 const set_size )
+{
+	temp n1 const ref const set = set_ref;
+	bytes_set result = { 0 };
+	iter( i, set_size )
+	{
+		temp n1 const value = set[ i ];
+		next_if( bytes_set_has( ref_of( result ), value ) );
+		result.bits[ value >> 6 ] |= 1ull << ( value & 63 );
+		if( value < 128 ) result.low[ value & 15 ] |= n1( 1 << ( value >> 4 ) );
+		else result.high[ value & 15 ] |= n1( 1 << ( ( value >> 4 ) - 8 ) );
+		if( result.count < 16 ) result.members[ result.count ] = byte( value );
+		++result.count;
+	}
+	out result;
+}
+
+// the first byte of BYTES that is in SET_REF, or nothing
+embed byte const ref bytes_find_set( anon const ref const bytes_ref, n8 const size, bytes_set const ref const set )
+{
+	temp byte const ref const bytes = bytes_ref;
+	temp n8 i = 0;
+	out_if( set->count is 0 ) nothing;
+	out_if( set->count is 1 ) bytes_find( bytes, set->members[ 0 ], size );
+
+	#if _FIND_SHUFFLE
+		perm n1 const bit_table[ 16 ] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+		temp type_of( _find_splat( 0 ) ) const low = _find_table( set->low );
+		temp type_of( _find_splat( 0 ) ) const high = _find_table( set->high );
+		temp type_of( _find_splat( 0 ) ) const bits = _find_table( bit_table );
+		temp type_of( _find_splat( 0 ) ) const nibble = _find_splat( 15 );
+		temp type_of( _find_splat( 0 ) ) const seven = _find_splat( 7 );
+		for( ; i + _FIND_WIDTH <= size; i += _FIND_WIDTH )
+		{
+			temp type_of( _find_splat( 0 ) ) const chunk = _find_load( bytes + i );
+			temp type_of( _find_splat( 0 ) ) const lo = _find_and( chunk, nibble );
+			temp type_of( _find_splat( 0 ) ) const hi = _find_and( _find_shift_4( chunk ), nibble );
+			temp type_of( _find_splat( 0 ) ) const upper = _find_greater( hi, seven );
+			temp type_of( _find_splat( 0 ) ) const row = _find_or(
+				_find_and_not( _find_shuffle( low, lo ), upper ),
+				_find_and( _find_shuffle( high, lo ), upper )
+			);
+			temp type_of( _find_splat( 0 ) ) const bit = _find_shuffle( bits, hi );
+			temp n4 const mask = _find_mask( _find_equal( _find_and( row, bit ), bit ) );
+			out_if( mask ) bytes + i + n4_ctz( mask );
+		}
+	#elif _FIND_WIDTH
+		if( set->count <= 16 )
+		{
+			type_of( _find_splat( 0 ) ) splats[ 16 ];
+			iter( m, set->count ) splats[ m ] = _find_splat( set->members[ m ] );
+			for( ; i + _FIND_WIDTH <= size; i += _FIND_WIDTH )
+			{
+				temp type_of( _find_splat( 0 ) ) const chunk = _find_load( bytes + i );
+				temp type_of( _find_splat( 0 ) ) found = _find_equal( chunk, splats[ 0 ] );
+				for( temp n4 m = 1; m < set->count; ++m ) found = _find_or( found, _find_equal( chunk, splats[ m ] ) );
+				temp n4 const mask = _find_mask( found );
+				out_if( mask ) bytes + i + n4_ctz( mask );
+			}
+		}
+	#endif
+
+	for( ; i < size; ++i )
+	{
+		out_if( bytes_set_has( set, bytes[ i ] ) ) bytes + i;
+	}
+	out nothing;
+}
+
+embed byte const ref _bytes_find_any( anon const ref const bytes_ref, n8 const size, anon const ref const set_ref, n8 const set_size )
+{
+	bytes_set const set = bytes_set_make( set_ref, set_size );
+	out bytes_find_set( bytes_ref, size, ref_of( set ) );
+}
+
+// the first byte of BYTES that is any of SET; build a bytes_set once to search many buffers
+#define bytes_find_any( BYTES, SIZE, SET, SET_SIZE... ) _bytes_find_any( BYTES, SIZE, SET, DEFAULT( bytes_measure( SET ), SET_SIZE ) )
+
+// positions in a view, or its size when not found
+embed n8 bytes_view_find_bytes( bytes_view const view, bytes_view const needle )
+{
+	temp byte const ref const found = bytes_find_bytes( view.bytes, view.size, needle.bytes, needle.size );
+	out pick( found is nothing, view.size, n8( found - view.bytes ) );
+}
+
+embed n8 bytes_view_find_set( bytes_view const view, bytes_set const ref const set )
+{
+	temp byte const ref const found = bytes_find_set( view.bytes, view.size, set );
+	out pick( found is nothing, view.size, n8( found - view.bytes ) );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion bytes
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - matcher
+
+// Aho-Corasick over byte classes: `matcher_build` turns many patterns into one dense DFA, then
+// `matcher_find` / `matcher_scan` run it over any number of buffers in one pass each; moves hold
+// the target's row offset with a hit bit, so a step is one load, and while at the root state a
+// small set of pattern first bytes is skipped to with `bytes_find_set`
+
+type_from( flag matcher_found )( anon ref const, n4 const, n8 const );
+
+type( matcher )
+{
+	n4 ref moves;
+	n4 ref ends;
+	n4 ref end_links;
+	n4 ref duplicates;
+	n4 ref sizes;
+	n4 state_count;
+	n4 class_count;
+	n4 pattern_count;
+	n1 classes[ 256 ];
+	bytes_set first;
+};
+
+#define _MATCHER_NONE n4_max_val
+#define _MATCHER_HIT 0x80000000u
+#define _MATCHER_SKIP_MAX 16
+
+////////////////////////////////
+#pragma region | matcher / hidden
+
+// the first pattern ending at the state, else its nearest suffix state with one
+#define _matcher_output( MATCHER_REF, STATE )\
+	pick( ( MATCHER_REF )->ends[ STATE ] isnt _MATCHER_NONE, STATE, ( MATCHER_REF )->end_links[ STATE ] )
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | matcher / visible
+
+fn matcher_delete( matcher ref const m )
+{
+	os_delete_ref( m->moves );
+	os_delete_ref( m->ends );
+	os_delete_ref( m->end_links );
+	os_delete_ref( m->duplicates );
+	os_delete_ref( m->sizes );
+	bytes_clear( m, size_of( matcher ) );
+}
+
+// PATTERN_SIZES may be nothing to measure each pattern; empty patterns are ignored
+embed flag matcher_build( matcher ref const m, byte const ref const ref const patterns, n4 const ref const pattern_sizes, n4 const count )
+{
+	matcher_delete( m );
+	m->pattern_count = count;
+	m->sizes = os_create_ref( n4, count + 1 );
+	m->duplicates = os_create_ref( n4, count + 1 );
+	out_if( m->sizes is nothing or m->duplicates is nothing ) no;
+
+	temp n8 total = 1;
+	n1 first_bytes[ 256 ];
+	temp n4 first_count = 0;
+	iter( p, count )
+	{
+		m->sizes[ p ] = pick( pattern_sizes is nothing, n4( bytes_measure( patterns[ p ] ) ), pattern_sizes[ p ] );
+		total += m->sizes[ p ];
+		iter( i, m->sizes[ p ] ) m->classes[ n1( patterns[ p ][ i ] ) ] = 1;
+	}
+	m->class_count = 1;
+	iter( b, 256 )
+	{
+		if( m->classes[ b ] ) m->classes[ b ] = n1( m->class_count++ );
+	}
+	temp n4 const classes = m->class_count;
+	out_if( total * classes >= _MATCHER_HIT ) no;
+
+	m->moves = os_create_ref( n4, total * classes );
+	m->ends = os_create_ref( n4, total );
+	m->end_links = os_create_ref( n4, total );
+	out_if( m->moves is nothing or m->ends is nothing or m->end_links is nothing ) no;
+	bytes_fill( m->ends, 0xFF, total * size_of( n4 ) );
+	bytes_fill( m->end_links, 0xFF, total * size_of( n4 ) );
+
+	// trie, where a 0 move is missing since no state moves back to the root while building
+	m->state_count = 1;
+	iter( p, count )
+	{
+		m->duplicates[ p ] = _MATCHER_NONE;
+		next_if( m->sizes[ p ] is 0 );
+		temp n4 state = 0;
+		iter( i, m->sizes[ p ] )
+		{
+			temp n4 ref const move = m->moves + n8( state ) * classes + m->classes[ n1( patterns[ p ][ i ] ) ];
+			if( val_of( move ) is 0 ) val_of( move ) = m->state_count++;
+			state = val_of( move );
+		}
+		m->duplicates[ p ] = m->ends[ state ];
+		m->ends[ state ] = n4( p );
+	}
+
+	// breadth-first failure links, folded into the moves to make a DFA
+	temp n4 ref const queue = os_create_ref( n4, m->state_count );
+	temp n4 ref const fails = os_create_ref( n4, m->state_count );
+	if( queue is nothing or fails is nothing )
+	{
+		if_something( queue ) _free( queue );
+		if_something( fails ) _free( fails );
+		out no;
+	}
+	temp n4 head = 0;
+	temp n4 tail = 0;
+	for( temp n4 c = 1; c < classes; ++c )
+	{
+		temp n4 const child = m->moves[ c ];
+		next_if( child is 0 );
+		fails[ child ] = 0;
+		queue[ tail++ ] = child;
+	}
+	while( head < tail )
+	{
+		temp n4 const state = queue[ head++ ];
+		temp n4 ref const moves = m->moves + n8( state ) * classes;
+		temp n4 const ref const fail_moves = m->moves + n8( fails[ state ] ) * classes;
+		iter( c, classes )
+		{
+			if( moves[ c ] is 0 ) moves[ c ] = fail_moves[ c ];
+			else
+			{
+				temp n4 const child = moves[ c ];
+				temp n4 const fail = fail_moves[ c ];
+				fails[ child ] = fail;
+				m->end_links[ child ] = _matcher_output( m, fail );
+				queue[ tail++ ] = child;
+			}
+		}
+	}
+	_free( queue );
+	_free( fails );
+
+	iter( i, n8( m->state_count ) * classes )
+	{
+		temp n4 const target = m->moves[ i ];
+		m->moves[ i ] = target * classes | pick( _matcher_output( m, target ) is _MATCHER_NONE, 0, _MATCHER_HIT );
+	}
+
+	iter( b, 256 )
+	{
+		if( m->classes[ b ] and m->moves[ m->classes[ b ] ] ) first_bytes[ first_count++ ] = n1( b );
+	}
+	if( first_count <= _MATCHER_SKIP_MAX ) m->first = bytes_set_make( first_bytes, first_count );
+	out yes;
+}
+
+// calls FOUND( context, pattern, end ) for every match, END being one past its last byte,
+// in order of END; stops early when FOUND gives no
+embed n8 matcher_scan( matcher const ref const m, anon const ref const bytes_ref, n8 const size, matcher_found ref const found, anon ref const context )
+{
+	temp n1 const ref const bytes = bytes_ref;
+	temp n4 const ref const moves = m->moves;
+	temp n4 row = 0;
+	temp n8 matches = 0;
+	out_if( m->state_count <= 1 ) 0;
+	iter( i, size )
+	{
+		if( row is 0 and m->first.count )
+		{
+			temp byte const ref const at = bytes_find_set( bytes + i, size - i, ref_of( m->first ) );
+			skip_if( at is nothing );
+			i = n8( to( n1 const ref, at ) - bytes );
+		}
+		row = moves[ ( row & ~_MATCHER_HIT ) + m->classes[ bytes[ i ] ] ];
+		next_if( not( row & _MATCHER_HIT ) );
+		temp n4 const state = ( row & ~_MATCHER_HIT ) / m->class_count;
+		for( temp n4 end = _matcher_output( m, state ); end isnt _MATCHER_NONE; end = m->end_links[ end ] )
+		{
+			for( temp n4 p = m->ends[ end ]; p isnt _MATCHER_NONE; p = m->duplicates[ p ] )
+			{
+				++matches;
+				out_if( found isnt nothing and found( context, p, i + 1 ) is no ) matches;
+			}
+		}
+	}
+	out matches;
+}
+
+// the start of the first match to end, or nothing; PATTERN_REF gets its index when given
+embed byte const ref matcher_find( matcher const ref const m, anon const ref const bytes_ref, n8 const size, n4 ref const pattern_ref )
+{
+	temp n1 const ref const bytes = bytes_ref;
+	temp n4 const ref const moves = m->moves;
+	temp n4 row = 0;
+	out_if( m->state_count <= 1 ) nothing;
+	iter( i, size )
+	{
+		if( row is 0 and m->first.count )
+		{
+			temp byte const ref const at = bytes_find_set( bytes + i, size - i, ref_of( m->first ) );
+			out_if( at is nothing ) nothing;
+			i = n8( to( n1 const ref, at ) - bytes );
+		}
+		row = moves[ ( row & ~_MATCHER_HIT ) + m->classes[ bytes[ i ] ] ];
+		if( row & _MATCHER_HIT )
+		{
+			temp n4 const p = m->ends[ _matcher_output( m, ( row & ~_MATCHER_HIT ) / m->class_count ) ];
+			if_something( pattern_ref ) val_of( pattern_ref ) = p;
+			out to( byte const ref, bytes + i + 1 - m->sizes[ p ] );
+		}
+	}
+	out nothing;
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion matcher
+////
+
+#pragma endregion find
+/////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region - COMPRESS
+//
+
+////////////////////////////////////////////////////////////////
+#pragma region - block
+
+// LZ4 block format: a token of literal and match lengths, the literals, a 2-byte offset back
+// into at most 64 KiB of output, with lengths past 15 continued in 255s; matches are found
+// through a 4096-entry hash of 4-byte sequences, and the decoder copies 16 bytes at a time
+// `compress_block` needs room for `compress_bound( SIZE )` and gives the bytes written;
+// `decompress_block` gives the bytes written, or codec_invalid when the input is malformed
+// or would go past CAPACITY
+
+#define compress_bound( SIZE ) ( ( SIZE ) + ( SIZE ) / 255 + 16 )
+
+////////////////////////////////
+#pragma region | block / hidden
+
+#define _COMPRESS_HASH_BITS 12
+#define _COMPRESS_MIN_MATCH 4
+#define _COMPRESS_LAST_LITERALS 5
+#define _COMPRESS_MATCH_FROM_END 12
+#define _COMPRESS_OFFSET_MAX 65535
+#define _COMPRESS_SKIP_TRIGGER 6
+
+#define _compress_read_n4( REF ) to( n4, _hash_read_n4( REF ) )
+#define _compress_hash( REF ) ( ( _compress_read_n4( REF ) * 2654435761u ) >> ( 32 - _COMPRESS_HASH_BITS ) )
+
+embed n8 _compress_match_size( n1 const ref a, n1 const ref b, n1 const ref const a_end )
+{
+	temp n1 const ref const a_start = a;
+	while( a + 8 <= a_end )
+	{
+		temp n8 const difference = _hash_read_n8( a ) ^ _hash_read_n8( b );
+		out_if( difference ) n8( a - a_start ) + ( n8_ctz( difference ) >> 3 );
+		a += 8;
+		b += 8;
+	}
+	while( a < a_end and val_of( a ) is val_of( b ) )
+	{
+		++a;
+		++b;
+	}
+	out n8( a - a_start );
+}
+
+embed n1 ref _compress_length( n1 ref to, n8 length )
+{
+	while( length >= 255 )
+	{
+		val_of( to++ ) = 255;
+		length -= 255;
+	}
+	val_of( to++ ) = n1( length );
+	out to;
+}
+
+embed n1 ref _compress_literals( n1 ref to, n1 const ref const from, n8 const size )
+{
+	temp n1 ref const token = to++;
+	if( size >= 15 )
+	{
+		val_of( token ) = 15 << 4;
+		to = _compress_length( to, size - 15 );
+	}
+	else val_of( token ) = n1( size << 4 );
+	bytes_copy( to, from, size );
+	out to + size;
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | block / visible
+
+embed n8 compress_block( anon ref const to_ref, n8 const capacity, anon const ref const from_ref, n8 const size )
+{
+	temp n1 ref const to = to_ref;
+	temp n1 const ref const from = from_ref;
+	out_if( capacity < compress_bound( size ) or size > n4_max_val ) 0;
+	out_if( size < _COMPRESS_MATCH_FROM_END + 1 ) n8( _compress_literals( to, from, size ) - to );
+
+	n4 table[ 1 << _COMPRESS_HASH_BITS ] = { 0 };
+	temp n1 ref write = to;
+	temp n1 const ref anchor = from;
+	temp n1 const ref read = from + 1;
+	temp n1 const ref const match_limit = from + size - _COMPRESS_LAST_LITERALS;
+	temp n1 const ref const search_limit = from + size - _COMPRESS_MATCH_FROM_END;
+	table[ _compress_hash( from ) ] = 0;
+
+	loop
+	{
+		// forward search, stepping further the longer nothing matches
+		temp n1 const ref match;
+		temp n4 attempts = 1 << _COMPRESS_SKIP_TRIGGER;
+		temp n1 const ref forward = read;
+		loop
+		{
+			temp n4 const hash = _compress_hash( forward );
+			read = forward;
+			forward += attempts++ >> _COMPRESS_SKIP_TRIGGER;
+			if( forward > search_limit )
+			{
+				write = _compress_literals( write, anchor, n8( from + size - anchor ) );
+				out n8( write - to );
+			}
+			match = from + table[ hash ];
+			table[ hash ] = n4( read - from );
+			skip_if( read - match <= _COMPRESS_OFFSET_MAX and match < read and _compress_read_n4( match ) is _compress_read_n4( read ) );
+		}
+
+		while( read > anchor and match > from and read[ -1 ] is match[ -1 ] )
+		{
+			--read;
+			--match;
+		}
+
+		temp n1 ref token = write;
+		write = _compress_literals( write, anchor, n8( read - anchor ) );
+
+		loop
+		{
+			write[ 0 ] = n1( read - match );
+			write[ 1 ] = n1( ( read - match ) >> 8 );
+			write += 2;
+			temp n8 const extra = _compress_match_size( read + _COMPRESS_MIN_MATCH, match + _COMPRESS_MIN_MATCH, match_limit );
+			read += _COMPRESS_MIN_MATCH + extra;
+			if( extra >= 15 )
+			{
+				val_of( token ) |= 15;
+				write = _compress_length( write, extra - 15 );
+			}
+			else val_of( token ) |= n1( extra );
+			anchor = read;
+
+			if( read > search_limit )
+			{
+				write = _compress_literals( write, anchor, n8( from + size - anchor ) );
+				out n8( write - to );
+			}
+
+			table[ _compress_hash( read - 2 ) ] = n4( read - 2 - from );
+			temp n4 const hash = _compress_hash( read );
+			match = from + table[ hash ];
+			table[ hash ] = n4( read - from );
+			skip_if( not( read - match <= _COMPRESS_OFFSET_MAX and match < read and _compress_read_n4( match ) is _compress_read_n4( read ) ) );
+			token = write++;
+			val_of( token ) = 0;
+		}
+		++read;
+	}
+}
+
+embed n8 decompress_block( anon ref const to_ref, n8 const capacity, anon const ref const from_ref, n8 const size )
+{
+	temp n1 ref const to = to_ref;
+	temp n1 ref write = to;
+	temp n1 const ref read = from_ref;
+	temp n1 const ref const read_end = read + size;
+	temp n1 const ref const write_end = to + capacity;
+	out_if( size is 0 ) codec_invalid;
+
+	loop
+	{
+		out_if( read >= read_end ) codec_invalid;
+		temp n1 const token = val_of( read++ );
+		temp n8 literals = token >> 4;
+		if( literals is 15 )
+		{
+			temp n1 extra;
+			do
+			{
+				out_if( read >= read_end ) codec_invalid;
+				extra = val_of( read++ );
+				literals += extra;
+			}
+			while( extra is 255 );
+		}
+		out_if( literals > n8( read_end - read ) or literals > n8( write_end - write ) ) codec_invalid;
+		if( literals <= 16 and read_end - read >= 16 and write_end - write >= 16 ) bytes_copy( write, read, 16 );
+		else bytes_copy( write, read, literals );
+		read += literals;
+		write += literals;
+		skip_if( read is read_end );
+
+		out_if( read_end - read < 2 ) codec_invalid;
+		temp n8 const offset = read[ 0 ] | n8( read[ 1 ] ) << 8;
+		read += 2;
+		out_if( offset is 0 or offset > n8( write - to ) ) codec_invalid;
+		temp n8 length = token & 15;
+		if( length is 15 )
+		{
+			temp n1 extra;
+			do
+			{
+				out_if( read >= read_end ) codec_invalid;
+				extra = val_of( read++ );
+				length += extra;
+			}
+			while( extra is 255 );
+		}
+		length += _COMPRESS_MIN_MATCH;
+		out_if( length > n8( write_end - write ) ) codec_invalid;
+
+		temp n1 const ref match = write - offset;
+		if( offset >= 16 and n8( write_end - write ) >= length + 16 )
+		{
+			for( temp n8 i = 0; i < length; i += 16 ) bytes_copy( write + i, match + i, 16 );
+		}
+		else if( offset >= 8 and n8( write_end - write ) >= length + 8 )
+		{
+			for( temp n8 i = 0; i < length; i += 8 ) bytes_copy( write + i, match + i, 8 );
+		}
+		else iter( i, length ) write[ i ] = match[ i ];
+		write += length;
+	}
+	out n8( write - to );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion block
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - frame
+
+// a frame is a 16-byte header ( "HLZ1", flags, block size log2, 2 reserved, n8 content size ),
+// then per block an n4 stored size ( top bit: stored raw ), the bytes and, with
+// compress_checksum, the n4 crc32c of the block's content, then an n4 0; blocks hold
+// H_COMPRESS_BLOCK bytes of content (a power of two), and are compressed and decompressed in
+// parallel on the job pool
+// `compress_frame` needs room for `compress_frame_bound( SIZE )`; `decompress_frame_size` reads
+// the content size from the header
+
+#ifndef H_COMPRESS_BLOCK
+	#define H_COMPRESS_BLOCK ( 1 << 20 )
+#endif
+
+#define compress_checksum 1
+#define compress_frame_header 16
+#define compress_frame_blocks( SIZE ) ( ( ( SIZE ) + H_COMPRESS_BLOCK - 1 ) / H_COMPRESS_BLOCK )
+#define compress_frame_bound( SIZE )\
+	( compress_frame_header + 4 + ( SIZE ) / H_COMPRESS_BLOCK * ( compress_bound( H_COMPRESS_BLOCK ) + 8 )\
+	+ pick( ( SIZE ) mod H_COMPRESS_BLOCK, compress_bound( ( SIZE ) mod H_COMPRESS_BLOCK ) + 8, 0 ) )
+
+////////////////////////////////
+#pragma region | frame / hidden
+
+#define _FRAME_MAGIC 0x315A4C48u
+#define _FRAME_RAW 0x80000000u
+
+type_from( variant _frame_job ) _frame_job;
+variant _frame_job
+{
+	n1 ref to;
+	n1 const ref from;
+	n8 size;
+	n8 block;
+	n8 ref places;
+	n4 ref sizes;
+	flag checksum;
+	flag failed;
+};
+
+#define _frame_block_size( JOB, INDEX ) pick( ( JOB )->block < ( JOB )->size - ( INDEX ) * ( JOB )->block, ( JOB )->block, ( JOB )->size - ( INDEX ) * ( JOB )->block )
+#define _frame_slot( TO, INDEX ) ( ( TO ) + compress_frame_header + ( INDEX ) * ( compress_bound( H_COMPRESS_BLOCK ) + 8 ) )
+#define _frame_write_n4( REF, VALUE ) START_DEF { n4 const _value = VALUE; bytes_copy( REF, ref_of( _value ), 4 ); } END_DEF
+
+// each block compresses into its worst-case slot (the last one sized to its content, so the
+// slots end at compress_frame_bound); the frame is packed together afterwards
+fn _frame_compress_job( anon ref const context, n8 const index )
+{
+	temp _frame_job ref const job = context;
+	temp n1 const ref const from = job->from + index * H_COMPRESS_BLOCK;
+	temp n8 const size = _frame_block_size( job, index );
+	temp n1 ref const slot = _frame_slot( job->to, index );
+	temp n8 stored_size = compress_block( slot + 4, compress_bound( size ), from, size );
+	if( stored_size is 0 or stored_size >= size )
+	{
+		bytes_copy( slot + 4, from, size );
+		stored_size = size;
+		_frame_write_n4( slot, n4( size ) | _FRAME_RAW );
+	}
+	else _frame_write_n4( slot, n4( stored_size ) );
+	if( job->checksum ) _frame_write_n4( slot + 4 + stored_size, crc32c( from, size ) );
+	job->sizes[ index ] = n4( stored_size );
+}
+
+fn _frame_decompress_job( anon ref const context, n8 const index )
+{
+	temp _frame_job ref const job = context;
+	temp n1 ref const to = job->to + index * job->block;
+	temp n8 const size = _frame_block_size( job, index );
+	temp n1 const ref const slot = job->from + job->places[ index ];
+	temp n4 const stored = _compress_read_n4( slot );
+	temp n8 const stored_size = stored & ~_FRAME_RAW;
+	temp n8 written = stored_size;
+	if( stored & _FRAME_RAW )
+	{
+		if( stored_size is size ) bytes_copy( to, slot + 4, size );
+	}
+	else written = decompress_block( to, size, slot + 4, stored_size );
+	if( written isnt size or ( job->checksum and _compress_read_n4( slot + 4 + stored_size ) isnt crc32c( to, size ) ) )
+	{
+		atomic_store_relaxed( ref_of( job->failed ), yes );
+	}
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | frame / visible
+
+// gives the bytes written, or 0 when TO is short of `compress_frame_bound( SIZE )` or memory runs out
+embed n8 compress_frame( anon ref const to_ref, n8 const capacity, anon const ref const from_ref, n8 const size, flag const checksum )
+{
+	temp n1 ref const to = to_ref;
+	temp n8 const blocks = compress_frame_blocks( size );
+	out_if( capacity < compress_frame_bound( size ) ) 0;
+	_frame_job job = { .to = to, .from = from_ref, .size = size, .block = H_COMPRESS_BLOCK, .checksum = checksum, .sizes = os_create_ref( n4, blocks + 1 ) };
+	out_if( job.sizes is nothing ) 0;
+
+	_frame_write_n4( to, _FRAME_MAGIC );
+	to[ 4 ] = pick( checksum, compress_checksum, 0 );
+	to[ 5 ] = n1( n8_ctz( H_COMPRESS_BLOCK ) );
+	to[ 6 ] = to[ 7 ] = 0;
+	bytes_copy( to + 8, ref_of( size ), 8 );
+	os_run_jobs( _frame_compress_job, ref_of( job ), blocks );
+
+	temp n1 ref write = to + compress_frame_header;
+	iter( b, blocks )
+	{
+		temp n1 ref const slot = _frame_slot( to, b );
+		temp n8 const block_bytes = 4 + job.sizes[ b ] + pick( checksum, 4, 0 );
+		bytes_move( slot, 0, block_bytes, write - slot );
+		write += block_bytes;
+	}
+	_frame_write_n4( write, 0 );
+	os_delete_ref( job.sizes );
+	out n8( write + 4 - to );
+}
+
+// the content size, or codec_invalid when this is not a frame
+embed n8 decompress_frame_size( anon const ref const from_ref, n8 const size )
+{
+	temp n1 const ref const from = from_ref;
+	out_if( size < compress_frame_header + 4 or _compress_read_n4( from ) isnt _FRAME_MAGIC or from[ 5 ] < 10 or from[ 5 ] > 30 ) codec_invalid;
+	out _hash_read_n8( from + 8 );
+}
+
+// gives the content size written, or codec_invalid for a malformed or corrupted frame
+embed n8 decompress_frame( anon ref const to_ref, n8 const capacity, anon const ref const from_ref, n8 const size )
+{
+	temp n1 const ref const from = from_ref;
+	temp n8 const content = decompress_frame_size( from, size );
+	out_if( content is codec_invalid or content > capacity ) codec_invalid;
+	temp n8 const block = 1ull << from[ 5 ];
+	temp n8 const blocks = ( content + block - 1 ) / block;
+	_frame_job job = { .to = to_ref, .from = from, .size = content, .block = block, .checksum = from[ 4 ] & compress_checksum, .places = os_create_ref( n8, blocks + 1 ) };
+	out_if( job.places is nothing ) codec_invalid;
+
+	temp n8 place = compress_frame_header;
+	temp n8 const tail = pick( job.checksum, 4, 0 );
+	iter( b, blocks )
+	{
+		temp n8 const stored_size = pick( place + 4 <= size, _compress_read_n4( from + place ) & ~_FRAME_RAW, 0 );
+		if( stored_size is 0 or place + 4 + stored_size + tail + 4 > size )
+		{
+			os_delete_ref( job.places );
+			out codec_invalid;
+		}
+		job.places[ b ] = place;
+		place += 4 + stored_size + tail;
+	}
+	temp flag const ended = _compress_read_n4( from + place ) is 0;
+	if( ended ) os_run_jobs( _frame_decompress_job, ref_of( job ), blocks );
+	os_delete_ref( job.places );
+	out pick( ended and not job.failed, content, codec_invalid );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion frame
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - file
+
+// whole files as one checksummed frame
+
+embed flag _os_save_file_compressed( byte const ref const path, n4 const path_size, anon const ref const bytes, n8 const size )
+{
+	temp n8 const bound = compress_frame_bound( size );
+	temp n1 ref buffer = os_create_ref( n1, bound );
+	out_if( buffer is nothing ) no;
+	temp n8 const stored_size = compress_frame( buffer, bound, bytes, size, yes );
+	os_file file = _os_file_saving( path, path_size );
+	temp flag const saved = stored_size isnt 0 and file.handle isnt nothing;
+	if( saved ) os_file_ref_save( ref_of( file ), to( byte const ref, buffer ), stored_size );
+	if_something( file.handle ) os_file_ref_close( ref_of( file ) );
+	os_delete_ref( buffer );
+	out saved;
+}
+#define os_save_file_compressed( PATH, BYTES, SIZE, PATH_SIZE... ) _os_save_file_compressed( PATH, DEFAULT( bytes_measure( PATH ), PATH_SIZE ), BYTES, SIZE )
+
+// the content in a new ref for `os_delete_ref`, its size in SIZE_REF; nothing when unreadable
+embed byte ref _os_load_file_compressed( byte const ref const path, n4 const path_size, n8 ref const size_ref )
+{
+	os_file file = _os_map_file( path, path_size );
+	out_if( file.mapped_bytes is nothing ) nothing;
+	temp n8 const content = decompress_frame_size( file.mapped_bytes, file.size );
+	temp byte ref bytes = pick( content is codec_invalid, nothing, os_create_ref( byte, content + 1 ) );
+	if( bytes isnt nothing and decompress_frame( bytes, content, file.mapped_bytes, file.size ) isnt content ) os_delete_ref( bytes );
+	os_file_ref_unmap( ref_of( file ) );
+	if( bytes isnt nothing ) val_of( size_ref ) = content;
+	out bytes;
+}
+#define os_load_file_compressed( PATH, SIZE_REF, PATH_SIZE... ) _os_load_file_compressed( PATH, DEFAULT( bytes_measure( PATH ), PATH_SIZE ), SIZE_REF )
+
+#pragma endregion file
+////
+
+#pragma endregion compress
+/////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region - CANVAS
+//
+
+// a `canvas` is RGBA8 pixels as n4, `rgba( R, G, B, A )` with red in the low byte, rows `stride`
+// pixels apart; drawing clips to both canvases, and anything covering at least H_CANVAS_PARALLEL
+// pixels splits its rows over os_run_jobs ( 0 turns that off )
+
+#ifndef H_CANVAS_PARALLEL
+	#define H_CANVAS_PARALLEL ( 1 << 18 )
+#endif
+
+#define rgba( R, G, B, A ) ( n4( R ) | n4( G ) << 8 | n4( B ) << 16 | n4( A ) << 24 )
+#define rgba_alpha( COLOR ) n1( ( COLOR ) >> 24 )
+
+type( canvas )
+{
+	n4 ref pixels;
+	n4 width;
+	n4 height;
+	n4 stride;
+};
+
+#define canvas_view( PIXELS, WIDTH, HEIGHT, STRIDE... ) make( canvas, .pixels = PIXELS, .width = WIDTH, .height = HEIGHT, .stride = DEFAULT( WIDTH, STRIDE ) )
+#define canvas_row( CANVAS_REF, Y ) ( ( CANVAS_REF )->pixels + n8( Y ) * ( CANVAS_REF )->stride )
+#define canvas_at( CANVAS_REF, X, Y ) canvas_row( CANVAS_REF, Y )[ X ]
+
+// all pixels 0; `pixels` is nothing when memory runs out
+embed canvas canvas_create( n4 const width, n4 const height )
+{
+	canvas c = { .pixels = os_create_ref( n4, MAX( n8( width ) * height, 1 ) ), .width = width, .height = height, .stride = width };
+	if_nothing( c.pixels ) c.width = c.height = c.stride = 0;
+	out c;
+}
+
+fn canvas_delete( canvas ref const c )
+{
+	os_delete_ref( c->pixels );
+	c->width = c->height = c->stride = 0;
+}
+
+////////////////////////////////////////////////////////////////
+#pragma region - rows
+
+// one row span each; blending is exact `x * y / 255` rounding on every path
+
+////////////////////////////////
+#pragma region | rows / hidden
+
+#define _canvas_div255( V ) ( ( ( V ) + 128 + ( ( ( V ) + 128 ) >> 8 ) ) >> 8 )
+
+fn _canvas_fill_row( n4 ref const row, n4 const color, n8 const count )
+{
+	temp n8 i = 0;
+	#if SIMD_AVX2
+		temp __m256i const splat = _mm256_set1_epi32( to( i4, color ) );
+		for( ; i + 8 <= count; i += 8 ) _mm256_storeu_si256( to( __m256i ref, row + i ), splat );
+	#elif SIMD_SSE2
+		temp __m128i const splat = _mm_set1_epi32( to( i4, color ) );
+		for( ; i + 4 <= count; i += 4 ) _mm_storeu_si128( to( __m128i ref, row + i ), splat );
+	#endif
+	for( ; i < count; ++i ) row[ i ] = color;
+}
+
+// pixels equal to KEY are left alone
+fn _canvas_keyed_row( n4 ref const to_row, n4 const ref const from_row, n8 const count, n4 const key )
+{
+	temp n8 i = 0;
+	#if SIMD_AVX2
+		temp __m256i const keys = _mm256_set1_epi32( to( i4, key ) );
+		for( ; i + 8 <= count; i += 8 )
+		{
+			temp __m256i const from = _mm256_loadu_si256( to( __m256i const ref, from_row + i ) );
+			temp __m256i const under = _mm256_loadu_si256( to( __m256i const ref, to_row + i ) );
+			_mm256_storeu_si256( to( __m256i ref, to_row + i ), _mm256_blendv_epi8( from, under, _mm256_cmpeq_epi32( from, keys ) ) );
+		}
+	#elif SIMD_SSE2
+		temp __m128i const keys = _mm_set1_epi32( to( i4, key ) );
+		for( ; i + 4 <= count; i += 4 )
+		{
+			temp __m128i const from = _mm_loadu_si128( to( __m128i const ref, from_row + i ) );
+			temp __m128i const under = _mm_loadu_si128( to( __m128i const ref, to_row + i ) );
+			temp __m128i const mask = _mm_cmpeq_epi32( from, keys );
+			_mm_storeu_si128( to( __m128i ref, to_row + i ), _mm_or_si128( _mm_and_si128( mask, under ), _mm_andnot_si128( mask, from ) ) );
+		}
+	#endif
+	for( ; i < count; ++i )
+	{
+		if( from_row[ i ] isnt key ) to_row[ i ] = from_row[ i ];
+	}
+}
+
+#if SIMD_SSE2
+	// 2 pixels widened to 16 bits, times the inverse source alpha of each, divided by 255
+	embed __m128i _canvas_blend_half( __m128i const under, __m128i const inverse )
+	{
+		temp __m128i const alpha = _mm_shufflehi_epi16( _mm_shufflelo_epi16( inverse, 0xFF ), 0xFF );
+		temp __m128i const product = _mm_add_epi16( _mm_mullo_epi16( under, alpha ), _mm_set1_epi16( 128 ) );
+		out _mm_srli_epi16( _mm_add_epi16( product, _mm_srli_epi16( product, 8 ) ), 8 );
+	}
+#endif
+
+#if SIMD_AVX2
+	embed __m256i _canvas_blend_half_256( __m256i const under, __m256i const inverse )
+	{
+		temp __m256i const alpha = _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( inverse, 0xFF ), 0xFF );
+		temp __m256i const product = _mm256_add_epi16( _mm256_mullo_epi16( under, alpha ), _mm256_set1_epi16( 128 ) );
+		out _mm256_srli_epi16( _mm256_add_epi16( product, _mm256_srli_epi16( product, 8 ) ), 8 );
+	}
+#endif
+
+// premultiplied source over destination: to = from + to * ( 255 - from alpha ) / 255
+fn _canvas_blend_row( n4 ref const to_row, n4 const ref const from_row, n8 const count )
+{
+	temp n8 i = 0;
+	#if SIMD_AVX2
+		temp __m256i const zero = _mm256_setzero_si256();
+		for( ; i + 8 <= count; i += 8 )
+		{
+			temp __m256i const from = _mm256_loadu_si256( to( __m256i const ref, from_row + i ) );
+			temp __m256i const under = _mm256_loadu_si256( to( __m256i const ref, to_row + i ) );
+			temp __m256i const inverse = _mm256_xor_si256( from, _mm256_set1_epi8( -1 ) );
+			temp __m256i const low = _canvas_blend_half_256( _mm256_unpacklo_epi8( under, zero ), _mm256_unpacklo_epi8( inverse, zero ) );
+			temp __m256i const high = _canvas_blend_half_256( _mm256_unpackhi_epi8( under, zero ), _mm256_unpackhi_epi8( inverse, zero ) );
+			_mm256_storeu_si256( to( __m256i ref, to_row + i ), _mm256_adds_epu8( from, _mm256_packus_epi16( low, high ) ) );
+		}
+	#elif SIMD_SSE2
+		temp __m128i const zero = _mm_setzero_si128();
+		for( ; i + 4 <= count; i += 4 )
+		{
+			temp __m128i const from = _mm_loadu_si128( to( __m128i const ref, from_row + i ) );
+			temp __m128i const under = _mm_loadu_si128( to( __m128i const ref, to_row + i ) );
+			temp __m128i const inverse = _mm_xor_si128( from, _mm_set1_epi8( -1 ) );
+			temp __m128i const low = _canvas_blend_half( _mm_unpacklo_epi8( under, zero ), _mm_unpacklo_epi8( inverse, zero ) );
+			temp __m128i const high = _canvas_blend_half( _mm_unpackhi_epi8( under, zero ), _mm_unpackhi_epi8( inverse, zero ) );
+			_mm_storeu_si128( to( __m128i ref, to_row + i ), _mm_adds_epu8( from, _mm_packus_epi16( low, high ) ) );
+		}
+	#endif
+	for( ; i < count; ++i )
+	{
+		temp n4 const from = from_row[ i ];
+		temp n4 const under = to_row[ i ];
+		temp n4 const inverse = 255 - ( from >> 24 );
+		temp n4 blended = 0;
+		iter( c, 4 )
+		{
+			temp n4 const channel = ( ( from >> ( c * 8 ) ) & 0xFF ) + _canvas_div255( ( ( under >> ( c * 8 ) ) & 0xFF ) * inverse );
+			blended |= MIN( channel, 255u ) << ( c * 8 );
+		}
+		to_row[ i ] = blended;
+	}
+}
+
+// COUNT pixels of FROM_ROW scaled up by SCALE, starting PHASE pixels into the scaled row
+fn _canvas_scale_row( n4 ref const to_row, n4 const ref const from_row, n8 const count, n4 const scale, n8 const phase )
+{
+	temp n4 const ref from = from_row + phase / scale;
+	temp n8 i = 0;
+	temp n8 run = scale - phase % scale;
+	#if SIMD_SSE2
+		if( scale is 2 and run is 2 )
+		{
+			for( ; i + 8 <= count; i += 8, from += 4 )
+			{
+				temp __m128i const pixels = _mm_loadu_si128( to( __m128i const ref, from ) );
+				_mm_storeu_si128( to( __m128i ref, to_row + i ), _mm_unpacklo_epi32( pixels, pixels ) );
+				_mm_storeu_si128( to( __m128i ref, to_row + i + 4 ), _mm_unpackhi_epi32( pixels, pixels ) );
+			}
+		}
+	#endif
+	while( i < count )
+	{
+		temp n8 const n = MIN( run, count - i );
+		if( n < 8 ) iter( k, n ) to_row[ i + k ] = val_of( from );
+		else _canvas_fill_row( to_row + i, val_of( from ), n );
+		i += n;
+		++from;
+		run = scale;
+	}
+}
+
+// palette entries for 8-bit indices
+fn _canvas_palette_row( n4 ref const to_row, n1 const ref const indices, n8 const count, n4 const ref const palette )
+{
+	temp n8 i = 0;
+	#if SIMD_AVX2
+		for( ; i + 8 <= count; i += 8 )
+		{
+			temp __m256i const lanes = _mm256_cvtepu8_epi32( _mm_loadl_epi64( to( __m128i const ref, indices + i ) ) );
+			_mm256_storeu_si256( to( __m256i ref, to_row + i ), _mm256_i32gather_epi32( to( int const ref, palette ), lanes, 4 ) );
+		}
+	#endif
+	for( ; i + 4 <= count; i += 4 )
+	{
+		to_row[ i ] = palette[ indices[ i ] ];
+		to_row[ i + 1 ] = palette[ indices[ i + 1 ] ];
+		to_row[ i + 2 ] = palette[ indices[ i + 2 ] ];
+		to_row[ i + 3 ] = palette[ indices[ i + 3 ] ];
+	}
+	for( ; i < count; ++i ) to_row[ i ] = palette[ indices[ i ] ];
+}
+
+#pragma endregion hidden
+///
+
+#pragma endregion rows
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - draw
+
+////////////////////////////////
+#pragma region | draw / hidden
+
+type_from( variant _canvas_job ) _canvas_job;
+type_fn(, _canvas_job const ref const, i8 const, i8 const ) _canvas_band;
+
+// X, Y, WIDTH, HEIGHT are the target span after clipping and FROM_X, FROM_Y the matching source corner,
+// in scaled pixels for `canvas_scale`
+variant _canvas_job
+{
+	canvas const ref target;
+	canvas const ref source;
+	n1 const ref indices;
+	n4 const ref palette;
+	n8 index_stride;
+	i8 x;
+	i8 y;
+	i8 from_x;
+	i8 from_y;
+	i8 width;
+	i8 height;
+	i8 rows;
+	n4 color;
+	n4 scale;
+	_canvas_band band;
+};
+
+fn _canvas_fill_band( _canvas_job const ref const job, i8 const first, i8 const end )
+{
+	range( r, first, end - 1 ) _canvas_fill_row( canvas_row( job->target, job->y + r ) + job->x, job->color, job->width );
+}
+
+fn _canvas_copy_band( _canvas_job const ref const job, i8 const first, i8 const end )
+{
+	range( r, first, end - 1 )
+	{
+		bytes_copy( canvas_row( job->target, job->y + r ) + job->x, canvas_row( job->source, job->from_y + r ) + job->from_x, job->width * size_of( n4 ) );
+	}
+}
+
+fn _canvas_keyed_band( _canvas_job const ref const job, i8 const first, i8 const end )
+{
+	range( r, first, end - 1 )
+	{
+		_canvas_keyed_row( canvas_row( job->target, job->y + r ) + job->x, canvas_row( job->source, job->from_y + r ) + job->from_x, job->width, job->color );
+	}
+}
+
+fn _canvas_blend_band( _canvas_job const ref const job, i8 const first, i8 const end )
+{
+	range( r, first, end - 1 )
+	{
+		_canvas_blend_row( canvas_row( job->target, job->y + r ) + job->x, canvas_row( job->source, job->from_y + r ) + job->from_x, job->width );
+	}
+}
+
+// rows repeating the one above are copied from it
+fn _canvas_scale_band( _canvas_job const ref const job, i8 const first, i8 const end )
+{
+	range( r, first, end - 1 )
+	{
+		temp n4 ref const row = canvas_row( job->target, job->y + r ) + job->x;
+		temp i8 const scaled_y = job->from_y + r;
+		if( r > first and scaled_y mod job->scale isnt 0 ) bytes_copy( row, row - job->target->stride, job->width * size_of( n4 ) );
+		else _canvas_scale_row( row, canvas_row( job->source, scaled_y / job->scale ), job->width, job->scale, job->from_x );
+	}
+}
+
+fn _canvas_palette_band( _canvas_job const ref const job, i8 const first, i8 const end )
+{
+	range( r, first, end - 1 )
+	{
+		temp n1 const ref const indices = job->indices + n8( job->from_y + r ) * job->index_stride + job->from_x;
+		_canvas_palette_row( canvas_row( job->target, job->y + r ) + job->x, indices, job->width, job->palette );
+	}
+}
+
+fn _canvas_job_run( anon ref const context, n8 const index )
+{
+	temp _canvas_job const ref const job = context;
+	temp i8 const first = i8( index ) * job->rows;
+	job->band( job, first, MIN( first + job->rows, job->height ) );
+}
+
+// clips to the source ( SOURCE_WIDTH x SOURCE_HEIGHT ) and the target, then runs the rows in bands
+fn _canvas_run( _canvas_job ref const job, i8 const source_width, i8 const source_height )
+{
+	if( job->from_x < 0 )
+	{
+		job->x -= job->from_x;
+		job->width += job->from_x;
+		job->from_x = 0;
+	}
+	if( job->from_y < 0 )
+	{
+		job->y -= job->from_y;
+		job->height += job->from_y;
+		job->from_y = 0;
+	}
+	if( job->x < 0 )
+	{
+		job->from_x -= job->x;
+		job->width += job->x;
+		job->x = 0;
+	}
+	if( job->y < 0 )
+	{
+		job->from_y -= job->y;
+		job->height += job->y;
+		job->y = 0;
+	}
+	job->width = MIN3( job->width, i8( job->target->width ) - job->x, source_width - job->from_x );
+	job->height = MIN3( job->height, i8( job->target->height ) - job->y, source_height - job->from_y );
+	out_if( job->width <= 0 or job->height <= 0 );
+
+	temp flag const parallel = H_CANVAS_PARALLEL and n8( job->width * job->height ) >= H_CANVAS_PARALLEL;
+	temp i8 const bands = pick( parallel, MIN( i8( os_cpu_count() ), job->height ), 1 );
+	job->rows = ( job->height + bands - 1 ) / bands;
+	os_run_jobs( _canvas_job_run, job, n8( ( job->height + job->rows - 1 ) / job->rows ) );
+}
+
+fn _canvas_draw( canvas ref const target, i8 const x, i8 const y, canvas const ref const source, i8 const from_x, i8 const from_y, i8 const width, i8 const height, _canvas_band const band, n4 const color )
+{
+	_canvas_job job = { .target = target, .source = source, .x = x, .y = y, .from_x = from_x, .from_y = from_y, .width = width, .height = height, .color = color, .scale = 1, .band = band };
+	_canvas_run( ref_of( job ), source->width, source->height );
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | draw / visible
+
+embed n4 rgba_premultiply( n4 const color )
+{
+	temp n4 const alpha = color >> 24;
+	temp n4 result = color & 0xFF000000u;
+	iter( c, 3 ) result |= n4( _canvas_div255( ( ( color >> ( c * 8 ) ) & 0xFF ) * alpha ) ) << ( c * 8 );
+	out result;
+}
+
+fn canvas_fill_rect( canvas ref const target, i8 const x, i8 const y, i8 const width, i8 const height, n4 const color )
+{
+	_canvas_job job = { .target = target, .x = x, .y = y, .width = width, .height = height, .color = color, .scale = 1, .band = _canvas_fill_band };
+	_canvas_run( ref_of( job ), i8_max_val / 2, i8_max_val / 2 );
+}
+
+#define canvas_clear( CANVAS_REF, COLOR... ) canvas_fill_rect( CANVAS_REF, 0, 0, ( CANVAS_REF )->width, ( CANVAS_REF )->height, DEFAULT( 0, COLOR ) )
+
+// WIDTH x HEIGHT of SOURCE from FROM_X, FROM_Y, to X, Y of TARGET; TARGET and SOURCE must not overlap
+#define canvas_blit_part( TARGET_REF, X, Y, SOURCE_REF, FROM_X, FROM_Y, WIDTH, HEIGHT ) _canvas_draw( TARGET_REF, X, Y, SOURCE_REF, FROM_X, FROM_Y, WIDTH, HEIGHT, _canvas_copy_band, 0 )
+#define canvas_blit( TARGET_REF, X, Y, SOURCE_REF ) canvas_blit_part( TARGET_REF, X, Y, SOURCE_REF, 0, 0, ( SOURCE_REF )->width, ( SOURCE_REF )->height )
+
+// skips SOURCE pixels equal to KEY
+#define canvas_blit_keyed( TARGET_REF, X, Y, SOURCE_REF, KEY ) _canvas_draw( TARGET_REF, X, Y, SOURCE_REF, 0, 0, ( SOURCE_REF )->width, ( SOURCE_REF )->height, _canvas_keyed_band, KEY )
+
+// premultiplied SOURCE over TARGET; see `rgba_premultiply`
+#define canvas_blend( TARGET_REF, X, Y, SOURCE_REF ) _canvas_draw( TARGET_REF, X, Y, SOURCE_REF, 0, 0, ( SOURCE_REF )->width, ( SOURCE_REF )->height, _canvas_blend_band, 0 )
+
+// SOURCE at X, Y of TARGET, every pixel drawn as a SCALE x SCALE square
+fn canvas_scale( canvas ref const target, i8 const x, i8 const y, canvas const ref const source, n4 const scale )
+{
+	out_if( scale is 0 );
+	_canvas_job job = { .target = target, .source = source, .x = x, .y = y, .scale = scale, .band = _canvas_scale_band };
+	job.width = i8( source->width ) * scale;
+	job.height = i8( source->height ) * scale;
+	_canvas_run( ref_of( job ), job.width, job.height );
+}
+
+// WIDTH x HEIGHT palette INDICES, rows STRIDE bytes apart, as PALETTE colors at X, Y of TARGET
+fn canvas_from_palette( canvas ref const target, i8 const x, i8 const y, n1 const ref const indices, i8 const width, i8 const height, n8 const stride, n4 const palette[ 256 ] )
+{
+	_canvas_job job = { .target = target, .indices = indices, .palette = palette, .index_stride = stride, .x = x, .y = y, .width = width, .height = height, .scale = 1, .band = _canvas_palette_band };
+	_canvas_run( ref_of( job ), width, height );
+}
+
+#pragma endregion visible
+///
+
+#pragma endregion draw
+////
+
+#pragma endregion canvas
+/////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region - SORT
+//
+
+////////////////////////////////////////////////////////////////
+#pragma region - compare
+
+// `sort_define( NAME, TYPE, LESS )` makes `NAME( values, count )`, a pattern-defeating quicksort
+// with `LESS( A, B )` expanded inline; not stable
+
+#define _SORT_INSERTION 24
+#define _SORT_NINTHER 128
+
+#define sort_define( NAME, TYPE, LESS )\
+	fn NAME##_swap( TYPE ref const a, TYPE ref const b )\
+	{\
+		temp TYPE const swap = val_of( a );\
+		val_of( a ) = val_of( b );\
+		val_of( b ) = swap;\
+	}\
+	fn NAME##_sort2( TYPE ref const a, TYPE ref const b )\
 	{\
-		out MAX( a, b );\
+		if( LESS( val_of( b ), val_of( a ) ) ) NAME##_swap( a, b );\
 	}\
-	embed T##N T##N##_max3( T##N const a, T##N const b, T##N const c )\
+	fn NAME##_sort3( TYPE ref const a, TYPE ref const b, TYPE ref const c )\
 	{\
-		out MAX3( a, b, c );\
+		NAME##_sort2( a, b );\
+		NAME##_sort2( b, c );\
+		NAME##_sort2( a, b );\
 	}\
-	embed T##N T##N##_max4( T##N const a, T##N const b, T##N const c, T##N const d )\
+	/* gives up, returning no, once more than 8 elements had to move */\
+	embed flag NAME##_insertion( TYPE ref const begin, TYPE ref const end, flag const partial )\
 	{\
-		out MAX4( a, b, c, d );\
+		temp n8 moved = 0;\
+		for( temp TYPE ref current = begin + 1; current < end; ++current )\
+		{\
+			temp TYPE ref sift = current;\
+			next_if( not LESS( val_of( sift ), sift[ -1 ] ) );\
+			temp TYPE const value = val_of( sift );\
+			do\
+			{\
+				val_of( sift ) = sift[ -1 ];\
+				--sift;\
+			}\
+			while( sift > begin and LESS( value, sift[ -1 ] ) );\
+			val_of( sift ) = value;\
+			moved += current - sift;\
+			out_if( partial and moved > 8 ) no;\
+		}\
+		out yes;\
 	}\
-	embed T##N T##N##_max5( T##N const a, T##N const b, T##N const c, T##N const d, T##N const e )\
+	fn NAME##_heap( TYPE ref const begin, TYPE ref const end )\
 	{\
-		out MAX5( a, b, c, d, e );\
+		temp n8 const size = end - begin;\
+		temp n8 parent = size / 2;\
+		temp n8 stop = size;\
+		while( stop > 1 )\
+		{\
+			if( parent > 0 ) --parent;\
+			else NAME##_swap( begin, begin + --stop );\
+			temp n8 root = parent;\
+			loop\
+			{\
+				temp n8 child = root * 2 + 1;\
+				skip_if( child >= stop );\
+				if( child + 1 < stop and LESS( begin[ child ], begin[ child + 1 ] ) ) ++child;\
+				skip_if( not LESS( begin[ root ], begin[ child ] ) );\
+				NAME##_swap( begin + root, begin + child );\
+				root = child;\
+			}\
+		}\
 	}\
-	embed T##N T##N##_median( T##N const a, T##N const b, T##N const c )\
+	/* elements equal to the pivot go left; returns the pivot position */\
+	embed TYPE ref NAME##_partition_left( TYPE ref const begin, TYPE ref const end )\
 	{\
-		out MEDIAN( a, b, c );\
+		temp TYPE const pivot = val_of( begin );\
+		temp TYPE ref first = begin;\
+		temp TYPE ref last = end;\
+		while( LESS( pivot, val_of( --last ) ) );\
+		if( last + 1 is end ) while( first < last and not LESS( pivot, val_of( ++first ) ) );\
+		else while( not LESS( pivot, val_of( ++first ) ) );\
+		while( first < last )\
+		{\
+			NAME##_swap( first, last );\
+			while( LESS( pivot, val_of( --last ) ) );\
+			while( not LESS( pivot, val_of( ++first ) ) );\
+		}\
+		val_of( begin ) = val_of( last );\
+		val_of( last ) = pivot;\
+		out last;\
 	}\
-	embed T##N T##N##_median5( T##N const a, T##N const b, T##N const c, T##N const d, T##N const e )\
+	/* elements equal to the pivot go right; notes whether no swaps were needed */\
+	embed TYPE ref NAME##_partition_right( TYPE ref const begin, TYPE ref const end, flag ref const partitioned )\
 	{\
-		out MEDIAN5( a, b, c, d, e );\
+		temp TYPE const pivot = val_of( begin );\
+		temp TYPE ref first = begin;\
+		temp TYPE ref last = end;\
+		while( LESS( val_of( ++first ), pivot ) );\
+		if( first - 1 is begin ) while( first < last and not LESS( val_of( --last ), pivot ) );\
+		else while( not LESS( val_of( --last ), pivot ) );\
+		val_of( partitioned ) = first >= last;\
+		while( first < last )\
+		{\
+			NAME##_swap( first, last );\
+			while( LESS( val_of( ++first ), pivot ) );\
+			while( not LESS( val_of( --last ), pivot ) );\
+		}\
+		temp TYPE ref const pivot_ref = first - 1;\
+		val_of( begin ) = val_of( pivot_ref );\
+		val_of( pivot_ref ) = pivot;\
+		out pivot_ref;\
 	}\
-	embed T##N T##N##_avg3( T##N const a, T##N const b, T##N const c )\
+	fn NAME##_loop( TYPE ref begin, TYPE ref const end, n4 bad_allowed, flag leftmost )\
 	{\
-		out AVG3( a, b, c );\
+		loop\
+		{\
+			temp n8 const size = end - begin;\
+			if( size < _SORT_INSERTION )\
+			{\
+				NAME##_insertion( begin, end, no );\
+				out;\
+			}\
+			temp n8 const half = size / 2;\
+			if( size > _SORT_NINTHER )\
+			{\
+				NAME##_sort3( begin, begin + half, end - 1 );\
+				NAME##_sort3( begin + 1, begin + half - 1, end - 2 );\
+				NAME##_sort3( begin + 2, begin + half + 1, end - 3 );\
+				NAME##_sort3( begin + half - 1, begin + half, begin + half + 1 );\
+				NAME##_swap( begin, begin + half );\
+			}\
+			else NAME##_sort3( begin + half, begin, end - 1 );\
+			if( not leftmost and not LESS( begin[ -1 ], val_of( begin ) ) )\
+			{\
+				begin = NAME##_partition_left( begin, end ) + 1;\
+				next;\
+			}\
+			flag partitioned;\
+			temp TYPE ref const pivot = NAME##_partition_right( begin, end, ref_of( partitioned ) );\
+			temp n8 const left_size = pivot - begin;\
+			temp n8 const right_size = end - ( pivot + 1 );\
+			if( left_size < size / 8 or right_size < size / 8 )\
+			{\
+				if( --bad_allowed is 0 )\
+				{\
+					NAME##_heap( begin, end );\
+					out;\
+				}\
+				if( left_size >= _SORT_INSERTION )\
+				{\
+					NAME##_swap( begin, begin + left_size / 4 );\
+					NAME##_swap( pivot - 1, pivot - left_size / 4 );\
+				}\
+				if( right_size >= _SORT_INSERTION )\
+				{\
+					NAME##_swap( pivot + 1, pivot + 1 + right_size / 4 );\
+					NAME##_swap( end - 1, end - right_size / 4 );\
+				}\
+			}\
+			else if( partitioned and NAME##_insertion( begin, pivot, yes ) and NAME##_insertion( pivot + 1, end, yes ) ) out;\
+			NAME##_loop( begin, pivot, bad_allowed, leftmost );\
+			begin = pivot + 1;\
+			leftmost = no;\
+		}\
 	}\
-	embed T##N T##N##_clamp( T##N const v, T##N const min, T##N const max )\
+	fn NAME( TYPE ref const values, n8 const count )\
 	{\
-		out CLAMP( v, min, max );\
+		out_if( count < 2 );\
+		NAME##_loop( values, values + count, 64 - n8_clz( count ), yes );\
+	}
+
+#pragma endregion compare
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - radix
+
+// LSD radix sorts over 8-bit digits, skipping digits every key shares; signed keys flip the sign bit,
+// and floats flip all bits when negative (so -0 sorts before 0, and NaNs go to the ends)
+// T_sort( values, count ) for every NIR type, and T_sort_parallel, which splits on the highest
+// differing digit over the worker threads, then sorts each bucket on its own
+
+#ifndef H_SORT_PARALLEL_MIN
+	#define H_SORT_PARALLEL_MIN 65536
+#endif
+
+////////////////////////////////
+#pragma region | radix / hidden
+
+#define _RADIX_SMALL 128
+
+enum
+{
+	_RADIX_N,
+	_RADIX_I,
+	_RADIX_R
+};
+
+#define _SORT_LESS( A, B ) ( ( A ) < ( B ) )
+
+#define _GEN_RADIX( N )\
+	sort_define( _radix_small_n##N, n##N, _SORT_LESS );\
+	fn _radix_flip_n##N( n##N ref const values, n8 const count, n1 const kind, flag const forward )\
+	{\
+		temp n##N const sign = to( n##N, 1 ) << ( N * 8 - 1 );\
+		if( kind is _RADIX_I ) iter( i, count ) values[ i ] ^= sign;\
+		else if( kind is _RADIX_R and forward ) iter( i, count ) values[ i ] ^= to( n##N, -to( n##N, values[ i ] >> ( N * 8 - 1 ) ) ) | sign;\
+		else if( kind is _RADIX_R ) iter( i, count ) values[ i ] ^= to( n##N, ( values[ i ] >> ( N * 8 - 1 ) ) - 1 ) | sign;\
 	}\
-	embed T##N T##N##_saturate( T##N const v )\
+	/* sorts by the low `digits` bytes, ping-ponging through `scratch`; the result ends in `keys` */\
+	fn _radix_lsd_n##N( n##N ref const keys, n##N ref const scratch, n8 const count, n4 const digits )\
 	{\
-		out SATURATE( v );\
+		if( count <= _RADIX_SMALL )\
+		{\
+			_radix_small_n##N( keys, count );\
+			out;\
+		}\
+		n8 counts[ N ][ 256 ];\
+		bytes_clear( counts, size_of( counts ) );\
+		iter( i, count )\
+		{\
+			temp n##N const key = keys[ i ];\
+			iter( d, N ) ++counts[ d ][ ( key >> ( d * 8 ) ) & 0xFF ];\
+		}\
+		temp n##N ref from = keys;\
+		temp n##N ref to = scratch;\
+		iter( d, digits )\
+		{\
+			temp n8 ref const offsets = counts[ d ];\
+			temp n4 const shift = d * 8;\
+			next_if( offsets[ ( from[ 0 ] >> shift ) & 0xFF ] is count );\
+			temp n8 total = 0;\
+			iter( b, 256 )\
+			{\
+				temp n8 const bucket = offsets[ b ];\
+				offsets[ b ] = total;\
+				total += bucket;\
+			}\
+			iter( i, count )\
+			{\
+				temp n##N const key = from[ i ];\
+				to[ offsets[ ( key >> shift ) & 0xFF ]++ ] = key;\
+			}\
+			temp n##N ref const swap = from;\
+			from = to;\
+			to = swap;\
+		}\
+		if( from isnt keys ) bytes_copy( keys, from, count * N );\
 	}\
-	embed T##N T##N##_sqr( T##N const v )\
+	fn _radix_sort_n##N( n##N ref const values, n8 const count, n1 const kind )\
 	{\
-		out SQR( v );\
+		out_if( count < 2 );\
+		temp n##N ref const scratch = pick( count <= _RADIX_SMALL, nothing, os_create_ref( n##N, count ) );\
+		_radix_flip_n##N( values, count, kind, yes );\
+		if_nothing( scratch ) _radix_small_n##N( values, count );\
+		else\
+		{\
+			_radix_lsd_n##N( values, scratch, count, N );\
+			_free( scratch );\
+		}\
+		_radix_flip_n##N( values, count, kind, no );\
 	}\
-	embed T##N T##N##_cube( T##N const v )\
+	type_from( variant _radix_job_n##N ) _radix_job_n##N;\
+	variant _radix_job_n##N\
 	{\
-		out CUBE( v );\
+		n##N ref values;\
+		n##N ref scratch;\
+		n8 count;\
+		n8 chunk;\
+		n8 ref counts;\
+		n##N differ[ 256 ];\
+		n##N firsts[ 256 ];\
+		n8 starts[ 257 ];\
+		n4 shift;\
+		n1 kind;\
+		flag forward;\
+	};\
+	fn _radix_job_flip_n##N( anon ref const context, n8 const index )\
+	{\
+		temp _radix_job_n##N ref const job = context;\
+		temp n8 const begin = index * job->chunk;\
+		temp n8 const size = MIN( job->chunk, job->count - begin );\
+		_radix_flip_n##N( job->values + begin, size, job->kind, job->forward );\
+		out_if( not job->forward );\
+		temp n##N differ = 0;\
+		temp n##N const first = job->values[ begin ];\
+		iter( i, size ) differ |= job->values[ begin + i ] ^ first;\
+		job->differ[ index ] = differ;\
+		job->firsts[ index ] = first;\
+	}\
+	fn _radix_job_count_n##N( anon ref const context, n8 const index )\
+	{\
+		temp _radix_job_n##N ref const job = context;\
+		temp n8 const begin = index * job->chunk;\
+		temp n8 const end = MIN( begin + job->chunk, job->count );\
+		temp n8 ref const counts = job->counts + index * 256;\
+		bytes_clear( counts, 256 * size_of( n8 ) );\
+		for( temp n8 i = begin; i < end; ++i ) ++counts[ ( job->values[ i ] >> job->shift ) & 0xFF ];\
+	}\
+	fn _radix_job_scatter_n##N( anon ref const context, n8 const index )\
+	{\
+		temp _radix_job_n##N ref const job = context;\
+		temp n8 const begin = index * job->chunk;\
+		temp n8 const end = MIN( begin + job->chunk, job->count );\
+		temp n8 ref const offsets = job->counts + index * 256;\
+		for( temp n8 i = begin; i < end; ++i )\
+		{\
+			temp n##N const key = job->values[ i ];\
+			job->scratch[ offsets[ ( key >> job->shift ) & 0xFF ]++ ] = key;\
+		}\
+	}\
+	fn _radix_job_bucket_n##N( anon ref const context, n8 const index )\
+	{\
+		temp _radix_job_n##N ref const job = context;\
+		temp n8 const begin = job->starts[ index ];\
+		temp n8 const size = job->starts[ index + 1 ] - begin;\
+		out_if( size is 0 );\
+		_radix_lsd_n##N( job->scratch + begin, job->values + begin, size, job->shift / 8 );\
+		bytes_copy( job->values + begin, job->scratch + begin, size * N );\
+	}\
+	fn _radix_sort_parallel_n##N( n##N ref const values, n8 const count, n1 const kind )\
+	{\
+		temp n8 const chunks = MIN( os_cpu_count() * 4, 256 );\
+		temp n##N ref const scratch = pick( count < H_SORT_PARALLEL_MIN or chunks <= 4, nothing, os_create_ref( n##N, count ) );\
+		temp n8 ref const counts = pick( scratch is nothing, nothing, os_create_ref( n8, chunks * 256 ) );\
+		if( counts is nothing )\
+		{\
+			if_something( scratch ) _free( scratch );\
+			_radix_sort_n##N( values, count, kind );\
+			out;\
+		}\
+		_radix_job_n##N job = { .values = values, .scratch = scratch, .count = count, .counts = counts, .kind = kind, .forward = yes };\
+		job.chunk = ( count + chunks - 1 ) / chunks;\
+		temp n8 const jobs = ( count + job.chunk - 1 ) / job.chunk;\
+		os_run_jobs( _radix_job_flip_n##N, ref_of( job ), jobs );\
+		temp n##N differ = 0;\
+		iter( j, jobs ) differ |= job.differ[ j ] | ( job.firsts[ j ] ^ job.firsts[ 0 ] );\
+		if( differ isnt 0 )\
+		{\
+			job.shift = ( ( 63 - n8_clz( differ ) ) / 8 ) * 8;\
+			os_run_jobs( _radix_job_count_n##N, ref_of( job ), jobs );\
+			temp n8 total = 0;\
+			iter( b, 256 )\
+			{\
+				job.starts[ b ] = total;\
+				iter( j, jobs )\
+				{\
+					temp n8 const bucket = counts[ j * 256 + b ];\
+					counts[ j * 256 + b ] = total;\
+					total += bucket;\
+				}\
+			}\
+			job.starts[ 256 ] = total;\
+			os_run_jobs( _radix_job_scatter_n##N, ref_of( job ), jobs );\
+			os_run_jobs( _radix_job_bucket_n##N, ref_of( job ), 256 );\
+		}\
+		job.forward = no;\
+		os_run_jobs( _radix_job_flip_n##N, ref_of( job ), jobs );\
+		_free( counts );\
+		_free( scratch );\
+	}
+
+_GEN_RADIX( 1 );
+_GEN_RADIX( 2 );
+_GEN_RADIX( 4 );
+_GEN_RADIX( 8 );
+
+#define _GEN_SORT( T, N, KIND )\
+	fn T##N##_sort( T##N ref const values, n8 const count )\
+	{\
+		_radix_sort_n##N( to( n##N ref, values ), count, KIND );\
+	}\
+	fn T##N##_sort_parallel( T##N ref const values, n8 const count )\
+	{\
+		_radix_sort_parallel_n##N( to( n##N ref, values ), count, KIND );\
+	}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | radix / visible
+
+_GEN_SORT( n, 1, _RADIX_N );
+_GEN_SORT( n, 2, _RADIX_N );
+_GEN_SORT( n, 4, _RADIX_N );
+_GEN_SORT( n, 8, _RADIX_N );
+_GEN_SORT( i, 1, _RADIX_I );
+_GEN_SORT( i, 2, _RADIX_I );
+_GEN_SORT( i, 4, _RADIX_I );
+_GEN_SORT( i, 8, _RADIX_I );
+_GEN_SORT( r, 4, _RADIX_R );
+_GEN_SORT( r, 8, _RADIX_R );
+
+#pragma endregion visible
+///
+
+#pragma endregion radix
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - records
+
+// `sort_records( RECORDS, COUNT, FIELD )` stably sorts an array of records by one NIR field,
+// with a radix sort of ( key, index ) pairs followed by a single gather of the records
+
+////////////////////////////////
+#pragma region | records / hidden
+
+type_from( variant _sort_pair ) _sort_pair;
+variant _sort_pair
+{
+	n8 key;
+	n8 index;
+};
+
+#define _SORT_KIND( FIELD ) _Generic( ( FIELD ),\
+	n1: 0x10, n2: 0x20, n4: 0x40, n8: 0x80,\
+	i1: 0x11, i2: 0x21, i4: 0x41, i8: 0x81,\
+	r4: 0x42, r8: 0x82 )
+
+embed n8 _sort_record_key( byte const ref const field, n1 const kind )
+{
+	temp n4 const size = kind >> 4;
+	n8 key = 0;
+	bytes_copy( ref_of( key ), field, size );
+	#if __BYTE_ORDER__ is __ORDER_BIG_ENDIAN__
+		key >>= 64 - size * 8;
+	#endif
+	temp n8 const sign = to( n8, 1 ) << ( size * 8 - 1 );
+	if( ( kind & 3 ) is _RADIX_I ) key ^= sign;
+	else if( ( kind & 3 ) is _RADIX_R ) key ^= pick( key & sign, ( sign << 1 ) - 1, sign );
+	out key;
+}
+
+embed flag _sort_records( anon ref const records, n8 const count, n8 const size, n8 const offset, n1 const kind )
+{
+	out_if( count < 2 ) yes;
+	temp _sort_pair ref const pairs = os_create_ref( _sort_pair, count * 2 );
+	temp byte ref const gathered = pick( pairs is nothing, nothing, to( byte ref, _alloc( count * size ) ) );
+	if_nothing( gathered )
+	{
+		if_something( pairs ) _free( pairs );
+		out no;
+	}
+	temp byte ref const bytes = records;
+	iter( i, count )
+	{
+		pairs[ i ].key = _sort_record_key( bytes + i * size + offset, kind );
+		pairs[ i ].index = i;
+	}
+
+	temp n4 const digits = kind >> 4;
+	n8 counts[ 8 ][ 256 ];
+	bytes_clear( counts, size_of( counts ) );
+	iter( i, count ) iter( d, digits ) ++counts[ d ][ ( pairs[ i ].key >> ( d * 8 ) ) & 0xFF ];
+	temp _sort_pair ref from = pairs;
+	temp _sort_pair ref to = pairs + count;
+	iter( d, digits )
+	{
+		temp n8 ref const offsets = counts[ d ];
+		temp n4 const shift = d * 8;
+		next_if( offsets[ ( from[ 0 ].key >> shift ) & 0xFF ] is count );
+		temp n8 total = 0;
+		iter( b, 256 )
+		{
+			temp n8 const bucket = offsets[ b ];
+			offsets[ b ] = total;
+			total += bucket;
+		}
+		iter( i, count ) to[ offsets[ ( from[ i ].key >> shift ) & 0xFF ]++ ] = from[ i ];
+		temp _sort_pair ref const swap = from;
+		from = to;
+		to = swap;
+	}
+
+	iter( i, count ) bytes_copy( gathered + i * size, bytes + from[ i ].index * size, size );
+	bytes_copy( bytes, gathered, count * size );
+	_free( gathered );
+	_free( pairs );
+	out yes;
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | records / visible
+
+#define sort_records( RECORDS, COUNT, FIELD )\
+	_sort_records( RECORDS, COUNT, size_of( val_of( RECORDS ) ), offsetof( type_of( val_of( RECORDS ) ), FIELD ), _SORT_KIND( ( RECORDS )->FIELD ) )
+
+#pragma endregion visible
+///
+
+#pragma endregion records
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - search
+
+// over ascending arrays: T_lower_bound is the first position whose value is not below `key`,
+// T_upper_bound the first above it, and T_equal_range both; the loops halve without branching,
+// and T_lower_bound_batch walks 8 keys in lockstep so their cache misses overlap
+// T_eytzinger lays a sorted array out as a breadth-first tree in `to[ 1 ... count ]`, which
+// T_eytzinger_lower_bound searches, prefetching the descendants one cache line of levels ahead;
+// it gives the layout position, or 0 when every value is below `key`
+
+////////////////////////////////
+#pragma region | search / hidden
+
+#define _SEARCH_BATCH 8
+
+#define _GEN_SEARCH_BOUND( T, N, NAME, LESS )\
+	embed n8 T##N##_##NAME( T##N const ref const values, n8 const count, T##N const key )\
+	{\
+		out_if( count is 0 ) 0;\
+		temp T##N const ref base = values;\
+		temp n8 size = count;\
+		while( size > 1 )\
+		{\
+			temp n8 const half = size / 2;\
+			prefetch( base + half / 2 );\
+			prefetch( base + half + half / 2 );\
+			base = pick( LESS( base[ half ], key ), base + half, base );\
+			size -= half;\
+		}\
+		out n8( base - values ) + LESS( val_of( base ), key );\
+	}
+
+#define _SEARCH_LOWER( VALUE, KEY ) ( ( VALUE ) < ( KEY ) )
+#define _SEARCH_UPPER( VALUE, KEY ) ( ( VALUE ) <= ( KEY ) )
+
+#define _GEN_SEARCH( T, N )\
+	_GEN_SEARCH_BOUND( T, N, lower_bound, _SEARCH_LOWER )\
+	_GEN_SEARCH_BOUND( T, N, upper_bound, _SEARCH_UPPER )\
+	embed n8 T##N##_equal_range( T##N const ref const values, n8 const count, T##N const key, n8 ref const end )\
+	{\
+		temp n8 const begin = T##N##_lower_bound( values, count, key );\
+		val_of( end ) = begin + T##N##_upper_bound( values + begin, count - begin, key );\
+		out begin;\
+	}\
+	fn T##N##_lower_bound_batch( T##N const ref const values, n8 const count, T##N const ref const keys, n8 const key_count, n8 ref const results )\
+	{\
+		for( temp n8 first = 0; first < key_count; first += _SEARCH_BATCH )\
+		{\
+			temp n8 const group = MIN( _SEARCH_BATCH, key_count - first );\
+			T##N const ref base[ _SEARCH_BATCH ];\
+			iter( j, group ) base[ j ] = values;\
+			temp n8 size = count;\
+			while( size > 1 )\
+			{\
+				temp n8 const half = size / 2;\
+				iter( j, group )\
+				{\
+					prefetch( base[ j ] + half / 2 );\
+					prefetch( base[ j ] + half + half / 2 );\
+				}\
+				iter( j, group ) base[ j ] = pick( base[ j ][ half ] < keys[ first + j ], base[ j ] + half, base[ j ] );\
+				size -= half;\
+			}\
+			iter( j, group ) results[ first + j ] = n8( base[ j ] - values ) + ( count > 0 and val_of( base[ j ] ) < keys[ first + j ] );\
+		}\
+	}\
+	embed n8 _##T##N##_eytzinger_fill( T##N ref const to, T##N const ref const from, n8 const count, n8 at, n8 const position )\
+	{\
+		out_if( position > count ) at;\
+		at = _##T##N##_eytzinger_fill( to, from, count, at, position * 2 );\
+		to[ position ] = from[ at++ ];\
+		out _##T##N##_eytzinger_fill( to, from, count, at, position * 2 + 1 );\
+	}\
+	fn T##N##_eytzinger( T##N ref const to, T##N const ref const from, n8 const count )\
+	{\
+		_##T##N##_eytzinger_fill( to, from, count, 0, 1 );\
+	}\
+	embed n8 T##N##_eytzinger_lower_bound( T##N const ref const layout, n8 const count, T##N const key )\
+	{\
+		temp n8 position = 1;\
+		while( position <= count )\
+		{\
+			prefetch( layout + position * ( 64 / N ) );\
+			position = position * 2 + ( layout[ position ] < key );\
+		}\
+		out position >> ( n8_ctz( ~position ) + 1 );\
+	}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | search / visible
+
+_GEN_SEARCH( n, 1 );
+_GEN_SEARCH( n, 2 );
+_GEN_SEARCH( n, 4 );
+_GEN_SEARCH( n, 8 );
+_GEN_SEARCH( i, 1 );
+_GEN_SEARCH( i, 2 );
+_GEN_SEARCH( i, 4 );
+_GEN_SEARCH( i, 8 );
+_GEN_SEARCH( r, 4 );
+_GEN_SEARCH( r, 8 );
+
+#pragma endregion visible
+///
+
+#pragma endregion search
+////
+
+#pragma endregion sort
+/////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma region - PROFILE
+//
+
+////////////////////////////////////////////////////////////////
+#pragma region - zones
+
+// `profile( "name" );` opens a zone that lasts until its enclosing block is left, however it is left,
+// so `skip` / `next` / `out` behave the same with profiling on or off: `{ profile( "decode" ); ... }`
+// `profile_begin( "name" )` / `profile_end( "name" )` mark a zone by hand
+// begin / end events go into a per-thread buffer, and the buffers are written as Chrome trace JSON
+// to H_PROFILE_PATH at exit (or by `profile_export()`)
+// needs H_PROFILE 1 before including H.h, otherwise all of these compile to nothing
+
+#ifndef H_PROFILE
+	#define H_PROFILE 0
+#endif
+
+#ifndef H_PROFILE_PATH
+	#define H_PROFILE_PATH "profile.json"
+#endif
+
+#if H_PROFILE
+
+////////////////////////////////
+#pragma region | zones / hidden
+
+#define _PROFILE_BLOCK_EVENTS 4096
+
+type( _profile_event )
+{
+	n8 time_ns;
+	byte const ref name;
+	byte phase;
+};
+
+type_from( variant _profile_block ) _profile_block;
+variant _profile_block
+{
+	_profile_block ref after;
+	n4 count;
+	_profile_event events[ _PROFILE_BLOCK_EVENTS ];
+};
+
+type_from( variant _profile_thread ) _profile_thread;
+variant _profile_thread
+{
+	_profile_thread ref after;
+	_profile_block ref first;
+	_profile_block ref last;
+	n4 id;
+};
+
+perm _profile_thread ref _profile_threads = nothing;
+perm n4 _profile_thread_count = 0;
+perm flag _profile_exporting = no;
+perm thread_local _profile_thread ref _profile_current = nothing;
+
+fn profile_export();
+
+embed _profile_thread ref _profile_thread_get()
+{
+	out_if_something( _profile_current ) _profile_current;
+	temp _profile_thread ref const thread = os_create_ref( _profile_thread );
+	out_if_nothing( thread ) nothing;
+	thread->id = atomic_add( ref_of( _profile_thread_count ), 1 ) + 1;
+	if( thread->id is 1 ) atexit( profile_export );
+	thread->after = atomic_load( ref_of( _profile_threads ) );
+	until( atomic_compare_swap( ref_of( _profile_threads ), ref_of( thread->after ), thread ) );
+	_profile_current = thread;
+	out thread;
+}
+
+fn _profile_record( byte const ref const name, byte const phase )
+{
+	temp n8 const now = os_time_ns();
+	temp _profile_thread ref const thread = _profile_thread_get();
+	out_if_nothing( thread );
+	temp _profile_block ref block = thread->last;
+	if( block is nothing or block->count is _PROFILE_BLOCK_EVENTS )
+	{
+		block = os_create_ref( _profile_block );
+		out_if_nothing( block );
+		if_nothing( thread->last ) thread->first = block;
+		else atomic_store( ref_of( thread->last->after ), block );
+		thread->last = block;
+	}
+	temp _profile_event ref const event = block->events + block->count;
+	event->time_ns = now;
+	event->name = name;
+	event->phase = phase;
+	atomic_store( ref_of( block->count ), block->count + 1 );
+}
+
+embed byte const ref _profile_zone_begin( byte const ref const name )
+{
+	_profile_record( name, 'B' );
+	out name;
+}
+
+fn _profile_zone_end( byte const ref const ref const zone )
+{
+	_profile_record( val_of( zone ), 'E' );
+}
+
+#define _profile( NAME, ZONE ) __attribute__( ( cleanup( _profile_zone_end ) ) ) byte const ref const ZONE = _profile_zone_begin( NAME )
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | zones / visible
+
+#define profile( NAME ) _profile( NAME, JOIN( _PROFILE_, __COUNTER__ ) )
+#define profile_begin( NAME ) _profile_record( NAME, 'B' )
+#define profile_end( NAME ) _profile_record( NAME, 'E' )
+
+fn profile_export()
+{
+	out_if( atomic_swap( ref_of( _profile_exporting ), yes ) );
+	temp os_handle const handle = fopen( H_PROFILE_PATH, "wb" );
+	if_nothing( handle )
+	{
+		atomic_store( ref_of( _profile_exporting ), no );
+		out;
+	}
+	fputs( "{\"traceEvents\":[" newline, handle );
+	temp flag first_event = yes;
+	byte line[ 512 ];
+	for( temp _profile_thread ref thread = atomic_load( ref_of( _profile_threads ) ); thread isnt nothing; thread = thread->after )
+	{
+		for( temp _profile_block ref block = thread->first; block isnt nothing; block = atomic_load( ref_of( block->after ) ) )
+		{
+			temp n4 const count = atomic_load( ref_of( block->count ) );
+			iter( i, count )
+			{
+				temp _profile_event const ref const event = block->events + i;
+				temp byte ref write = line;
+				if( not first_event ) bytes_paste_move( write, "," newline );
+				first_event = no;
+				bytes_paste_move( write, "{\"name\":\"" );
+				for( temp byte const ref c = event->name; val_of( c ) isnt eof_byte and write < line + 400; ++c )
+				{
+					if( val_of( c ) is '"' or val_of( c ) is '\\' ) bytes_set_move( write, '\\' );
+					bytes_set_move( write, val_of( c ) );
+				}
+				bytes_paste_move( write, "\",\"ph\":\"" );
+				bytes_set_move( write, event->phase );
+				bytes_paste_move( write, "\",\"pid\":1,\"tid\":" );
+				n4_to_bytes_move( thread->id, write );
+				bytes_paste_move( write, ",\"ts\":" );
+				n8_to_bytes_move( event->time_ns / 1000, write );
+				bytes_set_move( write, '.' );
+				temp n2 const fraction = event->time_ns mod 1000;
+				bytes_set_move( write, '0' + fraction / 100 );
+				bytes_set_move( write, '0' + ( fraction / 10 ) mod 10 );
+				bytes_set_move( write, '0' + fraction mod 10 );
+				bytes_set_move( write, '}' );
+				fwrite( line, 1, write - line, handle );
+			}
+		}
 	}
+	fputs( newline "]}" newline, handle );
+	fclose( handle );
+	atomic_store( ref_of( _profile_exporting ), no );
+}
+
+#pragma endregion visible
+///
+
+#else
+
+#define profile( NAME ) REQUIRE_SEMICOLON
+#define profile_begin( NAME ) REQUIRE_SEMICOLON
+#define profile_end( NAME ) REQUIRE_SEMICOLON
+#define profile_export() REQUIRE_SEMICOLON
+
+#endif
+
+#pragma endregion zones
+////
+
+////////////////////////////////////////////////////////////////
+#pragma region - bench
+
+// `bench( "name" ) { ... }` registers a benchmark whose block is one operation, and
+// `bench_start` defines `main` to run them: `program [filter] [-cpu N] [-csv PATH]`
+// inside the block, `bench_bytes( SIZE )` sets the bytes per operation for bytes/s,
+// and `keep_alive( VALUE )` stops the compiler from removing unused results
+
+#ifndef H_BENCH_SAMPLES
+	#define H_BENCH_SAMPLES 101
+#endif
+
+#ifndef H_BENCH_SAMPLE_NS
+	#define H_BENCH_SAMPLE_NS 1000000
+#endif
+
+#ifndef H_BENCH_WARMUP_NS
+	#define H_BENCH_WARMUP_NS 50000000
+#endif
+
+#ifndef H_BENCH_CSV_PATH
+	#define H_BENCH_CSV_PATH "bench.csv"
+#endif
+
+////////////////////////////////
+#pragma region | bench / hidden
 
-#define FUNCTION_GROUP_BASE_NI( T, N )\
-	embed T##N T##N##_median4( T##N const a, T##N const b, T##N const c, T##N const d )\
-	{\
-		out MEDIAN4_BITWISE( a, b, c, d );\
-	}\
-	embed T##N T##N##_avg( T##N const a, T##N const b )\
-	{\
-		out AVG_BITWISE( a, b );\
-	}\
-	embed T##N T##N##_avg4( T##N const a, T##N const b, T##N const c, T##N const d )\
+type_from( variant bench_case ) bench_case;
+variant bench_case
+{
+	bench_case ref after;
+	byte const ref name;
+	anon( ref run )( n8 const iterations, bench_case ref const this_bench );
+	n8 bytes;
+	n8 iterations;
+	r8 min_ns;
+	r8 median_ns;
+	r8 p99_ns;
+	r8 mean_ns;
+};
+
+perm bench_case ref _bench_first = nothing;
+perm bench_case ref _bench_last = nothing;
+
+fn _bench_register( bench_case ref const this_bench )
+{
+	if_nothing( _bench_first ) _bench_first = this_bench;
+	else _bench_last->after = this_bench;
+	_bench_last = this_bench;
+}
+
+#define _bench( NAME, ID )\
+	fn JOIN( ID, _body )( bench_case ref const this_bench );\
+	perm anon ID( n8 const iterations, bench_case ref const this_bench )\
 	{\
-		out AVG4_BITWISE( a, b, c, d );\
+		iter( i, iterations ) JOIN( ID, _body )( this_bench );\
 	}\
-	embed T##N T##N##_random()\
+	perm bench_case JOIN( ID, _case ) = { .name = NAME, .run = ID };\
+	__attribute__( ( constructor ) ) perm anon JOIN( ID, _register )()\
 	{\
-		out T##N( rand() );\
+		_bench_register( ref_of( JOIN( ID, _case ) ) );\
 	}\
-	embed T##N T##N##_random_range( T##N const minimum, T##N const maximum )\
-	{\
-		out minimum + T##N( ( r4( rand() ) / r4( RAND_MAX ) ) * r4( maximum - minimum + 1 ) );\
+	fn JOIN( ID, _body )( __attribute__( ( unused ) ) bench_case ref const this_bench )
+
+embed r8 _bench_sample( bench_case ref const this_bench, n8 const iterations )
+{
+	temp n8 const start_ns = os_time_ns();
+	this_bench->run( iterations, this_bench );
+	out r8( os_time_ns() - start_ns );
+}
+
+fn _bench_measure( bench_case ref const this_bench )
+{
+	// warm up while doubling the iterations until one sample takes H_BENCH_SAMPLE_NS
+	temp n8 iterations = 1;
+	temp n8 const warmup_end = os_time_ns() + H_BENCH_WARMUP_NS;
+	loop
+	{
+		temp r8 const elapsed = _bench_sample( this_bench, iterations );
+		if( elapsed >= H_BENCH_SAMPLE_NS )
+		{
+			iterations = n8_max( 1, n8( r8( iterations ) * H_BENCH_SAMPLE_NS / elapsed ) );
+			if( os_time_ns() >= warmup_end ) skip;
+		}
+		else if( elapsed < H_BENCH_SAMPLE_NS / 2 ) iterations *= 2;
+		else if( os_time_ns() >= warmup_end ) skip;
 	}
 
-#define FUNCTION_GROUP_BASE_IR( T, N )\
-	embed T##N T##N##_abs( T##N const v )\
-	{\
-		out ABS( v );\
-	}\
-	embed T##N T##N##_sign( T##N const v )\
+	r8 samples[ H_BENCH_SAMPLES ];
+	temp r8 total = 0;
+	iter( i, H_BENCH_SAMPLES )
+	{
+		temp r8 const elapsed = _bench_sample( this_bench, iterations );
+		total += elapsed;
+		temp r8 const sample = elapsed / r8( iterations );
+		temp i8 at = i;
+		while( at > 0 and samples[ at - 1 ] > sample )
+		{
+			samples[ at ] = samples[ at - 1 ];
+			--at;
+		}
+		samples[ at ] = sample;
+	}
+
+	this_bench->iterations = iterations;
+	this_bench->min_ns = samples[ 0 ];
+	this_bench->median_ns = samples[ H_BENCH_SAMPLES / 2 ];
+	this_bench->p99_ns = samples[ ( H_BENCH_SAMPLES - 1 ) * 99 / 100 ];
+	this_bench->mean_ns = total / ( r8( iterations ) * H_BENCH_SAMPLES );
+}
+
+// writes VAL with two decimals, then pads with spaces up to WIDTH bytes from the cell start
+#define _bench_cell_move( TO_REF, VAL, WIDTH )\
+	START_DEF\
 	{\
-		out SIGN( v );\
+		temp byte ref const _CELL = TO_REF;\
+		temp n8 const _HUNDREDTHS = n8( ( VAL ) * 100.0 + 0.5 );\
+		n8_to_bytes_move( _HUNDREDTHS / 100, TO_REF );\
+		bytes_set_move( TO_REF, '.' );\
+		bytes_set_move( TO_REF, '0' + ( _HUNDREDTHS / 10 ) mod 10 );\
+		bytes_set_move( TO_REF, '0' + _HUNDREDTHS mod 10 );\
+		while( TO_REF < _CELL + ( WIDTH ) ) bytes_set_move( TO_REF, ' ' );\
 	}\
-	embed T##N T##N##_sign_zero( T##N const v )\
-	{\
-		out SIGN_ZERO( v );\
+	END_DEF
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | bench / visible
+
+#define bench( NAME ) _bench( NAME, JOIN( _bench_, __COUNTER__ ) )
+#define bench_bytes( SIZE ) ( this_bench->bytes = ( SIZE ) )
+
+#if COMPILER_GCC
+	#define keep_alive( VALUE ) __asm__ volatile( "" : : "g"( VALUE ) : "memory" )
+#else
+	perm anon const ref volatile _keep_alive_sink = nothing;
+	#define keep_alive( VALUE ) ( _keep_alive_sink = ref_of( VALUE ) )
+#endif
+
+embed flag bench_pin_cpu( n4 const cpu )
+{
+	#if OS_LINUX
+		cpu_set_t set;
+		CPU_ZERO( ref_of( set ) );
+		CPU_SET( cpu, ref_of( set ) );
+		out sched_setaffinity( 0, size_of( set ), ref_of( set ) ) is 0;
+	#elif OS_WINDOWS
+		out SetThreadAffinityMask( GetCurrentThread(), to( DWORD_PTR, 1 ) << cpu ) isnt 0;
+	#else
+		out no;
+	#endif
+}
+
+// runs every benchmark whose name contains `filter` (or all, if nothing)
+// prints a table to stdout, and writes CSV to `csv_path` unless it is nothing
+embed out_state bench_run( byte const ref const filter, byte const ref const csv_path )
+{
+	temp os_handle const csv = pick( csv_path is nothing, nothing, fopen( csv_path, "wb" ) );
+	if( csv_path isnt nothing and csv is nothing ) out failure;
+	if_something( csv ) fputs( "name,iterations,min_ns,median_ns,p99_ns,ns_per_op,bytes_per_second" newline, csv );
+
+	print( "name                            min ns      median ns   p99 ns      ns/op       MB/s" newline );
+	byte line[ 512 ];
+	for( temp bench_case ref this_bench = _bench_first; this_bench isnt nothing; this_bench = this_bench->after )
+	{
+		if( filter isnt nothing and strstr( this_bench->name, filter ) is nothing ) next;
+		_bench_measure( this_bench );
+		temp r8 const bytes_per_second = pick( this_bench->bytes is 0, 0, r8( this_bench->bytes ) * 1e9 / this_bench->mean_ns );
+
+		temp byte ref write = line;
+		temp n8 const name_size = n8_min( bytes_measure( this_bench->name ), 200 );
+		bytes_copy_move( write, this_bench->name, name_size );
+		do bytes_set_move( write, ' ' );
+		while( write < line + 32 );
+		_bench_cell_move( write, this_bench->min_ns, 12 );
+		_bench_cell_move( write, this_bench->median_ns, 12 );
+		_bench_cell_move( write, this_bench->p99_ns, 12 );
+		_bench_cell_move( write, this_bench->mean_ns, 12 );
+		if( this_bench->bytes isnt 0 ) _bench_cell_move( write, bytes_per_second / 1e6, 0 );
+		while( val_of( write - 1 ) is ' ' ) --write;
+		bytes_newline_move( write );
+		print_count( line, write - line );
+		print_show();
+
+		if_nothing( csv ) next;
+		write = line;
+		write += bytes_escape_csv( write, this_bench->name, name_size );
+		bytes_set_move( write, ',' );
+		n8_to_bytes_move( this_bench->iterations, write );
+		bytes_set_move( write, ',' );
+		_bench_cell_move( write, this_bench->min_ns, 0 );
+		bytes_set_move( write, ',' );
+		_bench_cell_move( write, this_bench->median_ns, 0 );
+		bytes_set_move( write, ',' );
+		_bench_cell_move( write, this_bench->p99_ns, 0 );
+		bytes_set_move( write, ',' );
+		_bench_cell_move( write, this_bench->mean_ns, 0 );
+		bytes_set_move( write, ',' );
+		n8_to_bytes_move( n8( bytes_per_second ), write );
+		bytes_newline_move( write );
+		fwrite( line, 1, write - line, csv );
 	}
 
-#define FUNCTION_GROUP_N( N )\
-	FUNCTION_GROUP_BASE( n, N );\
-	FUNCTION_GROUP_BASE_NI( n, N )
+	if_something( csv ) fclose( csv );
+	out success;
+}
 
-#define FUNCTION_GROUP_I( N )\
-	FUNCTION_GROUP_BASE( i, N );\
-	FUNCTION_GROUP_BASE_NI( i, N );\
-	FUNCTION_GROUP_BASE_IR( i, N )
+// the whole argument, so a shorter one such as "-c" is never read past its end
+#define _bench_is_option( INPUT, OPTION ) ( bytes_measure( INPUT ) is size_of_bytes( OPTION ) and bytes_match( INPUT, OPTION ) )
 
-#define FUNCTION_GROUP_R( N )\
-	FUNCTION_GROUP_BASE( r, N );\
-	FUNCTION_GROUP_BASE_IR( r, N );\
-	embed r##N r##N##_median4( const r##N a, const r##N b, const r##N c, const r##N d )\
-	{\
-		out MEDIAN4( a, b, c, d );\
-	}\
-	embed r##N r##N##_avg( const r##N a, const r##N b )\
-	{\
-		out AVG( a, b );\
-	}\
-	embed r##N r##N##_avg4( const r##N a, const r##N b, const r##N c, const r##N d )\
-	{\
-		out AVG4( a, b, c, d );\
-	}\
-	embed r##N r##N##_mix( const r##N a, const r##N b, const r##N amount )\
-	{\
-		out MIX( a, b, amount );\
-	}\
-	embed r##N r##N##_map( const r##N v, const r##N from_lower, const r##N from_upper, const r##N to_lower, const r##N to_upper )\
-	{\
-		out MAP( v, from_lower, from_upper, to_lower, to_upper );\
-	}\
-	embed r##N r##N##_range( const r##N v, const r##N lower, const r##N upper )\
-	{\
-		out RANGE( v, lower, upper );\
-	}\
-	embed r##N r##N##_random()\
-	{\
-		out r##N( rand() );\
-	}\
-	embed r##N r##N##_random_unit()\
+#define bench_start\
+	_start_fn\
 	{\
-		out r##N##_random() / r##N( RAND_MAX );\
-	}\
-	embed r##N r##N##_random_range( const r##N minimum, const r##N maximum )\
-	{\
-		out minimum + r##N##_random_unit() * ( maximum - minimum );\
+		temp byte const ref filter = nothing;\
+		temp byte const ref csv_path = H_BENCH_CSV_PATH;\
+		for( temp i4 i = 1; i < start_inputs_count; ++i )\
+		{\
+			if( _bench_is_option( start_inputs[ i ], "-cpu" ) and i + 1 < start_inputs_count )\
+			{\
+				if( not bench_pin_cpu( atoi( start_inputs[ ++i ] ) ) ) print( "bench: could not pin the cpu" newline );\
+			}\
+			else if( _bench_is_option( start_inputs[ i ], "-csv" ) and i + 1 < start_inputs_count ) csv_path = start_inputs[ ++i ];\
+			else filter = start_inputs[ i ];\
+		}\
+		out bench_run( filter, csv_path );\
 	}
 
-FUNCTION_GROUP_N( 1 );
-FUNCTION_GROUP_I( 1 );
+#pragma endregion visible
+///
 
-FUNCTION_GROUP_N( 2 );
-FUNCTION_GROUP_I( 2 );
+#pragma endregion bench
+////
 
-FUNCTION_GROUP_N( 4 );
-FUNCTION_GROUP_I( 4 );
-FUNCTION_GROUP_R( 4 );
-#define r4_trunc truncf
-#define r4_floor floorf
-#define r4_ceil ceilf
-#define r4_round roundf
-#define r4_mod fmodf
-#define r4_sqrt sqrtf
-#define r4_pow powf
-#define r4_sincos sincosf
-#define r4_sin sinf
-#define r4_cos cosf
-#define r4_tan tanf
-#define r4_asin asinf
-#define r4_acos acosf
-#define r4_atan atanf
-#define r4_atanyx atan2f
+////////////////////////////////////////////////////////////////
+#pragma region - sampling
 
-FUNCTION_GROUP_N( 8 );
-FUNCTION_GROUP_I( 8 );
-FUNCTION_GROUP_R( 8 );
-#define r8_round round
-#define r8_trunc trunc
-#define r8_floor floor
-#define r8_ceil ceil
-#define r8_mod fmod
-#define r8_sqrt sqrt
-#define r8_pow pow
-#define r8_sincos sincos
-#define r8_sin sin
-#define r8_cos cos
-#define r8_tan tan
-#define r8_asin asin
-#define r8_acos acos
-#define r8_atan atan
-#define r8_atanyx atan2
+// `profiler_start( hz )` samples the calling thread's stack on every 1 / hz seconds of its cpu time,
+// and `profiler_thread_start()` adds other threads; `profiler_stop( path )` stops all of them,
+// resolves the symbols and writes folded stacks ("main;work;leaf count") for flamegraph tools
+// symbol names need -rdynamic; H_PROFILER_FRAME_POINTERS walks frame pointers instead of backtrace()
+// (build with -fno-omit-frame-pointer); Linux only, elsewhere `profiler_start` returns no
 
-#pragma endregion functions
+#ifndef H_PROFILER_SAMPLES
+	#define H_PROFILER_SAMPLES 65536
+#endif
+
+#ifndef H_PROFILER_DEPTH
+	#define H_PROFILER_DEPTH 62
+#endif
+
+#ifndef H_PROFILER_THREADS
+	#define H_PROFILER_THREADS 256
+#endif
+
+#ifndef H_PROFILER_FRAME_POINTERS
+	#if defined( __GLIBC__ )
+		#define H_PROFILER_FRAME_POINTERS 0
+	#else
+		#define H_PROFILER_FRAME_POINTERS 1
+	#endif
+#endif
+
+#if OS_LINUX
+
+////////////////////////////////
+#pragma region | sampling / hidden
+
+#ifndef sigev_notify_thread_id
+	#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+// each sample is a depth followed by H_PROFILER_DEPTH frames, leaf first; depth 0 is unwritten
+#define _PROFILER_STRIDE ( H_PROFILER_DEPTH + 2 )
+
+perm n8 ref _profiler_samples = nothing;
+perm n8 _profiler_count = 0;
+perm flag _profiler_active = no;
+perm n4 _profiler_in_flight = 0;
+perm n8 _profiler_interval_ns = 0;
+perm timer_t _profiler_timers[ H_PROFILER_THREADS ];
+perm n4 _profiler_timer_count = 0;
+
+embed n8 _profiler_context_pc( ucontext_t const ref const context )
+{
+	#if defined( __x86_64__ )
+		out context->uc_mcontext.gregs[ REG_RIP ];
+	#elif defined( __i386__ )
+		out context->uc_mcontext.gregs[ REG_EIP ];
+	#elif defined( __aarch64__ )
+		out context->uc_mcontext.pc;
+	#else
+		out 0;
+	#endif
+}
+
+embed n4 _profiler_walk( n8 ref const frames, ucontext_t const ref const context )
+{
+	temp n8 const pc = _profiler_context_pc( context );
+	temp n4 depth = 0;
+	if( pc isnt 0 ) frames[ depth++ ] = pc;
+	#if H_PROFILER_FRAME_POINTERS
+		temp n8 fp = 0;
+		#if defined( __x86_64__ )
+			fp = context->uc_mcontext.gregs[ REG_RBP ];
+		#elif defined( __i386__ )
+			fp = context->uc_mcontext.gregs[ REG_EBP ];
+		#elif defined( __aarch64__ )
+			fp = context->uc_mcontext.regs[ 29 ];
+		#endif
+		// a frame record is { previous fp, return address }; stop on anything that does not walk up the stack
+		while( depth < H_PROFILER_DEPTH and fp isnt 0 and ( fp & ( size_of( anon ref ) - 1 ) ) is 0 )
+		{
+			temp anon ref const ref const record = to( anon ref const ref, fp );
+			temp n8 const caller = to( n8, record[ 1 ] ), previous = to( n8, record[ 0 ] );
+			out_if( caller is 0 ) depth;
+			frames[ depth++ ] = caller;
+			skip_if( previous <= fp or previous - fp > ( 1 << 20 ) );
+			fp = previous;
+		}
+	#else
+		// backtrace() sees this handler and the signal trampoline first, so start at the interrupted pc
+		anon ref found[ H_PROFILER_DEPTH + 8 ];
+		temp i4 const count = backtrace( found, H_PROFILER_DEPTH + 8 );
+		temp i4 first = 0;
+		while( first < count and first < 8 and to( n8, found[ first ] ) isnt pc ) ++first;
+		first = pick( first < count and first < 8, first + 1, MIN( 3, count ) );
+		for( temp i4 i = first; i < count and depth < H_PROFILER_DEPTH; ++i ) frames[ depth++ ] = to( n8, found[ i ] );
+	#endif
+	out depth;
+}
+
+perm anon _profiler_signal( i4 const signal, siginfo_t ref const info, anon ref const context )
+{
+	( anon )signal;
+	( anon )info;
+	// counted before `_profiler_active` is read, so `profiler_stop` can wait for this handler to leave
+	atomic_add( ref_of( _profiler_in_flight ), 1 );
+	atomic_fence();
+	if( atomic_load_relaxed( ref_of( _profiler_active ) ) )
+	{
+		temp i4 const saved_errno = errno;
+		temp n8 const index = atomic_add( ref_of( _profiler_count ), 1 );
+		if( index < H_PROFILER_SAMPLES )
+		{
+			temp n8 ref const sample = _profiler_samples + index * _PROFILER_STRIDE;
+			atomic_store( sample, _profiler_walk( sample + 1, context ) );
+		}
+		errno = saved_errno;
+	}
+	atomic_sub( ref_of( _profiler_in_flight ), 1 );
+}
+
+hash_map_bytes( _profiler_stacks, n8 );
+hash_map_n8( _profiler_symbols, n4 );
+
+// "name" from "module(name+0x1f) [0x...]", or "module+0x1f" when the symbol is not exported
+embed n4 _profiler_symbol_add( intern_table ref const names, byte const ref const text )
+{
+	temp byte const ref const open = strchr( text, '(' );
+	temp byte const ref const plus = pick( open is nothing, nothing, strchr( open, '+' ) );
+	temp byte const ref const close = pick( open is nothing, nothing, strchr( open, ')' ) );
+	byte name[ 256 ];
+	temp n8 size = 0;
+	if( open isnt nothing and plus isnt nothing and plus < close and plus > open + 1 )
+	{
+		size = MIN( n8( plus - open - 1 ), size_of( name ) - 1 );
+		bytes_copy( name, open + 1, size );
+	}
+	else
+	{
+		temp byte const ref module = text;
+		temp byte const ref const module_end = pick( open is nothing, text + bytes_measure( text ), open );
+		for( temp byte const ref c = text; c < module_end; ++c ) if( val_of( c ) is '/' ) module = c + 1;
+		size = MIN( n8( module_end - module ), size_of( name ) - 1 );
+		bytes_copy( name, module, size );
+		if( plus isnt nothing and close isnt nothing and plus < close )
+		{
+			temp n8 const offset_size = MIN( n8( close - plus ), size_of( name ) - 1 - size );
+			bytes_copy( name + size, plus, offset_size );
+			size += offset_size;
+		}
+	}
+	iter( i, size ) if( name[ i ] is ';' or name[ i ] is ' ' ) name[ i ] = '_';
+	out intern_add( names, name, size );
+}
+
+#pragma endregion hidden
+///
+
+////////////////////////////////
+#pragma region | sampling / visible
+
+embed flag profiler_thread_start()
+{
+	out_if( _profiler_samples is nothing ) no;
+	temp n4 const slot = atomic_add( ref_of( _profiler_timer_count ), 1 );
+	out_if( slot >= H_PROFILER_THREADS ) no;
+	struct sigevent event;
+	bytes_clear( ref_of( event ), size_of( event ) );
+	event.sigev_notify = SIGEV_THREAD_ID;
+	event.sigev_signo = SIGPROF;
+	event.sigev_notify_thread_id = syscall( SYS_gettid );
+	out_if( timer_create( CLOCK_THREAD_CPUTIME_ID, ref_of( event ), _profiler_timers + slot ) isnt 0 ) no;
+	struct itimerspec spec;
+	spec.it_interval.tv_sec = _profiler_interval_ns / 1000000000ull;
+	spec.it_interval.tv_nsec = _profiler_interval_ns mod 1000000000ull;
+	spec.it_value = spec.it_interval;
+	out timer_settime( _profiler_timers[ slot ], 0, ref_of( spec ), nothing ) is 0;
+}
+
+embed flag profiler_start( n4 const hz )
+{
+	out_if( hz is 0 or _profiler_samples isnt nothing ) no;
+	_profiler_samples = os_create_ref( n8, n8( H_PROFILER_SAMPLES ) * _PROFILER_STRIDE );
+	out_if_nothing( _profiler_samples ) no;
+	bytes_clear( _profiler_samples, n8( H_PROFILER_SAMPLES ) * _PROFILER_STRIDE * size_of( n8 ) );
+	_profiler_count = 0;
+	_profiler_timer_count = 0;
+	_profiler_interval_ns = MAX( 1000000000ull / hz, 1000 );
+	#if not H_PROFILER_FRAME_POINTERS
+		// the first backtrace() loads the unwinder, which is not safe inside a signal handler
+		anon ref warm[ 1 ];
+		backtrace( warm, 1 );
+	#endif
+	struct sigaction action;
+	bytes_clear( ref_of( action ), size_of( action ) );
+	action.sa_sigaction = _profiler_signal;
+	action.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset( ref_of( action.sa_mask ) );
+	sigaction( SIGPROF, ref_of( action ), nothing );
+	atomic_store( ref_of( _profiler_active ), yes );
+	out profiler_thread_start();
+}
+
+// the SIGPROF handler stays installed, so late signals are ignored rather than fatal
+embed flag profiler_stop( byte const ref const path )
+{
+	out_if( _profiler_samples is nothing ) no;
+	atomic_store( ref_of( _profiler_active ), no );
+	atomic_fence();
+	temp n4 const timers = MIN( atomic_load( ref_of( _profiler_timer_count ) ), H_PROFILER_THREADS );
+	iter( i, timers ) timer_delete( _profiler_timers[ i ] );
+	// a handler already past the `_profiler_active` check on another thread may still be writing a sample
+	while( atomic_load( ref_of( _profiler_in_flight ) ) ) atomic_pause();
+	temp n8 const count = MIN( atomic_load( ref_of( _profiler_count ) ), H_PROFILER_SAMPLES );
+
+	// name each distinct address once, then fold the stacks of names
+	_profiler_symbols symbols = _profiler_symbols_create( 4096 );
+	iter( i, count )
+	{
+		temp n8 const ref const sample = _profiler_samples + i * _PROFILER_STRIDE;
+		iter( f, atomic_load( sample ) ) _profiler_symbols_set( ref_of( symbols ), sample[ 1 + f ], intern_none );
+	}
+	anon ref ref addresses = os_create_ref( anon ref, symbols.count + 1 );
+	temp n8 address_count = 0;
+	iter_hash_map( s, symbols ) addresses[ address_count++ ] = to( anon ref, symbols.slots[ s ].key );
+	intern_table names = { 0 };
+	#if defined( __GLIBC__ )
+		temp byte ref ref const texts = pick( address_count is 0, nothing, backtrace_symbols( addresses, address_count ) );
+	#else
+		temp byte ref ref const texts = nothing;
+	#endif
+	iter( a, address_count )
+	{
+		byte text[ 24 ] = "0x";
+		if_nothing( texts ) hex_n8_to_bytes( to( n8, addresses[ a ] ), text + 2 );
+		temp n4 const name = _profiler_symbol_add( ref_of( names ), pick( texts is nothing, text, texts[ a ] ) );
+		_profiler_symbols_set( ref_of( symbols ), to( n8, addresses[ a ] ), name );
+	}
+	if_something( texts ) free( texts );
+
+	_profiler_stacks stacks = _profiler_stacks_create( 1024 );
+	iter( i, count )
+	{
+		temp n8 ref const sample = _profiler_samples + i * _PROFILER_STRIDE;
+		temp n8 const depth = sample[ 0 ];
+		next_if( depth is 0 );
+		// a frame whose name could not be interned has no entry in `names`, so its stack is dropped
+		temp flag named = yes;
+		iter( f, depth )
+		{
+			temp n4 const ref const found = _profiler_symbols_find( ref_of( symbols ), sample[ 1 + f ] );
+			temp n4 const name = pick( found is nothing, intern_none, val_of( found ) );
+			named = named and name isnt intern_none;
+			sample[ 1 + f ] = name;
+		}
+		next_if( not named );
+		temp n8 ref const total = _profiler_stacks_insert( ref_of( stacks ), to( byte const ref, sample + 1 ), depth * size_of( n8 ) );
+		if_something( total ) ++val_of( total );
+	}
+
+	temp os_handle const handle = fopen( path, "wb" );
+	if_something( handle )
+	{
+		iter_hash_map( s, stacks )
+		{
+			temp n8 const ref const frames = to( n8 const ref, stacks.slots[ s ].key );
+			temp n8 const depth = stacks.slots[ s ].key_size / size_of( n8 );
+			for( temp i8 f = depth - 1; f >= 0; --f )
+			{
+				temp n4 const name = frames[ f ];
+				fwrite( intern_get( ref_of( names ), name ), 1, intern_size( ref_of( names ), name ), handle );
+				fputc( pick( f is 0, ' ', ';' ), handle );
+			}
+			byte digits[ 24 ];
+			temp byte ref write = digits;
+			n8_to_bytes_move( stacks.slots[ s ].value, write );
+			bytes_newline_move( write );
+			fwrite( digits, 1, write - digits, handle );
+		}
+		fclose( handle );
+	}
+
+	intern_delete( ref_of( names ) );
+	os_delete_ref( addresses );
+	_profiler_symbols_delete( ref_of( symbols ) );
+	_profiler_stacks_delete( ref_of( stacks ) );
+	os_delete_ref( _profiler_samples );
+	out handle isnt nothing;
+}
+
+#pragma endregion visible
+///
+
+#else
+
+embed flag profiler_thread_start() { out no; }
+
+embed flag profiler_start( n4 const hz )
+{
+	( anon )hz;
+	out no;
+}
+
+embed flag profiler_stop( byte const ref const path )
+{
+	( anon )path;
+	out no;
+}
+
+#endif
+
+#pragma endregion sampling
 ////
 
-#pragma endregion mathematics
+#pragma endregion profile
 /////
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
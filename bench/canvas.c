@@ -0,0 +1,201 @@
+// the canvas kernels: fill, blit, keyed blit, blend, scale and palette, each against a plain
+// per-pixel loop doing the same work, on a 1920 x 1080 target
+// from the repository root: gcc -O2 -I. bench/canvas.c -o bench_canvas -lm -lpthread && ./bench_canvas [filter] [-cpu N] [-csv PATH]
+
+#include <H.h>
+
+#define TARGET_WIDTH 1920
+#define TARGET_HEIGHT 1080
+#define SPRITE_SIZE 256
+#define TILE_SIZE 64
+#define INDEXED_WIDTH 320
+#define INDEXED_HEIGHT 200
+
+perm canvas target = { 0 };
+perm canvas frame = { 0 };
+perm canvas sprite = { 0 };
+perm canvas keyed = { 0 };
+perm canvas translucent = { 0 };
+perm canvas tile = { 0 };
+perm n1 indices[ INDEXED_WIDTH * INDEXED_HEIGHT ];
+perm n4 palette[ 256 ];
+perm n4 counter = 0;
+
+// opaque noise, the same with a quarter of it keyed out, and premultiplied noise of every alpha
+__attribute__( ( constructor ) ) perm anon setup()
+{
+	target = canvas_create( TARGET_WIDTH, TARGET_HEIGHT );
+	frame = canvas_create( TARGET_WIDTH, TARGET_HEIGHT );
+	sprite = canvas_create( SPRITE_SIZE, SPRITE_SIZE );
+	keyed = canvas_create( SPRITE_SIZE, SPRITE_SIZE );
+	translucent = canvas_create( SPRITE_SIZE, SPRITE_SIZE );
+	tile = canvas_create( TILE_SIZE, TILE_SIZE );
+	iter( i, n8( TARGET_WIDTH ) * TARGET_HEIGHT ) frame.pixels[ i ] = n4_random() | 0xFF000000u;
+	canvas_clear( ref_of( target ), rgba( 20, 40, 60, 255 ) );
+	iter( i, SPRITE_SIZE * SPRITE_SIZE )
+	{
+		temp n4 const color = n4_random();
+		sprite.pixels[ i ] = color | 0xFF000000u;
+		keyed.pixels[ i ] = pick( random_below_n4( 4 ) is 0, 0, color | 0xFF000000u );
+		translucent.pixels[ i ] = rgba_premultiply( color );
+	}
+	iter( i, TILE_SIZE * TILE_SIZE ) tile.pixels[ i ] = n4_random() | 0xFF000000u;
+	iter( i, INDEXED_WIDTH * INDEXED_HEIGHT ) indices[ i ] = n1( n4_random() );
+	iter( i, 256 ) palette[ i ] = n4_random() | 0xFF000000u;
+}
+
+__attribute__( ( destructor ) ) perm anon teardown()
+{
+	canvas_delete( ref_of( target ) );
+	canvas_delete( ref_of( frame ) );
+	canvas_delete( ref_of( sprite ) );
+	canvas_delete( ref_of( keyed ) );
+	canvas_delete( ref_of( translucent ) );
+	canvas_delete( ref_of( tile ) );
+}
+
+// `at_x`, `at_y` for a WIDTH x HEIGHT area, walking the target so each run starts on a different alignment
+#define WALK( WIDTH, HEIGHT ) temp i8 const at_x = i8( counter * 37 ) mod ( TARGET_WIDTH - ( WIDTH ) ), at_y = i8( counter++ * 11 ) mod ( TARGET_HEIGHT - ( HEIGHT ) )
+
+// the plain loops, one pixel at a time
+embed n4 plain_over( n4 const to, n4 const from )
+{
+	temp n4 const keep = 255 - ( from >> 24 );
+	temp n4 result = 0;
+	iter( c, 4 )
+	{
+		temp n4 const channel = ( ( to >> ( c * 8 ) ) & 0xFF ) * keep;
+		result |= ( ( ( from >> ( c * 8 ) ) & 0xFF ) + ( channel + 128 + ( ( channel + 128 ) >> 8 ) ) / 256 ) << ( c * 8 );
+	}
+	out result;
+}
+
+//
+
+bench( "fill 1920x1080" )
+{
+	bench_bytes( n8( TARGET_WIDTH ) * TARGET_HEIGHT * 4 );
+	canvas_clear( ref_of( target ), counter++ );
+	keep_alive( target.pixels[ 0 ] );
+}
+
+bench( "fill 1920x1080 plain" )
+{
+	bench_bytes( n8( TARGET_WIDTH ) * TARGET_HEIGHT * 4 );
+	temp n4 const color = counter++;
+	iter( y, TARGET_HEIGHT ) iter( x, TARGET_WIDTH ) canvas_at( ref_of( target ), x, y ) = color;
+	keep_alive( target.pixels[ 0 ] );
+}
+
+bench( "fill_rect 256x256" )
+{
+	bench_bytes( SPRITE_SIZE * SPRITE_SIZE * 4 );
+	WALK( SPRITE_SIZE, SPRITE_SIZE );
+	canvas_fill_rect( ref_of( target ), at_x, at_y, SPRITE_SIZE, SPRITE_SIZE, rgba( 255, 0, 0, 255 ) );
+	keep_alive( target.pixels[ 0 ] );
+}
+
+//
+
+bench( "blit 1920x1080" )
+{
+	bench_bytes( n8( TARGET_WIDTH ) * TARGET_HEIGHT * 4 );
+	canvas_blit( ref_of( target ), 0, 0, ref_of( frame ) );
+	keep_alive( target.pixels[ 0 ] );
+}
+
+bench( "blit 256x256" )
+{
+	bench_bytes( SPRITE_SIZE * SPRITE_SIZE * 4 );
+	WALK( SPRITE_SIZE, SPRITE_SIZE );
+	canvas_blit( ref_of( target ), at_x, at_y, ref_of( sprite ) );
+	keep_alive( target.pixels[ 0 ] );
+}
+
+bench( "blit 256x256 plain" )
+{
+	bench_bytes( SPRITE_SIZE * SPRITE_SIZE * 4 );
+	WALK( SPRITE_SIZE, SPRITE_SIZE );
+	iter( y, SPRITE_SIZE ) iter( x, SPRITE_SIZE ) canvas_at( ref_of( target ), at_x + x, at_y + y ) = canvas_at( ref_of( sprite ), x, y );
+	keep_alive( target.pixels[ 0 ] );
+}
+
+bench( "blit_keyed 256x256" )
+{
+	bench_bytes( SPRITE_SIZE * SPRITE_SIZE * 4 );
+	WALK( SPRITE_SIZE, SPRITE_SIZE );
+	canvas_blit_keyed( ref_of( target ), at_x, at_y, ref_of( keyed ), 0 );
+	keep_alive( target.pixels[ 0 ] );
+}
+
+bench( "blit_keyed 256x256 plain" )
+{
+	bench_bytes( SPRITE_SIZE * SPRITE_SIZE * 4 );
+	WALK( SPRITE_SIZE, SPRITE_SIZE );
+	iter( y, SPRITE_SIZE ) iter( x, SPRITE_SIZE )
+	{
+		temp n4 const color = canvas_at( ref_of( keyed ), x, y );
+		if( color isnt 0 ) canvas_at( ref_of( target ), at_x + x, at_y + y ) = color;
+	}
+	keep_alive( target.pixels[ 0 ] );
+}
+
+//
+
+bench( "blend 256x256" )
+{
+	bench_bytes( SPRITE_SIZE * SPRITE_SIZE * 4 );
+	WALK( SPRITE_SIZE, SPRITE_SIZE );
+	canvas_blend( ref_of( target ), at_x, at_y, ref_of( translucent ) );
+	keep_alive( target.pixels[ 0 ] );
+}
+
+bench( "blend 256x256 plain" )
+{
+	bench_bytes( SPRITE_SIZE * SPRITE_SIZE * 4 );
+	WALK( SPRITE_SIZE, SPRITE_SIZE );
+	iter( y, SPRITE_SIZE ) iter( x, SPRITE_SIZE )
+	{
+		temp n4 ref const to = ref_of( canvas_at( ref_of( target ), at_x + x, at_y + y ) );
+		val_of( to ) = plain_over( val_of( to ), canvas_at( ref_of( translucent ), x, y ) );
+	}
+	keep_alive( target.pixels[ 0 ] );
+}
+
+//
+
+bench( "scale 64x64 by 4" )
+{
+	bench_bytes( TILE_SIZE * TILE_SIZE * 16 * 4 );
+	WALK( SPRITE_SIZE, SPRITE_SIZE );
+	canvas_scale( ref_of( target ), at_x, at_y, ref_of( tile ), 4 );
+	keep_alive( target.pixels[ 0 ] );
+}
+
+bench( "scale 64x64 by 4 plain" )
+{
+	bench_bytes( TILE_SIZE * TILE_SIZE * 16 * 4 );
+	WALK( SPRITE_SIZE, SPRITE_SIZE );
+	iter( y, TILE_SIZE * 4 ) iter( x, TILE_SIZE * 4 ) canvas_at( ref_of( target ), at_x + x, at_y + y ) = canvas_at( ref_of( tile ), x / 4, y / 4 );
+	keep_alive( target.pixels[ 0 ] );
+}
+
+//
+
+bench( "from_palette 320x200" )
+{
+	bench_bytes( INDEXED_WIDTH * INDEXED_HEIGHT * 4 );
+	WALK( INDEXED_WIDTH, INDEXED_HEIGHT );
+	canvas_from_palette( ref_of( target ), at_x, at_y, indices, INDEXED_WIDTH, INDEXED_HEIGHT, INDEXED_WIDTH, palette );
+	keep_alive( target.pixels[ 0 ] );
+}
+
+bench( "from_palette 320x200 plain" )
+{
+	bench_bytes( INDEXED_WIDTH * INDEXED_HEIGHT * 4 );
+	WALK( INDEXED_WIDTH, INDEXED_HEIGHT );
+	iter( y, INDEXED_HEIGHT ) iter( x, INDEXED_WIDTH ) canvas_at( ref_of( target ), at_x + x, at_y + y ) = palette[ indices[ y * INDEXED_WIDTH + x ] ];
+	keep_alive( target.pixels[ 0 ] );
+}
+
+bench_start
@@ -0,0 +1,207 @@
+// the core bench suite: *_to_bytes conversions, the FUNCTION_GROUP math, bytes_* ops,
+// _alloc / _ref_resize, os_get_entries, and os_map_file against os_file_ref_load
+// from the repository root: gcc -O2 -I. bench/core.c -o bench_core -lm -lpthread && ./bench_core [filter] [-cpu N] [-csv PATH]
+
+#include <H.h>
+
+#define BENCH_FOLDER "bench_core_files"
+#define BENCH_FILE BENCH_FOLDER "/big.bin"
+#define BENCH_FILE_SIZE ( 16 << 20 )
+#define BENCH_FILES 200
+#define BENCH_VALUES 4096
+
+perm n8 counter = 0;
+perm r4 reals[ BENCH_VALUES ];
+perm n4 naturals[ BENCH_VALUES ];
+perm byte small_from[ 4096 ];
+perm byte small_to[ 4096 ];
+perm byte small_same[ 4096 ];
+perm byte ref large_from = nothing;
+perm byte ref large_to = nothing;
+
+// the inputs, a folder of BENCH_FILES small files and one BENCH_FILE_SIZE file
+__attribute__( ( constructor ) ) perm anon setup()
+{
+	iter( i, BENCH_VALUES )
+	{
+		reals[ i ] = r4_random_range( -1000.0f, 1000.0f );
+		naturals[ i ] = n4_random();
+	}
+	bytes_fill( small_from, 'a', size_of( small_from ) - 1 );
+	bytes_fill( small_same, 'a', size_of( small_same ) - 1 );
+	large_from = os_create_ref( byte, BENCH_FILE_SIZE );
+	large_to = os_create_ref( byte, BENCH_FILE_SIZE );
+	bytes_fill( large_from, 'a', BENCH_FILE_SIZE );
+
+	os_create_folder( BENCH_FOLDER );
+	byte path[ path_max_size ];
+	iter( i, BENCH_FILES )
+	{
+		bytes_format( path, size_of( path ), BENCH_FOLDER "/file_", n4( i ), ".txt" );
+		os_file file = os_create_file( path );
+		os_file_ref_save( ref_of( file ), path, bytes_measure( path ) );
+		os_file_ref_close( ref_of( file ) );
+	}
+	os_file file = os_create_file( BENCH_FILE );
+	os_file_ref_save( ref_of( file ), large_from, BENCH_FILE_SIZE );
+	os_file_ref_close( ref_of( file ) );
+}
+
+__attribute__( ( destructor ) ) perm anon teardown()
+{
+	os_delete_folder( BENCH_FOLDER );
+}
+
+//
+
+bench( "n8_to_bytes" )
+{
+	byte text[ 32 ];
+	n8_to_bytes( counter++ * 0x9E3779B97F4A7C15u, text );
+	keep_alive( text[ 0 ] );
+}
+
+bench( "i8_to_bytes" )
+{
+	byte text[ 32 ];
+	i8_to_bytes( i8( counter++ * 0x9E3779B97F4A7C15u ), text );
+	keep_alive( text[ 0 ] );
+}
+
+bench( "r4_to_bytes" )
+{
+	byte text[ 64 ];
+	r4_to_bytes( reals[ counter++ mod BENCH_VALUES ], text );
+	keep_alive( text[ 0 ] );
+}
+
+//
+
+bench( "r4_clamp x4096" )
+{
+	bench_bytes( size_of( reals ) );
+	temp r4 sum = 0;
+	iter( i, BENCH_VALUES ) sum += r4_clamp( reals[ i ], -10.0f, 10.0f );
+	keep_alive( sum );
+}
+
+bench( "r4_mix x4096" )
+{
+	bench_bytes( size_of( reals ) );
+	temp r4 sum = 0;
+	iter( i, BENCH_VALUES - 1 ) sum += r4_mix( reals[ i ], reals[ i + 1 ], 0.25f );
+	keep_alive( sum );
+}
+
+bench( "n4_median5 x4096" )
+{
+	bench_bytes( size_of( naturals ) );
+	temp n4 sum = 0;
+	iter( i, BENCH_VALUES - 4 ) sum += n4_median5( naturals[ i ], naturals[ i + 1 ], naturals[ i + 2 ], naturals[ i + 3 ], naturals[ i + 4 ] );
+	keep_alive( sum );
+}
+
+bench( "r4_sqrt x4096" )
+{
+	bench_bytes( size_of( reals ) );
+	temp r4 sum = 0;
+	iter( i, BENCH_VALUES ) sum += r4_sqrt( r4_abs( reals[ i ] ) );
+	keep_alive( sum );
+}
+
+//
+
+bench( "bytes_copy 4 KiB" )
+{
+	bench_bytes( size_of( small_from ) );
+	bytes_copy( small_to, small_from, size_of( small_from ) );
+	keep_alive( small_to[ 0 ] );
+}
+
+bench( "bytes_copy 16 MiB" )
+{
+	bench_bytes( BENCH_FILE_SIZE );
+	bytes_copy( large_to, large_from, BENCH_FILE_SIZE );
+	keep_alive( large_to[ 0 ] );
+}
+
+bench( "bytes_fill 4 KiB" )
+{
+	bench_bytes( size_of( small_to ) );
+	bytes_fill( small_to, n1( counter++ ), size_of( small_to ) );
+	keep_alive( small_to[ 0 ] );
+}
+
+bench( "bytes_compare 4 KiB" )
+{
+	bench_bytes( size_of( small_from ) );
+	temp i4 const order = bytes_compare( small_same, small_from, size_of( small_from ) );
+	keep_alive( order );
+}
+
+bench( "bytes_find 4 KiB" )
+{
+	bench_bytes( size_of( small_from ) );
+	temp anon const ref const found = bytes_find( small_from, 'z', size_of( small_from ) );
+	keep_alive( found );
+}
+
+bench( "bytes_measure 4 KiB" )
+{
+	bench_bytes( size_of( small_from ) );
+	temp n8 const size = bytes_measure( small_from );
+	keep_alive( size );
+}
+
+//
+
+bench( "_alloc + _free 64 B" )
+{
+	temp anon ref const block = _alloc( 64 );
+	keep_alive( block );
+	_free( block );
+}
+
+bench( "_alloc + _free 1 MiB" )
+{
+	temp anon ref const block = _alloc( 1 << 20 );
+	keep_alive( block );
+	_free( block );
+}
+
+bench( "_ref_resize 4 KiB to 1 MiB" )
+{
+	byte ref block = _alloc( 4096 );
+	for( n8 size = 8192; size <= ( 1 << 20 ); size *= 2 ) block = _ref_resize( block, size, yes );
+	keep_alive( block );
+	_free( block );
+}
+
+//
+
+bench( "os_get_entries 200 files" )
+{
+	perm byte entries[ BENCH_FILES + 8 ][ path_max_size ];
+	temp n2 const count = os_get_files( BENCH_FOLDER, entries, BENCH_FILES + 8 );
+	keep_alive( count );
+}
+
+bench( "os_file_ref_load 16 MiB" )
+{
+	bench_bytes( BENCH_FILE_SIZE );
+	os_file file = os_open_file( BENCH_FILE );
+	os_file_ref_load( ref_of( file ), large_to );
+	os_file_ref_close( ref_of( file ) );
+	keep_alive( large_to[ 0 ] );
+}
+
+bench( "os_map_file 16 MiB" )
+{
+	bench_bytes( BENCH_FILE_SIZE );
+	os_file file = os_map_file( BENCH_FILE );
+	bytes_copy( large_to, file.mapped_bytes, file.size );
+	os_file_ref_unmap( ref_of( file ) );
+	keep_alive( large_to[ 0 ] );
+}
+
+bench_start
@@ -0,0 +1,161 @@
+// round trips of compress_block and compress_frame, and truncated or corrupted input, which must
+// be rejected without reading or writing out of bounds (add -fsanitize=address to check that)
+// from the repository root: gcc -O2 -I. test/compress.c -o compress -lm -lpthread && ./compress
+
+#include <H.h>
+
+#define BLOCK_MOST MAX( H_COMPRESS_BLOCK, 1 << 17 )
+#define CONTENT_SIZE ( 3 * BLOCK_MOST + 12345 )
+#define FUZZ_ROUNDS 20000
+
+perm flag failed = no;
+
+fn fail( byte const ref const what, n8 const size )
+{
+	byte line[ 256 ];
+	bytes_format( line, size_of( line ), "FAIL ", what, " at size ", size, newline );
+	print( line );
+	failed = yes;
+}
+
+// zeros, then text-like runs, then noise, so every kind of token shows up
+fn fill_content( n1 ref const content, n8 const size )
+{
+	byte const ref const words[] = { "the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dogs " };
+	temp n8 at = 0;
+	while( at < size / 4 ) content[ at++ ] = 0;
+	while( at < size * 3 / 4 )
+	{
+		temp byte const ref word = words[ random_below_n4( 8 ) ];
+		while( val_of( word ) isnt eof_byte and at < size * 3 / 4 ) content[ at++ ] = val_of( word++ );
+	}
+	while( at < size ) content[ at++ ] = n1( random_below_n4( 256 ) );
+}
+
+// a copy in a buffer of exactly SIZE (1 for an empty one), so an over-read lands outside it
+embed n1 ref exact_copy( n1 const ref const from, n8 const size )
+{
+	temp n1 ref const copy = malloc( MAX( size, 1 ) );
+	bytes_copy( copy, from, size );
+	out copy;
+}
+
+fn check_blocks( n1 const ref const content )
+{
+	n8 const sizes[] = { 0, 1, 12, 13, 100, 4096, 65536 + 17, BLOCK_MOST };
+	temp n1 ref const stored = malloc( compress_bound( BLOCK_MOST ) );
+	temp n1 ref const unpacked = malloc( BLOCK_MOST );
+	iter( s, size_of( sizes ) / size_of( sizes[ 0 ] ) )
+	{
+		// the noise is at the end, so take each size from both ends
+		iter( side, 2 )
+		{
+			temp n8 const size = sizes[ s ];
+			temp n1 const ref const from = content + pick( side, CONTENT_SIZE - size, 0 );
+			temp n8 const stored_size = compress_block( stored, compress_bound( size ), from, size );
+			if( stored_size is 0 or stored_size > compress_bound( size ) )
+			{
+				fail( "compress_block", size );
+				next;
+			}
+			temp n1 ref const exact = exact_copy( stored, stored_size );
+			temp n8 const written = decompress_block( unpacked, size, exact, stored_size );
+			if( written isnt size or bytes_compare( unpacked, from, size ) isnt 0 ) fail( "block round trip", size );
+			if( size > 0 and decompress_block( unpacked, size - 1, exact, stored_size ) isnt codec_invalid ) fail( "block capacity", size );
+			free( exact );
+
+			// every prefix is malformed, since the last token always carries literals
+			if( size <= 4096 ) iter( cut, stored_size )
+			{
+				temp n1 ref const prefix = exact_copy( stored, cut );
+				temp n8 const result = decompress_block( unpacked, size, prefix, cut );
+				if( result isnt codec_invalid and result > size ) fail( "block prefix", cut );
+				free( prefix );
+			}
+		}
+	}
+	free( stored );
+	free( unpacked );
+}
+
+fn check_block_fuzz( n1 const ref const content )
+{
+	temp n8 const size = 4096;
+	n1 stored[ compress_bound( 4096 ) ];
+	n1 unpacked[ 4096 ];
+	temp n8 const stored_size = compress_block( stored, size_of( stored ), content + CONTENT_SIZE / 2, size );
+	iter( round, FUZZ_ROUNDS )
+	{
+		temp n1 ref const fuzzed = exact_copy( stored, stored_size );
+		iter( flips, 1 + random_below_n4( 4 ) ) fuzzed[ random_below_n4( n4( stored_size ) ) ] ^= n1( 1 + random_below_n4( 255 ) );
+		temp n8 const cut = stored_size - random_below_n4( 8 );
+		temp n8 const result = decompress_block( unpacked, size, fuzzed, cut );
+		if( result isnt codec_invalid and result > size ) fail( "block fuzz", round );
+		free( fuzzed );
+	}
+}
+
+fn check_frames( n1 const ref const content )
+{
+	n8 const sizes[] = { 0, 1, 4096, H_COMPRESS_BLOCK, H_COMPRESS_BLOCK + 1, CONTENT_SIZE };
+	temp n8 const most = compress_frame_bound( CONTENT_SIZE );
+	temp n1 ref const stored = malloc( most );
+	temp n1 ref const unpacked = malloc( CONTENT_SIZE );
+	iter( s, size_of( sizes ) / size_of( sizes[ 0 ] ) )
+	{
+		iter( checksum, 2 )
+		{
+			temp n8 const size = sizes[ s ];
+			// the blocks compress in place, so the frame must fit in a buffer of exactly the bound
+			temp n8 const bound = compress_frame_bound( size );
+			temp n1 ref const frame = malloc( bound );
+			if( compress_frame( frame, bound - 1, content, size, checksum ) isnt 0 ) fail( "frame bound", size );
+			temp n8 const stored_size = compress_frame( frame, bound, content, size, checksum );
+			bytes_copy( stored, frame, MIN( stored_size, bound ) );
+			free( frame );
+			if( stored_size is 0 or stored_size > bound )
+			{
+				fail( "compress_frame", size );
+				next;
+			}
+			temp n1 ref const exact = exact_copy( stored, stored_size );
+			if( decompress_frame_size( exact, stored_size ) isnt size ) fail( "frame size", size );
+			if( decompress_frame( unpacked, size, exact, stored_size ) isnt size or bytes_compare( unpacked, content, size ) isnt 0 ) fail( "frame round trip", size );
+			free( exact );
+
+			iter( cut, pick( size <= 4096, stored_size, MIN( stored_size, 64 ) ) )
+			{
+				temp n1 ref const prefix = exact_copy( stored, cut );
+				if( decompress_frame( unpacked, size, prefix, cut ) isnt codec_invalid ) fail( "frame prefix", cut );
+				free( prefix );
+			}
+		}
+	}
+
+	// with checksums, a corrupted frame gives codec_invalid or, when only unused bytes changed, the content
+	temp n8 const size = 4096;
+	temp n8 const stored_size = compress_frame( stored, most, content + CONTENT_SIZE / 2, size, yes );
+	iter( round, FUZZ_ROUNDS )
+	{
+		temp n1 ref const fuzzed = exact_copy( stored, stored_size );
+		fuzzed[ random_below_n4( n4( stored_size ) ) ] ^= n1( 1 + random_below_n4( 255 ) );
+		temp n8 const result = decompress_frame( unpacked, size, fuzzed, stored_size );
+		if( result isnt codec_invalid and ( result isnt size or bytes_compare( unpacked, content + CONTENT_SIZE / 2, size ) isnt 0 ) ) fail( "frame fuzz", round );
+		free( fuzzed );
+	}
+	free( stored );
+	free( unpacked );
+}
+
+start
+{
+	random_seed( 1 );
+	temp n1 ref const content = malloc( CONTENT_SIZE );
+	fill_content( content, CONTENT_SIZE );
+	check_blocks( content );
+	check_block_fuzz( content );
+	check_frames( content );
+	free( content );
+	print( pick( failed, "compress: failed" newline, "compress: ok" newline ) );
+	out pick( failed, failure, success );
+}
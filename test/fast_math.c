@@ -0,0 +1,163 @@
+// accuracy and throughput of the r4_fast_* functions against the libm mapping each one replaces
+// from the repository root: gcc -O2 -I. test/fast_math.c -o fast_math -lm -lpthread && ./fast_math
+
+#include <H.h>
+
+#define SAMPLES ( 1 << 22 )
+
+perm r4 first[ SAMPLES ];
+perm r4 second[ SAMPLES ];
+perm r4 fast[ SAMPLES ];
+perm r4 fast_other[ SAMPLES ];
+perm r4 exact[ SAMPLES ];
+perm flag failed = no;
+
+embed r8 ulp_error( r4 const value, r8 const expected )
+{
+	i4 exponent;
+	frexp( expected, ref_of( exponent ) );
+	out fabs( r8( value ) - expected ) / ldexp( 1.0, pick( exponent - 24 < -149, -149, exponent - 24 ) );
+}
+
+// spreads SAMPLES inputs from `low` to `high`: evenly over the bit patterns when both are positive,
+// so every binade is covered, and evenly over the values otherwise
+fn sweep( r4 ref const to_ref, r4 const low, r4 const high )
+{
+	temp n4 const from = r4_as_n4( low ), until = r4_as_n4( high );
+	iter( i, SAMPLES )
+	{
+		temp r8 const at = r8( i ) / r8( SAMPLES - 1 );
+		to_ref[ i ] = pick( low > 0, n4_as_r4( from + n4( r8( until - from ) * at ) ), r4( low + ( high - low ) * at ) );
+	}
+}
+
+fn report( byte const ref const name, r8 const error, r8 const bound, byte const ref const unit, n8 const fast_ns, n8 const libm_ns )
+{
+	temp flag const within = error <= bound;
+	failed = failed or not within;
+	byte line[ 256 ];
+	bytes_format( line, size_of( line ), format_left( name, 16 ), format_left( pick( within, "ok", "FAIL" ), 6 ), error, byte( ' ' ), unit, " (bound ", bound, ")" );
+	print( line );
+	if( fast_ns )
+	{
+		bytes_format( line, size_of( line ), "  ", r8( fast_ns ) / SAMPLES, " ns/op vs libm ", r8( libm_ns ) / SAMPLES, " ns/op" );
+		print( line );
+	}
+	print_newline();
+}
+
+// the array form must give the scalar results bit for bit
+fn check_same( byte const ref const name, r4 const ref const array_ref, r4 const ref const scalar_ref )
+{
+	iter( i, SAMPLES )
+	{
+		next_if( r4_as_n4( array_ref[ i ] ) is r4_as_n4( scalar_ref[ i ] ) );
+		print( name );
+		print( ": array form differs from the scalar form" newline );
+		failed = yes;
+		out;
+	}
+}
+
+#define TIME_NS( CODE ) ( { temp n8 const _BEFORE = os_time_ns(); CODE; keep_alive( fast[ 0 ] ); keep_alive( exact[ 0 ] ); os_time_ns() - _BEFORE; } )
+
+#define CHECK_UNARY( NAME, LIBM, REFERENCE, LOW, HIGH, BOUND )\
+	START_DEF\
+	{\
+		sweep( first, LOW, HIGH );\
+		temp n8 const fast_ns = TIME_NS( r4_fast_##NAME##_array( fast, first, SAMPLES ) );\
+		temp n8 const libm_ns = TIME_NS( iter( i, SAMPLES ) exact[ i ] = LIBM( first[ i ] ) );\
+		iter( i, SAMPLES ) fast_other[ i ] = r4_fast_##NAME( first[ i ] );\
+		check_same( #NAME, fast, fast_other );\
+		r8 error = 0;\
+		iter( i, SAMPLES ) error = r8_max( error, ulp_error( fast[ i ], REFERENCE( r8( first[ i ] ) ) ) );\
+		report( #NAME, error, BOUND, "ulp", fast_ns, libm_ns );\
+	}\
+	END_DEF
+
+#define reference_rsqrt( X ) ( 1.0 / sqrt( X ) )
+
+// accuracy over every binade of |x| <= pi, throughput on everyday angles (tiny ones hit subnormal stalls)
+fn check_sincos()
+{
+	sweep( first, 1.17549435e-38f, 3.14159265f );
+	iter( i, SAMPLES / 2 ) first[ i * 2 ] = -first[ i * 2 ];
+	r4_fast_sincos_array( fast, fast_other, first, SAMPLES );
+	r8 sin_error = 0, cos_error = 0;
+	iter( i, SAMPLES )
+	{
+		sin_error = r8_max( sin_error, ulp_error( fast[ i ], sin( r8( first[ i ] ) ) ) );
+		cos_error = r8_max( cos_error, ulp_error( fast_other[ i ], cos( r8( first[ i ] ) ) ) );
+	}
+	r4_fast_sin_array( exact, first, SAMPLES );
+	check_same( "sin", exact, fast );
+	r4_fast_cos_array( exact, first, SAMPLES );
+	check_same( "cos", exact, fast_other );
+	report( "sin", sin_error, 2, "ulp", 0, 0 );
+	report( "cos", cos_error, 2, "ulp", 0, 0 );
+
+	iter( i, SAMPLES ) first[ i ] = ( random_unit_r4() - 0.5f ) * 16384.0f;
+	temp n8 const fast_ns = TIME_NS( r4_fast_sincos_array( fast, fast_other, first, SAMPLES ) );
+	temp n8 const libm_ns = TIME_NS( iter( i, SAMPLES ) r4_sincos( first[ i ], exact + i, second + i ) );
+	r8 absolute = 0;
+	iter( i, SAMPLES )
+	{
+		absolute = r8_max( absolute, fabs( fast[ i ] - sin( r8( first[ i ] ) ) ) );
+		absolute = r8_max( absolute, fabs( fast_other[ i ] - cos( r8( first[ i ] ) ) ) );
+	}
+	report( "sincos 8192", absolute, 1e-7, "abs", fast_ns, libm_ns );
+}
+
+fn check_atanyx()
+{
+	iter( i, SAMPLES )
+	{
+		first[ i ] = ( random_unit_r4() - 0.5f ) * ldexpf( 1, i4( random_below_n4( 64 ) ) - 32 );
+		second[ i ] = ( random_unit_r4() - 0.5f ) * ldexpf( 1, i4( random_below_n4( 64 ) ) - 32 );
+	}
+	temp n8 const fast_ns = TIME_NS( r4_fast_atanyx_array( fast, first, second, SAMPLES ) );
+	temp n8 const libm_ns = TIME_NS( iter( i, SAMPLES ) exact[ i ] = r4_atanyx( first[ i ], second[ i ] ) );
+	iter( i, SAMPLES ) fast_other[ i ] = r4_fast_atanyx( first[ i ], second[ i ] );
+	check_same( "atanyx", fast, fast_other );
+	r8 error = 0;
+	iter( i, SAMPLES ) error = r8_max( error, ulp_error( fast[ i ], atan2( r8( first[ i ] ), r8( second[ i ] ) ) ) );
+	report( "atanyx", error, 3, "ulp", fast_ns, libm_ns );
+}
+
+fn check_pow()
+{
+	sweep( first, 1.0f / 16, 16.0f );
+	iter( i, SAMPLES )
+	{
+		temp r4 const reach = 4.0f / r4_max( fabsf( log2f( first[ i ] ) ), 1.0f / 1024 );
+		second[ i ] = ( random_unit_r4() * 2 - 1 ) * reach;
+	}
+	temp n8 const fast_ns = TIME_NS( r4_fast_pow_array( fast, first, second, SAMPLES ) );
+	temp n8 const libm_ns = TIME_NS( iter( i, SAMPLES ) exact[ i ] = r4_pow( first[ i ], second[ i ] ) );
+	iter( i, SAMPLES ) fast_other[ i ] = r4_fast_pow( first[ i ], second[ i ] );
+	check_same( "pow", fast, fast_other );
+	r8 error = 0;
+	iter( i, SAMPLES )
+	{
+		temp r8 const expected = pow( r8( first[ i ] ), r8( second[ i ] ) );
+		error = r8_max( error, fabs( fast[ i ] - expected ) / expected );
+	}
+	report( "pow", error, 7e-7, "rel", fast_ns, libm_ns );
+}
+
+start
+{
+	random_seed( 1 );
+	// fault the pages in, so the first timing does not pay for them
+	bytes_fill( second, 1, size_of( second ) );
+	bytes_fill( fast, 1, size_of( fast ) );
+	bytes_fill( fast_other, 1, size_of( fast_other ) );
+	bytes_fill( exact, 1, size_of( exact ) );
+	check_sincos();
+	check_atanyx();
+	CHECK_UNARY( exp2, exp2f, exp2, -126.0f, 127.99f, 2 );
+	CHECK_UNARY( log2, log2f, log2, 1.17549435e-38f, 3.40282347e38f, 3 );
+	CHECK_UNARY( rsqrt, 1.0f / r4_sqrt, reference_rsqrt, 1.17549435e-38f, 3.40282347e38f, 2 );
+	check_pow();
+	out pick( failed, failure, success );
+}
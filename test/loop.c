@@ -0,0 +1,254 @@
+// os_loop offline: socket pairs past one poll batch, a pipe drained by os_watch_on_data, a TCP echo
+// over 127.0.0.1, periodic timers, a timer closing another due in the same round, and wakeups from
+// another thread
+// from the repository root: gcc -O2 -I. test/loop.c -o loop -lm -lpthread && ./loop
+
+#include <H.h>
+
+#define PAIRS 150
+#define RUN_LIMIT_NS 5000000000ull
+
+perm flag failed = no;
+
+fn check( flag const passed, byte const ref const what )
+{
+	print( pick( passed, "ok    ", "FAIL  " ) );
+	print( what );
+	print_newline();
+	failed = failed or not passed;
+}
+
+// runs EVENT_LOOP until DONE_REF is set, giving no if that takes longer than RUN_LIMIT_NS
+embed flag run_until( os_loop ref const event_loop, flag const ref const done_ref )
+{
+	temp n8 const limit = os_time_ns() + RUN_LIMIT_NS;
+	while( not val_of( done_ref ) and os_time_ns() < limit ) os_loop_run_once( event_loop, 10 );
+	out val_of( done_ref );
+}
+
+////////////////////////////////
+// socket pairs: one byte through each of PAIRS pairs, more than the loop takes per round
+
+perm n4 pair_reads = 0;
+perm flag pairs_done = no;
+
+fn on_pair( os_watch ref const watch, n4 const events )
+{
+	if( events & os_event_read )
+	{
+		byte got[ 8 ];
+		while( os_watch_read( watch, got, size_of( got ) ) > 0 ) ++pair_reads;
+		os_watch_close( watch );
+		pairs_done = pair_reads is PAIRS;
+	}
+}
+
+fn check_pairs( os_loop ref const event_loop )
+{
+	os_socket writers[ PAIRS ];
+	temp n4 added = 0;
+	iter( i, PAIRS )
+	{
+		os_socket pair[ 2 ];
+		next_if( not os_create_socket_pair( pair ) );
+		writers[ i ] = pair[ 1 ];
+		added += os_loop_add( event_loop, pair[ 0 ], on_pair, nothing ) isnt nothing;
+	}
+	check( added is PAIRS, "socket pairs added" );
+	iter( i, PAIRS )
+	{
+		temp ssize_t const written = write( writers[ i ], "x", 1 );
+		( anon )written;
+	}
+	check( run_until( event_loop, ref_of( pairs_done ) ), "every socket pair read" );
+	iter( i, PAIRS ) close( writers[ i ] );
+}
+
+////////////////////////////////
+// pipe: the loop drains it into ON_DATA, then calls with size 0 at the end
+
+perm byte pipe_got[ 64 ];
+perm n8 pipe_size = 0;
+perm flag pipe_ended = no;
+
+fn on_pipe_data( os_watch ref const watch, byte const ref const bytes, n8 const size )
+{
+	if( size is 0 )
+	{
+		pipe_ended = yes;
+		os_watch_close( watch );
+		out;
+	}
+	bytes_copy( pipe_got + pipe_size, bytes, MIN( size, size_of( pipe_got ) - pipe_size ) );
+	pipe_size += MIN( size, size_of( pipe_got ) - pipe_size );
+}
+
+fn check_pipe( os_loop ref const event_loop )
+{
+	os_socket pipe[ 2 ];
+	check( os_create_pipe( pipe ), "pipe created" );
+	temp os_watch ref const watch = os_loop_add( event_loop, pipe[ 0 ], nothing, nothing );
+	check( watch isnt nothing, "pipe added" );
+	out_if_nothing( watch );
+	os_watch_on_data( watch, on_pipe_data );
+	temp ssize_t const written = write( pipe[ 1 ], "through the pipe", 16 );
+	( anon )written;
+	close( pipe[ 1 ] );
+	check( run_until( event_loop, ref_of( pipe_ended ) ), "pipe reached its end" );
+	check( pipe_size is 16 and bytes_compare( pipe_got, "through the pipe", 16 ) is 0, "pipe bytes arrived in order" );
+}
+
+////////////////////////////////
+// TCP: the server echoes, the client sends once connected and closes on the echo
+
+perm byte const echo_message[] = "ping over tcp";
+perm byte echo_got[ 64 ];
+perm n8 echo_size = 0;
+perm flag echo_sent = no;
+perm flag echo_done = no;
+
+fn on_server_data( os_watch ref const watch, byte const ref const bytes, n8 const size )
+{
+	if( size is 0 ) os_watch_close( watch );
+	else os_watch_write( watch, bytes, size );
+}
+
+fn on_listener( os_watch ref const listener, n4 const events )
+{
+	out_if( not( events & os_event_read ) );
+	loop
+	{
+		temp os_watch ref const accepted = os_watch_accept( listener, nothing, nothing );
+		skip_if( accepted is nothing );
+		os_watch_on_data( accepted, on_server_data );
+	}
+}
+
+fn on_client( os_watch ref const watch, n4 const events )
+{
+	if( events & os_event_write and not echo_sent )
+	{
+		echo_sent = os_watch_write( watch, echo_message, size_of( echo_message ) - 1 ) is size_of( echo_message ) - 1;
+		os_watch_want( watch, os_event_read );
+	}
+	if( events & os_event_read )
+	{
+		temp i8 size = 0;
+		while( ( size = os_watch_read( watch, echo_got + echo_size, size_of( echo_got ) - echo_size ) ) > 0 ) echo_size += n8( size );
+		if( echo_size >= size_of( echo_message ) - 1 )
+		{
+			echo_done = yes;
+			os_watch_close( watch );
+		}
+	}
+}
+
+fn check_tcp( os_loop ref const event_loop )
+{
+	temp os_watch ref const listener = os_loop_listen( event_loop, "127.0.0.1", 0, on_listener, nothing );
+	check( listener isnt nothing and os_watch_port( listener ) isnt 0, "listening on 127.0.0.1" );
+	out_if_nothing( listener );
+	temp os_watch ref const client = os_loop_connect( event_loop, "127.0.0.1", os_watch_port( listener ), on_client, nothing );
+	check( client isnt nothing, "connecting to 127.0.0.1" );
+	check( run_until( event_loop, ref_of( echo_done ) ), "tcp echo came back" );
+	check( echo_size is size_of( echo_message ) - 1 and bytes_compare( echo_got, echo_message, echo_size ) is 0, "tcp echo matches" );
+	os_watch_close( listener );
+}
+
+////////////////////////////////
+// timers: a periodic one fires several times, and one that closes another due with it stops that one firing
+
+perm n4 ticks = 0;
+perm n8 ticks_started_ns = 0;
+perm n8 ticks_ended_ns = 0;
+perm flag ticks_done = no;
+perm os_watch ref doomed[ 2 ] = { nothing };
+perm n4 doomed_fired = 0;
+perm flag doomed_done = no;
+
+fn on_tick( os_watch ref const watch, n4 const events )
+{
+	out_if( not( events & os_event_timer ) );
+	if( ++ticks is 4 )
+	{
+		ticks_ended_ns = os_time_ns();
+		ticks_done = yes;
+		os_watch_close( watch );
+	}
+}
+
+fn on_doomed( os_watch ref const watch, n4 const events )
+{
+	( anon )events;
+	++doomed_fired;
+	os_watch_close( doomed[ 0 ] );
+	os_watch_close( doomed[ 1 ] );
+	doomed_done = yes;
+	( anon )watch;
+}
+
+fn check_timers( os_loop ref const event_loop )
+{
+	ticks_started_ns = os_time_ns();
+	check( os_loop_timer( event_loop, 5000000, 5000000, on_tick, nothing ) isnt nothing, "periodic timer added" );
+	check( run_until( event_loop, ref_of( ticks_done ) ), "periodic timer fired 4 times" );
+	check( ticks_ended_ns - ticks_started_ns >= 20000000, "periodic timer kept its period" );
+
+	doomed[ 0 ] = os_loop_timer( event_loop, 2000000, 0, on_doomed, nothing );
+	doomed[ 1 ] = os_loop_timer( event_loop, 2000000, 0, on_doomed, nothing );
+	sleep( 10 );
+	check( run_until( event_loop, ref_of( doomed_done ) ), "timers due together fired" );
+	os_loop_run_once( event_loop, 10 );
+	check( doomed_fired is 1, "a timer closed by another due with it did not fire" );
+}
+
+////////////////////////////////
+// wakeups from another thread coalesce, and os_loop_stop ends os_loop_run
+
+perm os_watch ref waker = nothing;
+perm os_loop ref woken_loop = nothing;
+perm n4 wakes = 0;
+
+fn on_wake( os_watch ref const watch, n4 const events )
+{
+	( anon )watch;
+	if( events & os_event_wake ) ++wakes;
+}
+
+fn waking_thread( anon ref const context, n8 const index )
+{
+	( anon )context;
+	( anon )index;
+	iter( i, 3 )
+	{
+		os_watch_wake( waker );
+		sleep( 5 );
+	}
+	os_loop_stop( woken_loop );
+}
+
+fn check_wakeups( os_loop ref const event_loop )
+{
+	waker = os_loop_wakeup( event_loop, on_wake, nothing );
+	woken_loop = event_loop;
+	check( waker isnt nothing, "wakeup added" );
+	os_thread thread;
+	check( os_create_thread( ref_of( thread ), waking_thread, nothing, 0 ), "waking thread started" );
+	os_loop_run( event_loop );
+	os_join_thread( thread );
+	check( wakes >= 1 and wakes <= 3, "wakes called back" );
+}
+
+start
+{
+	temp os_loop ref const event_loop = os_create_loop();
+	check( event_loop isnt nothing, "loop created" );
+	out_if_nothing( event_loop ) failure;
+	check_pairs( event_loop );
+	check_pipe( event_loop );
+	check_tcp( event_loop );
+	check_timers( event_loop );
+	check_wakeups( event_loop );
+	os_delete_loop( event_loop );
+	out pick( failed, failure, success );
+}
@@ -0,0 +1,125 @@
+// timer_wheel offline: a time taken before the wheel was created, deadlines firing in tick order
+// across every level, cancelling, stale ids, and callbacks adding timers as others fire
+// from the repository root: gcc -O2 -I. test/timers.c -o timers -lm -lpthread && ./timers
+
+#include <H.h>
+
+#define TICK_NS 1000000ull
+#define SPREAD 2000
+
+perm flag failed = no;
+
+fn check( flag const passed, byte const ref const what )
+{
+	print( pick( passed, "ok    ", "FAIL  " ) );
+	print( what );
+	print_newline();
+	failed = failed or not passed;
+}
+
+////////////////////////////////
+// a `now` from before `timer_wheel_create` fires nothing and does not run the wheel forward
+
+perm n4 early_fired = 0;
+
+fn on_early( anon ref const context )
+{
+	( anon )context;
+	++early_fired;
+}
+
+fn check_early()
+{
+	temp n8 const before_ns = os_time_ns();
+	sleep( 2 );
+	timer_wheel wheel = timer_wheel_create( TICK_NS );
+	check( timer_wheel_add( ref_of( wheel ), before_ns, 0, on_early, nothing ) isnt 0, "timer added from an earlier now" );
+	check( timer_wheel_advance( ref_of( wheel ), before_ns ) is 0 and wheel.tick is 0, "an earlier now leaves the wheel where it is" );
+	check( timer_wheel_advance( ref_of( wheel ), wheel.origin_ns + TICK_NS ) is 1 and early_fired is 1, "the timer fires on the first tick" );
+	timer_wheel_delete( ref_of( wheel ) );
+}
+
+////////////////////////////////
+// deadlines from one tick to past the last level fire once each, never early and in order
+
+perm n8 order_now_ns = 0;
+perm n8 order_last_due = 0;
+perm n4 order_fired = 0;
+perm flag order_kept = yes;
+
+fn on_ordered( anon ref const context )
+{
+	temp n8 const due = to( n8, context );
+	order_kept = order_kept and due >= order_last_due and due <= order_now_ns;
+	order_last_due = due;
+	++order_fired;
+}
+
+fn check_order()
+{
+	timer_wheel wheel = timer_wheel_create( TICK_NS );
+	temp n8 const origin_ns = wheel.origin_ns;
+	n8 ids[ SPREAD ];
+	temp n8 most_ns = 0;
+	iter( i, SPREAD )
+	{
+		// a third of the deadlines within the first level, the rest spread over 2^30 ticks
+		temp n8 const delay_ns = pick( i mod 3, n8( 1 + random_below_n4( 1 << 30 ) ), n8( 1 + random_below_n4( 255 ) ) ) * TICK_NS;
+		ids[ i ] = timer_wheel_add( ref_of( wheel ), origin_ns, delay_ns, on_ordered, to( anon ref, origin_ns + delay_ns ) );
+		most_ns = MAX( most_ns, delay_ns );
+	}
+	check( wheel.count is SPREAD, "timers added" );
+	temp n4 cancelled = 0;
+	iter_step( i, SPREAD, 7 ) cancelled += timer_wheel_cancel( ref_of( wheel ), ids[ i ] );
+	check( cancelled is ( SPREAD + 6 ) / 7 and not timer_wheel_cancel( ref_of( wheel ), ids[ 0 ] ), "cancelled once each" );
+
+	// advance in uneven steps, as a loop with varying waits would
+	order_now_ns = origin_ns;
+	while( wheel.count )
+	{
+		order_now_ns += n8( 1 + random_below_n4( 1 << 20 ) ) * TICK_NS;
+		timer_wheel_advance( ref_of( wheel ), order_now_ns );
+		skip_if( order_now_ns > origin_ns + most_ns );
+	}
+	check( order_fired is SPREAD - cancelled and wheel.count is 0, "every timer left fired once" );
+	check( order_kept, "timers fired in order and never early" );
+	check( not timer_wheel_cancel( ref_of( wheel ), ids[ 1 ] ), "a fired timer cannot be cancelled" );
+	timer_wheel_delete( ref_of( wheel ) );
+}
+
+////////////////////////////////
+// a callback adding the next timer keeps a chain going on every advance
+
+perm timer_wheel chain_wheel;
+perm n8 chain_now_ns = 0;
+perm n4 chain_links = 0;
+
+fn on_chain( anon ref const context )
+{
+	( anon )context;
+	if( ++chain_links < 100 ) timer_wheel_add( ref_of( chain_wheel ), chain_now_ns, TICK_NS, on_chain, nothing );
+}
+
+fn check_chain()
+{
+	chain_wheel = timer_wheel_create( TICK_NS );
+	chain_now_ns = chain_wheel.origin_ns;
+	timer_wheel_add( ref_of( chain_wheel ), chain_now_ns, TICK_NS, on_chain, nothing );
+	iter( i, 200 )
+	{
+		chain_now_ns += TICK_NS;
+		timer_wheel_advance( ref_of( chain_wheel ), chain_now_ns );
+	}
+	check( chain_links is 100 and chain_wheel.count is 0, "callbacks added timers as they fired" );
+	check( timer_wheel_next_ns( ref_of( chain_wheel ) ) is n8_max_val, "no next time once the wheel is empty" );
+	timer_wheel_delete( ref_of( chain_wheel ) );
+}
+
+start
+{
+	random_seed( 1 );
+	check_early();
+	check_order();
+	check_chain();
+	out pick( failed, failure, success );
+}